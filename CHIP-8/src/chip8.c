@@ -4,8 +4,14 @@
 #include <time.h>
 #include <math.h>
 #include "chip8.h"
+#include "chip8_scale.h"
+#include "chip8_trace.h"
+#include "chip8_metrics.h"
 
-// CHIP-8弯 (0-F, ÿַ5ֽ)
+// 运行时故障信息 (批量/测试运行时可关闭)
+#define CHIP8_LOG(chip8, ...) do { if (!(chip8)->quiet) fprintf(stderr, __VA_ARGS__); } while (0)
+
+// CHIP-8内置字体集 (0-F, 每个字符5字节)
 static const uint8_t FONTSET[80] = {
     0xF0, 0x90, 0x90, 0x90, 0xF0, // 0
     0x20, 0x60, 0x20, 0x20, 0x70, // 1
@@ -25,44 +31,45 @@ static const uint8_t FONTSET[80] = {
     0xF0, 0x80, 0xF0, 0x80, 0x80  // F
 };
 
-// Ƶص - ɷ
+// 音频回调函数 - 生成蜂鸣声
 void chip8_audio_callback(void* userdata, uint8_t* stream, int len) {
     Chip8* chip8 = (Chip8*)userdata;
     int16_t* buffer = (int16_t*)stream;
     int samples = len / sizeof(int16_t);
     
-    // ֻʱ0ʱŲŷ
+    // 欠载检测：回调间隔超过缓冲区时长的1.5倍说明设备已经播空
+    static uint64_t last_callback = 0;
+    uint64_t now = SDL_GetPerformanceCounter();
+    uint64_t limit = SDL_GetPerformanceFrequency() * samples * 3 / (AUDIO_FREQUENCY * 2);
+    if (last_callback && now - last_callback > limit) {
+        metrics_add(METRICS_THREAD_AUDIO, METRIC_AUDIO_UNDERRUNS, 1);
+    }
+    last_callback = now;
+    metrics_add(METRICS_THREAD_AUDIO, METRIC_AUDIO_CALLBACKS, 1);
+    
+    // 取出模拟线程发布的图样和音高 (不加锁，写入中途则沿用上一次的参数)
+    chip8_voice_receive(&chip8->voice, &chip8->tone_mailbox);
+    
+    // 只有在声音定时器大于0时才发声 (XO-CHIP图样，或默认的正弦蜂鸣声)
     if (chip8->sound_timer > 0) {
-        // Ҳ
-        for (int i = 0; i < samples; i++) {
-            // Ҳ
-            double sample = sin(chip8->audio_phase * 2.0 * M_PI) * BEEP_VOLUME;
-            buffer[i] = (int16_t)sample;
-            
-            // λ
-            chip8->audio_phase += (double)BEEP_FREQUENCY / AUDIO_FREQUENCY;
-            if (chip8->audio_phase >= 1.0) {
-                chip8->audio_phase -= 1.0;
-            }
-        }
+        chip8_voice_render(&chip8->voice, buffer, samples);
     } else {
-        // ʱΪ0ʱ
+        // 声音定时器为0时，输出静音
         memset(buffer, 0, len);
     }
 }
 
-// ʼƵϵͳ
-int chip8_audio_init(Chip8* chip8) {
-    if (!chip8) return 0;
-    
-    // ʼSDLƵϵͳ
-    if (SDL_Init(SDL_INIT_AUDIO) < 0) {
-        fprintf(stderr, "SDLƵʼʧ: %s\n", SDL_GetError());
+// 打开音频设备 (保持暂停)：音频子系统初始化和打开设备在部分平台上要几十到几百毫秒，
+// 可以在后台线程进行，期间不访问模拟线程使用的字段
+static int audio_open(Chip8* chip8) {
+    // 初始化SDL音频子系统
+    if (SDL_InitSubSystem(SDL_INIT_AUDIO) < 0) {
+        fprintf(stderr, "SDL音频初始化失败: %s\n", SDL_GetError());
         return 0;
     }
     
-    // Ƶ
-    SDL_AudioSpec want, have;
+    // 设置音频规格
+    SDL_AudioSpec want;
     SDL_memset(&want, 0, sizeof(want));
     want.freq = AUDIO_FREQUENCY;
     want.format = AUDIO_FORMAT;
@@ -71,163 +78,368 @@ int chip8_audio_init(Chip8* chip8) {
     want.callback = chip8_audio_callback;
     want.userdata = chip8;
     
-    // Ƶ豸
-    chip8->audio_device = SDL_OpenAudioDevice(NULL, 0, &want, &have, 0);
+    // 打开音频设备 (打开后处于暂停状态，回调不会执行)
+    chip8->audio_device = SDL_OpenAudioDevice(NULL, 0, &want, &chip8->audio_spec, 0);
     if (chip8->audio_device == 0) {
-        fprintf(stderr, "޷Ƶ豸: %s\n", SDL_GetError());
+        fprintf(stderr, "无法打开音频设备: %s\n", SDL_GetError());
         return 0;
     }
     
-    // õƵʽ
-    if (have.format != want.format) {
-        fprintf(stderr, ": Ƶʽƥ\n");
+    // 检查得到的音频格式
+    if (chip8->audio_spec.format != want.format) {
+        fprintf(stderr, "警告: 音频格式不匹配\n");
     }
+    return 1;
+}
     
-    // ʼƵλ
-    chip8->audio_phase = 0.0;
+// 设备已打开：初始化合成器和邮箱后开始播放 (在模拟线程调用)
+static void audio_start(Chip8* chip8) {
+    // 初始化合成器和邮箱，发布当前的发声参数
+    chip8_voice_init(&chip8->voice);
+    memset(&chip8->tone_mailbox, 0, sizeof(chip8->tone_mailbox));
+    chip8_tone_publish(&chip8->tone_mailbox, &chip8->tone);
+    chip8->published_tone = chip8->tone;
     
-    // ʼƵ
+    // 开始播放音频
     SDL_PauseAudioDevice(chip8->audio_device, 0);
     
-    printf("Ƶϵͳʼɹ\n");
-    printf(": %dHz, ʽ: %dλ, : %d\n", 
-           have.freq, SDL_AUDIO_BITSIZE(have.format), have.channels);
+    printf("音频系统初始化成功\n");
+    printf("采样率: %dHz, 格式: %d位, 声道: %d\n", 
+           chip8->audio_spec.freq, SDL_AUDIO_BITSIZE(chip8->audio_spec.format), chip8->audio_spec.channels);
     
     chip8->audio_initialized = 1;
+}
+
+// 初始化音频系统
+int chip8_audio_init(Chip8* chip8) {
+    if (!chip8) return 0;
+    
+    if (!audio_open(chip8)) {
+        return 0;
+    }
+    audio_start(chip8);
     return 1;
 }
 
-// ƵԴ
+static int audio_open_thread(void* data) {
+    Chip8* chip8 = (Chip8*)data;
+    int ok = audio_open(chip8);
+    SDL_AtomicSet(&chip8->audio_opened, 1);
+    return ok;
+}
+
+// 在后台线程打开音频设备 (须在 SDL_Init 之后调用，SDL的子系统计数不是线程安全的，
+// 打开期间主线程不能再调用 SDL_Init/SDL_InitSubSystem)
+int chip8_audio_init_async(Chip8* chip8) {
+    if (!chip8) return 0;
+    
+    SDL_AtomicSet(&chip8->audio_opened, 0);
+    chip8->audio_thread = SDL_CreateThread(audio_open_thread, "chip8_audio", chip8);
+    if (!chip8->audio_thread) {
+        // 无法创建线程时直接在当前线程打开
+        fprintf(stderr, "警告: 无法创建音频线程，在主线程打开音频设备: %s\n", SDL_GetError());
+        SDL_AtomicSet(&chip8->audio_opened, 1);
+        return chip8_audio_init(chip8);
+    }
+    return 1;
+}
+
+int chip8_audio_finish(Chip8* chip8, int wait) {
+    if (!chip8 || !chip8->audio_thread) return 1;
+    if (!wait && !SDL_AtomicGet(&chip8->audio_opened)) return 0;
+    
+    int opened = 0;
+    SDL_WaitThread(chip8->audio_thread, &opened);
+    chip8->audio_thread = NULL;
+    if (opened) {
+        audio_start(chip8);
+    }
+    return 1;
+}
+
+// 清理音频资源
 void chip8_audio_cleanup(Chip8* chip8) {
     if (!chip8) return;
     
+    // 后台打开还没有结束：等它结束，打开成功的设备同样要关闭
+    if (chip8->audio_thread) {
+        int opened = 0;
+        SDL_WaitThread(chip8->audio_thread, &opened);
+        chip8->audio_thread = NULL;
+        if (opened) {
+            SDL_CloseAudioDevice(chip8->audio_device);
+        }
+    }
+    
     if (chip8->audio_initialized) {
         SDL_CloseAudioDevice(chip8->audio_device);
         chip8->audio_initialized = 0;
-        printf("ƵԴ\n");
+        printf("音频资源已清理\n");
     }
 }
 
-// ʼCHIP-8ϵͳ
-void chip8_init(Chip8* chip8) {
-    // 
-    if (!chip8) {
-        fprintf(stderr, ": chip8_init Ϊ\n");
-        return;
-    }
+// 重置CHIP-8机器状态（不打印任何信息，供批量实例使用）
+void chip8_reset(Chip8* chip8, unsigned int seed) {
+    if (!chip8) return;
     
-    // ʹõǰʱʼ
-    chip8->random_seed = (unsigned int)time(NULL);
+    chip8_rng_init(&chip8->rng, CHIP8_RNG_PHILOX, seed, 0);
+    chip8->cycle_debt = 0;
+    chip8->quirks = CHIP8_QUIRKS_DEFAULT;
     
-    // ڴ
-    memset(chip8->memory, 0, MEMORY_SIZE);
+    // 清空内存 (含镜像)
+    memset(chip8->memory, 0, sizeof(chip8->memory));
     
-    // ռĴ
+    // 清空寄存器
     memset(chip8->V, 0, sizeof(chip8->V));
     chip8->I = 0;
     chip8->pc = PROGRAM_START;
     
-    // նջ
+    // 清空堆栈
     memset(chip8->stack, 0, sizeof(chip8->stack));
     chip8->sp = 0;
     
-    // ʼʱ
+    // 初始化定时器
     chip8->delay_timer = 0;
     chip8->sound_timer = 0;
     
-    // ʾ
+    // 清空显示
     memset(chip8->display, 0, sizeof(chip8->display));
     
-    // ռ״̬
+    // 清空键盘状态
     memset(chip8->key, 0, sizeof(chip8->key));
     
-    // ʼ״̬־
-    chip8->draw_flag = 1;  // ʼҪ
+    // 初始化状态标志
+    chip8->draw_flag = 1;  // 初始需要绘制
     chip8->key_wait = 0;
-    chip8->key_reg = 0;
+    chip8->wait_key = 0xFF;
+    chip8->key_fresh = 0;
+    chip8->key_release = 0;
     
-    // ʼƵ־
-    chip8->audio_initialized = 0;
-    chip8->audio_phase = 0.0;
+    // 默认蜂鸣声
+    chip8_tone_reset(&chip8->tone);
+    
+    // 清空故障统计
+    memset(chip8->fault_count, 0, sizeof(chip8->fault_count));
     
-    // 弯ڴ 0x000-0x04F 
+    // 加载字体集到内存 0x000-0x04F 区域
     for (int i = 0; i < 80; i++) {
         chip8->memory[i] = FONTSET[i];
     }
+    chip8_memory_sync(chip8, 0, 80);
+}
+
+// 初始化CHIP-8系统
+void chip8_init(Chip8* chip8) {
+    // 参数检查
+    if (!chip8) {
+        fprintf(stderr, "错误: chip8_init 参数为空\n");
+        return;
+    }
     
-    printf("CHIP-8 ϵͳʼ\n");
-    printf("ڴ: 4KB, ʾ: %dx%d\n", DISPLAY_WIDTH, DISPLAY_HEIGHT);
-    printf("ʼַ: 0x%03X\n", PROGRAM_START);
-    printf("弯ص: 0x000-0x04F\n");
-    printf(": %u\n", chip8->random_seed);
+    // 未指定种子时混合当前时间和高精度计数器
+    chip8_reset(chip8, chip8_rng_entropy());
+    
+    // 初始化音频标志
+    chip8->audio_initialized = 0;
+    
+    printf("CHIP-8 系统初始化完成 (内存4KB, 显示%dx%d, 程序起始0x%03X, 随机数种子%u)\n",
+           DISPLAY_WIDTH, DISPLAY_HEIGHT, PROGRAM_START, chip8->rng.seed);
 }
 
-// ROMļ
+// 加载ROM文件
 int chip8_load_rom(Chip8* chip8, const char* filename) {
     if (!chip8 || !filename) {
-        fprintf(stderr, ": chip8_load_rom Ϊ\n");
+        fprintf(stderr, "错误: chip8_load_rom 参数为空\n");
         return 0;
     }
     
     FILE* file = fopen(filename, "rb");
     if (!file) {
-        fprintf(stderr, ": ޷ROMļ: %s\n", filename);
+        fprintf(stderr, "错误: 无法打开ROM文件: %s\n", filename);
         return 0;
     }
     
-    // ȡļС
+    // 获取文件大小
     fseek(file, 0, SEEK_END);
     long file_size = ftell(file);
     rewind(file);
     
-    // ļС
+    // 检查文件大小
     long max_size = MEMORY_SIZE - PROGRAM_START;
     if (file_size > max_size) {
-        fprintf(stderr, ": ROMļ̫ (%ldֽ > %ldֽڿ)\n", file_size, max_size);
+        fprintf(stderr, "错误: ROM文件太大 (%ld字节 > %ld字节可用)\n", file_size, max_size);
         fclose(file);
         return 0;
     }
     
-    // ȡROMڴ
+    // 读取ROM到内存
     size_t bytes_read = fread(&chip8->memory[PROGRAM_START],sizeof(uint8_t),file_size,file);
     fclose(file);
     
     if (bytes_read != (size_t)file_size) {
-        fprintf(stderr,": ȡROM (ȡ %zuֽڣԤ %ldֽ)\n",bytes_read, file_size);
+        fprintf(stderr,"错误: 读取ROM不完整 (读取 %zu字节，预期 %ld字节)\n",bytes_read, file_size);
         return 0;
     }
     
-    printf("ɹROM: %s\n", filename);
-    printf("ļС: %ldֽ\n", file_size);
-    printf("صڴַ: 0x%03X-0x%03X\n",PROGRAM_START, PROGRAM_START + (uint16_t)file_size - 1);
-    return 1;  // ɹ
+    printf("成功加载ROM: %s\n", filename);
+    printf("文件大小: %ld字节\n", file_size);
+    printf("加载到内存地址: 0x%03X-0x%03X\n",PROGRAM_START, PROGRAM_START + (uint16_t)file_size - 1);
+    return 1;  // 成功
+}
+
+// 从内存缓冲区加载ROM（不访问文件系统，供批量实例复用同一份ROM）
+int chip8_load_rom_data(Chip8* chip8, const uint8_t* data, size_t size) {
+    if (!chip8 || !data) {
+        fprintf(stderr, "错误: chip8_load_rom_data 参数为空\n");
+        return 0;
+    }
+    
+    if (size > MEMORY_SIZE - PROGRAM_START) {
+        fprintf(stderr, "错误: ROM数据太大 (%zu字节 > %d字节可用)\n", size, MEMORY_SIZE - PROGRAM_START);
+        return 0;
+    }
+    
+    memcpy(&chip8->memory[PROGRAM_START], data, size);
+    return 1;
+}
+
+// 将显示缓冲区打包为1位/像素 (每行8字节，高位在左)
+void chip8_pack_display(const Chip8* chip8, uint8_t* packed) {
+    const uint8_t* src = chip8->display;
+    
+    for (int i = 0; i < DISPLAY_PACKED_SIZE; i++) {
+        packed[i] = (uint8_t)((src[0] << 7) | (src[1] << 6) | (src[2] << 5) | (src[3] << 4) |
+                              (src[4] << 3) | (src[5] << 2) | (src[6] << 1) | src[7]);
+        src += 8;
+    }
+}
+
+// 将显示缓冲区打包为每行一个64位字
+void chip8_pack_rows(const Chip8* chip8, uint64_t* rows) {
+    const uint8_t* src = chip8->display;
+    
+    for (int y = 0; y < DISPLAY_HEIGHT; y++) {
+        uint64_t row = 0;
+        for (int x = 0; x < DISPLAY_WIDTH; x++) {
+            row = (row << 1) | (src[x] & 1);
+        }
+        rows[y] = row;
+        src += DISPLAY_WIDTH;
+    }
+}
+
+// 记录运行时故障：计数，并在开启跟踪时安排转储 (每种故障只转储一次)
+void chip8_fault(Chip8* chip8, Chip8Fault fault, uint16_t opcode) {
+    chip8->fault_count[fault]++;
+    
+    Chip8Trace* trace = chip8->trace;
+    if (trace && !(trace->dumped_faults & (1u << fault))) {
+        trace->dumped_faults |= 1u << fault;
+        trace->pending_fault = fault;
+        trace->pending_opcode = opcode;
+    }
+}
+
+// 执行跟踪：判断指令写入了哪个寄存器
+static uint8_t trace_written_reg(uint16_t opcode) {
+    uint8_t x = (opcode & 0x0F00) >> 8;
+    
+    switch (opcode & 0xF000) {
+        case 0x6000:
+        case 0x7000:
+        case 0x8000:
+        case 0xC000:
+            return x;
+        case 0xF000:
+            switch (opcode & 0x00FF) {
+                case 0x0007:
+                case 0x000A:
+                case 0x0065:
+                    return x;
+            }
+            break;
+    }
+    return TRACE_NO_REG;
+}
+
+// 执行跟踪：记录本条指令，若执行中发生故障则随即转储
+static void trace_instruction(Chip8* chip8, uint16_t pc, uint16_t opcode) {
+    Chip8Trace* trace = chip8->trace;
+    uint8_t reg = trace_written_reg(opcode);
+    
+    // FX0A仍在等待按键时没有写寄存器
+    if ((opcode & 0xF0FF) == 0xF00A && chip8->pc == pc) {
+        reg = TRACE_NO_REG;
+    }
+    chip8_trace_record(trace, pc, opcode, chip8->I, reg, reg != TRACE_NO_REG ? chip8->V[reg] : 0);
+    
+    if (trace->pending_fault) {
+        if (chip8_trace_dump(trace, trace->pending_fault, trace->pending_opcode)) {
+            fprintf(stderr, "执行跟踪已转储到: %s\n", trace->path);
+        }
+        trace->pending_fault = 0;
+    }
 }
 
-// CPUִУȡָ롢ִ
+// 写入后维护内存镜像：写到镜像区 (越过4KB) 的部分回绕到开头，
+// 开头 MEMORY_GUARD 字节有变化时刷新镜像。len 不超过 MEMORY_GUARD
+void chip8_memory_sync(Chip8* chip8, uint16_t addr, int len) {
+    int start = addr & MEMORY_MASK;
+    int end = start + len;
+    if (end > MEMORY_SIZE) {
+        memcpy(chip8->memory, &chip8->memory[MEMORY_SIZE], (size_t)(end - MEMORY_SIZE));
+    }
+    if (start < MEMORY_GUARD || end > MEMORY_SIZE) {
+        memcpy(&chip8->memory[MEMORY_SIZE], chip8->memory, MEMORY_GUARD);
+    }
+}
+
+// 发声参数有变化时交给音频线程 (F002/FX3A、回滚或恢复状态之后)
+static void audio_sync(Chip8* chip8) {
+    if (memcmp(&chip8->tone, &chip8->published_tone, sizeof(Chip8Tone)) == 0) return;
+    chip8_tone_publish(&chip8->tone_mailbox, &chip8->tone);
+    chip8->published_tone = chip8->tone;
+}
+
+// 读取按键 (EX9E/EXA1/FX0A)：按下后被读到过一次的键不再需要保持，延迟的松开随即生效
+static uint8_t read_key(Chip8* chip8, uint8_t key) {
+    uint8_t down = chip8->key[key];
+    uint16_t bit = (uint16_t)(1u << key);
+    chip8->key_fresh &= (uint16_t)~bit;
+    if (chip8->key_release & bit) {
+        chip8->key_release &= (uint16_t)~bit;
+        chip8->key[key] = 0;
+    }
+    return down;
+}
+
+// CPU单周期执行：取指、解码、执行
 void chip8_cycle(Chip8* chip8) {
     if (!chip8) return;
 
-    // 1. ȡָ (Fetch): ӵǰPCλöȡһ16λĲ
-    uint16_t opcode = (chip8->memory[chip8->pc] << 8) | chip8->memory[chip8->pc + 1];
+    // 1. 取指 (Fetch): 从当前PC位置读取一个16位的操作码 (PC=0xFFF时第二个字节来自镜像)
+    const uint16_t pc = chip8->pc;
+    uint16_t opcode = chip8_read_opcode(chip8, pc);
     
-    // 2. ִ
+    // 2. 解码与执行
     switch (opcode & 0xF000) {
-        // ============ 0xxx: ָ ============
+        // ============ 0xxx: 特殊指令 ============
         case 0x0000:
             switch (opcode) {
-                case 0x00E0: // 00E0:  (CLS)
+                case 0x00E0: // 00E0: 清屏 (CLS)
                     memset(chip8->display, 0, sizeof(chip8->display));
                     chip8->draw_flag = 1;
                     chip8->pc += 2;
                     break;
                     
-                case 0x00EE: // 00EE: ӳ򷵻 (RET)
-                    // ջ߼Ӷջַ
+                case 0x00EE: // 00EE: 从子程序返回 (RET)
+                    // 堆栈逻辑：从堆栈弹出地址
                     if (chip8->sp > 0) {
                         chip8->sp--;
                         chip8->pc = chip8->stack[chip8->sp];
                     } else {
-                        fprintf(stderr, ": ջ!\n");
+                        CHIP8_LOG(chip8, "警告: 堆栈下溢!\n");
+                        chip8_fault(chip8, CHIP8_FAULT_STACK_UNDERFLOW, opcode);
                         chip8->pc += 2;
                     }
                     break;
@@ -238,47 +450,48 @@ void chip8_cycle(Chip8* chip8) {
             }
             break;
 
-        // ============ 1xxx: ת ============
-        case 0x1000: // 1NNN: תַ NNN (JP NNN)
+        // ============ 1xxx: 跳转 ============
+        case 0x1000: // 1NNN: 跳转到地址 NNN (JP NNN)
             {
                 uint16_t address = opcode & 0x0FFF;
-                chip8->pc = address; // ֱPC2
+                chip8->pc = address; // 直接设置PC，不加2
             }
             break;
 
-        // ============ 2xxx: ӳ ============
-        case 0x2000: // 2NNN: ӳ (CALL NNN)
+        // ============ 2xxx: 调用子程序 ============
+        case 0x2000: // 2NNN: 调用子程序 (CALL NNN)
             {
                 uint16_t address = opcode & 0x0FFF;
                 
-                // صַѹջ
+                // 将返回地址压栈
                 if (chip8->sp < 16) {
                     chip8->stack[chip8->sp] = chip8->pc + 2;
                     chip8->sp++;
                     chip8->pc = address;
                 } else {
-                    fprintf(stderr, ": ջ!\n");
+                    CHIP8_LOG(chip8, "警告: 堆栈溢出!\n");
+                    chip8_fault(chip8, CHIP8_FAULT_STACK_OVERFLOW, opcode);
                     chip8->pc += 2;
                 }
             }
             break;
 
-        // ============ 3xxx:  ============
-        case 0x3000: // 3XNN:  VX == NN  (SE Vx, byte)
+        // ============ 3xxx: 条件跳过 ============
+        case 0x3000: // 3XNN: 如果 VX == NN 则跳过 (SE Vx, byte)
             {
                 uint8_t x = (opcode & 0x0F00) >> 8;
                 uint8_t nn = opcode & 0x00FF;
                 
                 if (chip8->V[x] == nn) {
-                    chip8->pc += 4;  // һָ
+                    chip8->pc += 4;  // 跳过下一条指令
                 } else {
-                    chip8->pc += 2;  // ǰ
+                    chip8->pc += 2;  // 正常前进
                 }
             }
             break;
 
-        // ============ 4xxx:  ============
-        case 0x4000: // 4XNN:  VX != NN  (SNE Vx, byte)
+        // ============ 4xxx: 条件跳过 ============
+        case 0x4000: // 4XNN: 如果 VX != NN 则跳过 (SNE Vx, byte)
             {
                 uint8_t x = (opcode & 0x0F00) >> 8;
                 uint8_t nn = opcode & 0x00FF;
@@ -291,8 +504,8 @@ void chip8_cycle(Chip8* chip8) {
             }
             break;
 
-        // ============ 5xxx:  ============
-        case 0x5000: // 5XY0:  VX == VY  (SE Vx, Vy)
+        // ============ 5xxx: 条件跳过 ============
+        case 0x5000: // 5XY0: 如果 VX == VY 则跳过 (SE Vx, Vy)
             {
                 uint8_t x = (opcode & 0x0F00) >> 8;
                 uint8_t y = (opcode & 0x00F0) >> 4;
@@ -305,8 +518,8 @@ void chip8_cycle(Chip8* chip8) {
             }
             break;
 
-        // ============ 6xxx: üĴ ============
-        case 0x6000: // 6XNN: NNĴVX (LD Vx, byte)
+        // ============ 6xxx: 设置寄存器 ============
+        case 0x6000: // 6XNN: 将常数NN存入寄存器VX (LD Vx, byte)
             {
                 uint8_t x = (opcode & 0x0F00) >> 8;
                 uint8_t nn = opcode & 0x00FF;
@@ -315,7 +528,7 @@ void chip8_cycle(Chip8* chip8) {
             }
             break;
 
-        // ============ 7xxx: ӷ ============
+        // ============ 7xxx: 加法 ============
         case 0x7000: // 7XNN: VX = VX + NN (ADD Vx, byte)
             {
                 uint8_t x = (opcode & 0x0F00) >> 8;
@@ -325,7 +538,7 @@ void chip8_cycle(Chip8* chip8) {
             }
             break;
 
-        // ============ 8xxx: ߼ ============
+        // ============ 8xxx: 算术与逻辑 ============
         case 0x8000:
             {
                 uint8_t x = (opcode & 0x0F00) >> 8;
@@ -339,16 +552,19 @@ void chip8_cycle(Chip8* chip8) {
                         
                     case 0x0001: // 8XY1: VX = VX OR VY (OR Vx, Vy)
                         chip8->V[x] |= chip8->V[y];
+                        if (chip8->quirks & QUIRK_VF_RESET) chip8->V[0xF] = 0;
                         chip8->pc += 2;
                         break;
                         
                     case 0x0002: // 8XY2: VX = VX AND VY (AND Vx, Vy)
                         chip8->V[x] &= chip8->V[y];
+                        if (chip8->quirks & QUIRK_VF_RESET) chip8->V[0xF] = 0;
                         chip8->pc += 2;
                         break;
                         
                     case 0x0003: // 8XY3: VX = VX XOR VY (XOR Vx, Vy)
                         chip8->V[x] ^= chip8->V[y];
+                        if (chip8->quirks & QUIRK_VF_RESET) chip8->V[0xF] = 0;
                         chip8->pc += 2;
                         break;
                         
@@ -367,9 +583,12 @@ void chip8_cycle(Chip8* chip8) {
                         chip8->pc += 2;
                         break;
                         
-                    case 0x0006: // 8XY6: VX = VX >> 1 (SHR Vx)
-                        chip8->V[0xF] = chip8->V[x] & 0x01;
-                        chip8->V[x] >>= 1;
+                    case 0x0006: // 8XY6: VX = VX >> 1 (SHR Vx)，原版为 VX = VY >> 1
+                        {
+                            uint8_t value = (chip8->quirks & QUIRK_SHIFT_VX) ? chip8->V[x] : chip8->V[y];
+                            chip8->V[0xF] = value & 0x01;
+                            chip8->V[x] = value >> 1;
+                        }
                         chip8->pc += 2;
                         break;
                         
@@ -379,22 +598,26 @@ void chip8_cycle(Chip8* chip8) {
                         chip8->pc += 2;
                         break;
                         
-                    case 0x000E: // 8XYE: VX = VX << 1 (SHL Vx)
-                        chip8->V[0xF] = (chip8->V[x] & 0x80) >> 7;
-                        chip8->V[x] <<= 1;
+                    case 0x000E: // 8XYE: VX = VX << 1 (SHL Vx)，原版为 VX = VY << 1
+                        {
+                            uint8_t value = (chip8->quirks & QUIRK_SHIFT_VX) ? chip8->V[x] : chip8->V[y];
+                            chip8->V[0xF] = (value & 0x80) >> 7;
+                            chip8->V[x] = (uint8_t)(value << 1);
+                        }
                         chip8->pc += 2;
                         break;
                         
                     default:
-                        fprintf(stderr, "δʵֵ8ָ: 0x%04X\n", opcode);
+                        CHIP8_LOG(chip8, "未实现的8指令: 0x%04X\n", opcode);
+                        chip8_fault(chip8, CHIP8_FAULT_UNKNOWN_OPCODE, opcode);
                         chip8->pc += 2;
                         break;
                 }
             }
             break;
 
-        // ============ 9xxx:  ============
-        case 0x9000: // 9XY0:  VX != VY  (SNE Vx, Vy)
+        // ============ 9xxx: 条件跳过 ============
+        case 0x9000: // 9XY0: 如果 VX != VY 则跳过 (SNE Vx, Vy)
             {
                 uint8_t x = (opcode & 0x0F00) >> 8;
                 uint8_t y = (opcode & 0x00F0) >> 4;
@@ -407,8 +630,8 @@ void chip8_cycle(Chip8* chip8) {
             }
             break;
 
-        // ============ Axxx: Ĵ ============
-        case 0xA000: // ANNN: IĴ (LD I, addr)
+        // ============ Axxx: 设置索引寄存器 ============
+        case 0xA000: // ANNN: 设置I寄存器 (LD I, addr)
             {
                 uint16_t address = opcode & 0x0FFF;
                 chip8->I = address;
@@ -416,49 +639,54 @@ void chip8_cycle(Chip8* chip8) {
             }
             break;
 
-        // ============ Bxxx: ת ============
-        case 0xB000: // BNNN: תַ NNN + V0 (JP V0, addr)
+        // ============ Bxxx: 跳转 ============
+        case 0xB000: // BNNN: 跳转到地址 NNN + V0 (JP V0, addr)，SUPER-CHIP为 XNN + VX
             {
                 uint16_t address = opcode & 0x0FFF;
-                chip8->pc = address + chip8->V[0];
+                uint8_t base = (chip8->quirks & QUIRK_JUMP_VX) ? (uint8_t)((opcode & 0x0F00) >> 8) : 0;
+                chip8->pc = address + chip8->V[base];
             }
             break;
 
-        // ============ Cxxx:  ============
-        case 0xC000: // CXNN: VX =  & NN (RND Vx, byte)
+        // ============ Cxxx: 随机数 ============
+        case 0xC000: // CXNN: VX = 随机数 & NN (RND Vx, byte)
             {
                 uint8_t x = (opcode & 0x0F00) >> 8;
                 uint8_t nn = opcode & 0x00FF;
                 
-                // ʹͬ
-                chip8->random_seed = (chip8->random_seed * 1103515245 + 12345) % 0x7FFFFFFF;
-                chip8->V[x] = (chip8->random_seed & 0xFF) & nn;
+                chip8->V[x] = (uint8_t)chip8_rng_next(&chip8->rng) & nn;
                 chip8->pc += 2;
             }
             break;
 
-        // ============ Dxxx: ʾͼ ============
-        case 0xD000: // DXYN: ƾ (DRW Vx, Vy, n)
+        // ============ Dxxx: 显示绘图 ============
+        case 0xD000: // DXYN: 绘制精灵 (DRW Vx, Vy, n)
             {
                 uint8_t x = chip8->V[(opcode & 0x0F00) >> 8];
                 uint8_t y = chip8->V[(opcode & 0x00F0) >> 4];
                 uint8_t height = opcode & 0x000F;
                 uint8_t pixel;
 
+                // 一次取出最多15行精灵数据 (定长复制，越过4KB的行来自镜像)
+                uint8_t rows[MEMORY_GUARD];
+                memcpy(rows, &chip8->memory[chip8->I & MEMORY_MASK], sizeof(rows));
+                
                 chip8->V[0xF] = 0;
 
+                // 裁剪：起点回绕到屏幕内，超出右边和下边的部分不画
+                const int clipping = (chip8->quirks & QUIRK_CLIPPING) != 0;
+                if (clipping) {
+                    x %= DISPLAY_WIDTH;
+                    y %= DISPLAY_HEIGHT;
+                }
+                
                 for (int yline = 0; yline < height; yline++) {
-                    // ڴ߽
-                    if (chip8->I + yline >= MEMORY_SIZE) {
-                        fprintf(stderr, ": Խ磬I+yline=0x%03X >= 0x%03X\n", 
-                               chip8->I + yline, MEMORY_SIZE);
-                        break;
-                    }
-                    
-                    pixel = chip8->memory[chip8->I + yline];
+                    pixel = rows[yline];
+                    if (clipping && y + yline >= DISPLAY_HEIGHT) break;
                     
                     for (int xline = 0; xline < 8; xline++) {
                         if ((pixel & (0x80 >> xline)) != 0) {
+                            if (clipping && x + xline >= DISPLAY_WIDTH) break;
                             int display_x = (x + xline) % DISPLAY_WIDTH;
                             int display_y = (y + yline) % DISPLAY_HEIGHT;
                             int pixel_index = display_y * DISPLAY_WIDTH + display_x;
@@ -477,28 +705,28 @@ void chip8_cycle(Chip8* chip8) {
             }
             break;
 
-        // ============ Exxx:  ============
+        // ============ Exxx: 键盘输入 ============
         case 0xE000:
             switch (opcode & 0x00FF) {
-                case 0x009E: // EX9E:  VX £һָ (SKP Vx)
+                case 0x009E: // EX9E: 如果按键 VX 被按下，则跳过下一条指令 (SKP Vx)
                     {
                         uint8_t x = (opcode & 0x0F00) >> 8;
                         uint8_t key_to_check = chip8->V[x];
                         
-                        if (key_to_check < 16 && chip8->key[key_to_check]) {
-                            chip8->pc += 4;  // һָ
+                        if (key_to_check < 16 && read_key(chip8, key_to_check)) {
+                            chip8->pc += 4;  // 跳过下一条指令
                         } else {
-                            chip8->pc += 2;  // ǰ
+                            chip8->pc += 2;  // 正常前进
                         }
                     }
                     break;
                     
-                case 0x00A1: // EXA1:  VX û£һָ (SKNP Vx)
+                case 0x00A1: // EXA1: 如果按键 VX 没被按下，则跳过下一条指令 (SKNP Vx)
                     {
                         uint8_t x = (opcode & 0x0F00) >> 8;
                         uint8_t key_to_check = chip8->V[x];
                         
-                        if (key_to_check < 16 && !chip8->key[key_to_check]) {
+                        if (key_to_check < 16 && !read_key(chip8, key_to_check)) {
                             chip8->pc += 4;
                         } else {
                             chip8->pc += 2;
@@ -507,16 +735,17 @@ void chip8_cycle(Chip8* chip8) {
                     break;
                     
                 default:
-                    fprintf(stderr, "δʵֵEָ: 0x%04X\n", opcode);
+                    CHIP8_LOG(chip8, "未实现的E指令: 0x%04X\n", opcode);
+                    chip8_fault(chip8, CHIP8_FAULT_UNKNOWN_OPCODE, opcode);
                     chip8->pc += 2;
                     break;
             }
             break;
 
-        // ============ Fxxx: ָ ============
+        // ============ Fxxx: 杂项指令 ============
         case 0xF000:
             switch (opcode & 0x00FF) {
-                case 0x0007: // FX07: VX = ӳٶʱ (LD Vx, DT)
+                case 0x0007: // FX07: VX = 延迟定时器 (LD Vx, DT)
                     {
                         uint8_t x = (opcode & 0x0F00) >> 8;
                         chip8->V[x] = chip8->delay_timer;
@@ -524,29 +753,36 @@ void chip8_cycle(Chip8* chip8) {
                     }
                     break;
                     
-                case 0x000A: // FX0A: ȴȻ VX (LD Vx, K)
+                case 0x000A: // FX0A: 等待按键按下并松开，然后存入 VX (LD Vx, K)
                     {
                         uint8_t x = (opcode & 0x0F00) >> 8;
                         
-                        // Ƿа
-                        uint8_t key_pressed = 0xFF;
-                        for (int i = 0; i < 16; i++) {
-                            if (chip8->key[i]) {
-                                key_pressed = i;
-                                break;
-                            }
+                        if (!chip8->key_wait) {
+                            chip8->key_wait = 1;
+                            chip8->wait_key = 0xFF;
                         }
                         
-                        if (key_pressed != 0xFF) {
-                            // а
-                            chip8->V[x] = key_pressed;
+                        if (chip8->wait_key == 0xFF) {
+                            // 检查是否有按键被按下
+                            for (int i = 0; i < 16; i++) {
+                                if (chip8->key[i]) {
+                                    read_key(chip8, (uint8_t)i);
+                                    chip8->wait_key = (uint8_t)i;
+                                    break;
+                                }
+                            }
+                        } else if (!chip8->key[chip8->wait_key]) {
+                            // 按下的键已松开 (与原版COSMAC VIP一致)
+                            chip8->V[x] = chip8->wait_key;
+                            chip8->key_wait = 0;
+                            chip8->wait_key = 0xFF;
                             chip8->pc += 2;
                         }
-                        // 򱣳PC䣬ȴ
+                        // 否则保持PC不变，继续等待
                     }
                     break;
                     
-                case 0x0015: // FX15: ӳٶʱ (LD DT, Vx)
+                case 0x0015: // FX15: 设置延迟定时器 (LD DT, Vx)
                     {
                         uint8_t x = (opcode & 0x0F00) >> 8;
                         chip8->delay_timer = chip8->V[x];
@@ -554,7 +790,7 @@ void chip8_cycle(Chip8* chip8) {
                     }
                     break;
                     
-                case 0x0018: // FX18: ʱ (LD ST, Vx)
+                case 0x0018: // FX18: 设置声音定时器 (LD ST, Vx)
                     {
                         uint8_t x = (opcode & 0x0F00) >> 8;
                         chip8->sound_timer = chip8->V[x];
@@ -570,106 +806,123 @@ void chip8_cycle(Chip8* chip8) {
                     }
                     break;
                     
-                case 0x0029: // FX29: I = ַַ (LD F, Vx)
+                case 0x0002: // F002: 从 [I] 载入16字节音频图样 (XO-CHIP)
+                    if (opcode != 0xF002) {
+                        CHIP8_LOG(chip8, "未实现的F指令: 0x%04X\n", opcode);
+                        chip8_fault(chip8, CHIP8_FAULT_UNKNOWN_OPCODE, opcode);
+                        chip8->pc += 2;
+                        break;
+                    }
+                    memcpy(chip8->tone.pattern, &chip8->memory[chip8->I & MEMORY_MASK], AUDIO_PATTERN_SIZE);
+                    chip8->tone.use_pattern = 1;
+                    audio_sync(chip8);
+                    chip8->pc += 2;
+                    break;
+                    
+                case 0x003A: // FX3A: 音高 = VX (XO-CHIP)
+                    {
+                        uint8_t x = (opcode & 0x0F00) >> 8;
+                        chip8->tone.pitch = chip8->V[x];
+                        audio_sync(chip8);
+                        chip8->pc += 2;
+                    }
+                    break;
+                    
+                case 0x0029: // FX29: I = 字体字符地址 (LD F, Vx)
                     {
                         uint8_t x = (opcode & 0x0F00) >> 8;
-                        uint8_t digit = chip8->V[x] & 0x0F; // ֻȡ4λ
-                        chip8->I = digit * 5; // ÿַ5ֽ
+                        uint8_t digit = chip8->V[x] & 0x0F; // 只取低4位
+                        chip8->I = digit * 5; // 每个字符5字节
                         chip8->pc += 2;
                     }
                     break;
                     
-                case 0x0033: // FX33: ʮת (LD B, Vx)
+                case 0x0033: // FX33: 二进制十进制转换 (LD B, Vx)
                     {
                         uint8_t x = (opcode & 0x0F00) >> 8;
                         uint8_t value = chip8->V[x];
+                        uint8_t* dest = &chip8->memory[chip8->I & MEMORY_MASK];
                         
-                        // ڴ߽
-                        if (chip8->I + 2 >= MEMORY_SIZE) {
-                            fprintf(stderr, ": FX33ڴԽ磬I+2=0x%03X >= 0x%03X\n", 
-                                   chip8->I + 2, MEMORY_SIZE);
-                            chip8->pc += 2;
-                            break;
-                        }
-                        
-                        // λ
-                        chip8->memory[chip8->I] = value / 100;
-                        // ʮλ
-                        chip8->memory[chip8->I + 1] = (value / 10) % 10;
-                        // λ
-                        chip8->memory[chip8->I + 2] = value % 10;
+                        // 百位
+                        dest[0] = value / 100;
+                        // 十位
+                        dest[1] = (value / 10) % 10;
+                        // 个位
+                        dest[2] = value % 10;
+                        chip8_memory_sync(chip8, chip8->I, 3);
                         
                         chip8->pc += 2;
                     }
                     break;
                     
-                case 0x0055: // FX55: Ĵڴ (LD [I], Vx)
+                case 0x0055: // FX55: 保存寄存器到内存 (LD [I], Vx)
                     {
                         uint8_t x = (opcode & 0x0F00) >> 8;
                         
-                        // ڴ߽
-                        if (chip8->I + x >= MEMORY_SIZE) {
-                            fprintf(stderr, ": FX55ڴԽ磬I+%u=0x%03X >= 0x%03X\n", 
-                                   x, chip8->I + x, MEMORY_SIZE);
-                            chip8->pc += 2;
-                            break;
-                        }
-                        
-                        for (int i = 0; i <= x; i++) {
-                            chip8->memory[chip8->I + i] = chip8->V[i];
-                        }
+                        // 整块写入，越过4KB的部分由 chip8_memory_sync 回绕到开头
+                        memcpy(&chip8->memory[chip8->I & MEMORY_MASK], chip8->V, (size_t)x + 1);
+                        chip8_memory_sync(chip8, chip8->I, x + 1);
+                        if (chip8->quirks & QUIRK_MEMORY_INC_I) chip8->I += x + 1;
                         
                         chip8->pc += 2;
                     }
                     break;
                     
-                case 0x0065: // FX65: ڴؼĴ (LD Vx, [I])
+                case 0x0065: // FX65: 从内存加载寄存器 (LD Vx, [I])
                     {
                         uint8_t x = (opcode & 0x0F00) >> 8;
                         
-                        // ڴ߽
-                        if (chip8->I + x >= MEMORY_SIZE) {
-                            fprintf(stderr, ": FX65ڴԽ磬I+%u=0x%03X >= 0x%03X\n", 
-                                   x, chip8->I + x, MEMORY_SIZE);
-                            chip8->pc += 2;
-                            break;
-                        }
-                        
-                        for (int i = 0; i <= x; i++) {
-                            chip8->V[i] = chip8->memory[chip8->I + i];
-                        }
+                        // 整块读取，越过4KB的部分来自镜像
+                        memcpy(chip8->V, &chip8->memory[chip8->I & MEMORY_MASK], (size_t)x + 1);
+                        if (chip8->quirks & QUIRK_MEMORY_INC_I) chip8->I += x + 1;
                         
                         chip8->pc += 2;
                     }
                     break;
                     
                 default:
-                    fprintf(stderr, "δʵֵFָ: 0x%04X\n", opcode);
+                    CHIP8_LOG(chip8, "未实现的F指令: 0x%04X\n", opcode);
+                    chip8_fault(chip8, CHIP8_FAULT_UNKNOWN_OPCODE, opcode);
                     chip8->pc += 2;
                     break;
             }
             break;
 
         default:
-            fprintf(stderr, "δָ֪: 0x%04X\n", opcode);
+            CHIP8_LOG(chip8, "未知指令类型: 0x%04X\n", opcode);
+            chip8_fault(chip8, CHIP8_FAULT_UNKNOWN_OPCODE, opcode);
             chip8->pc += 2;
             break;
     }
+    
+    // 3. 执行跟踪 (关闭时只有一次判断)
+    if (chip8->trace) {
+        trace_instruction(chip8, pc, opcode);
+    }
 }
 
-// ¶ʱӦԼ60HzƵµã
+// 更新定时器（应在约60Hz的频率下调用）
 void chip8_update_timers(Chip8* chip8) {
+    // 快速按下又松开的键最多保持到这一帧结束 (即使程序一直没有读取)
+    for (int i = 0; i < 16; i++) {
+        if (chip8->key_release & (1u << i)) chip8->key[i] = 0;
+    }
+    chip8->key_fresh = 0;
+    chip8->key_release = 0;
+    
     if (chip8->delay_timer > 0) {
         chip8->delay_timer--;
     }
     
+    audio_sync(chip8);
+    
     if (chip8->sound_timer > 0) {
-        // ʱ0ʱƵصԶ
+        // 声音定时器大于0时，音频回调会自动播放声音
         chip8->sound_timer--;
         
-        // ʱʱӡϢ
+        // 当声音定时器即将归零时，打印调试信息
         if (chip8->sound_timer == 0 && chip8->audio_initialized) {
-            printf("\n");
+            printf("声音结束\n");
         }
     }
 }
@@ -677,83 +930,123 @@ void chip8_update_timers(Chip8* chip8) {
 int chip8_graphics_init(Chip8* chip8) {
     if (!chip8) return 0;
     
-    // 1. ʼSDL2Ƶϵͳ
+    // 1. 初始化SDL2视频子系统
     if (SDL_Init(SDL_INIT_VIDEO) < 0) {
-        fprintf(stderr, "SDL2ʼʧ: %s\n", SDL_GetError());
+        fprintf(stderr, "SDL2初始化失败: %s\n", SDL_GetError());
         return 0;
     }
     
-    // 2. 
+    // 2. 创建窗口
     chip8->window = SDL_CreateWindow(
-        "CHIP-8",               // ڱ
-        SDL_WINDOWPOS_CENTERED,        // ʼX
-        SDL_WINDOWPOS_CENTERED,        // ʼY
-        WINDOW_WIDTH,                  // 
-        WINDOW_HEIGHT,                 // ߶
-        SDL_WINDOW_SHOWN               // ʾڱ־
+        "CHIP-8",               // 窗口标题
+        SDL_WINDOWPOS_CENTERED,        // 初始X
+        SDL_WINDOWPOS_CENTERED,        // 初始Y
+        WINDOW_WIDTH,                  // 宽度
+        WINDOW_HEIGHT,                 // 高度
+        SDL_WINDOW_SHOWN | SDL_WINDOW_RESIZABLE  // 显示窗口标志，允许任意缩放
     );
     
     if (!chip8->window) {
-        fprintf(stderr, "ʧ: %s\n", SDL_GetError());
+        fprintf(stderr, "创建窗口失败: %s\n", SDL_GetError());
         SDL_Quit();
         return 0;
     }
     
-    // 3. Ⱦڻƣ- ƳVSyncԱɿ֡
+    // 3. 创建渲染器（用于绘制）- 默认不开VSync以便自由控制帧率，--vsync 时由主循环按消隐安排每帧
     chip8->renderer = SDL_CreateRenderer(
         chip8->window,
-        -1,                            // ʹõһõȾ
-        SDL_RENDERER_ACCELERATED       // ƳSDL_RENDERER_PRESENTVSYNC
+        -1,                            // 使用第一个可用的渲染驱动
+        SDL_RENDERER_ACCELERATED | (chip8->present_vsync ? SDL_RENDERER_PRESENTVSYNC : 0)
     );
     
     if (!chip8->renderer) {
-        fprintf(stderr, "Ⱦʧ: %s\n", SDL_GetError());
+        fprintf(stderr, "创建渲染器失败: %s\n", SDL_GetError());
         SDL_DestroyWindow(chip8->window);
         SDL_Quit();
         return 0;
     }
     
-    printf("ͼϵͳʼɹ (: %dx%d)\n", WINDOW_WIDTH, WINDOW_HEIGHT);
+    // 4. 固定逻辑尺寸：窗口任意缩放时保持2:1比例并自动加黑边
+    SDL_RenderSetLogicalSize(chip8->renderer, WINDOW_WIDTH, WINDOW_HEIGHT);
+    
+    // 5. 创建放大滤镜和流式纹理
+    chip8->scaler = (Chip8Scaler*)calloc(1, sizeof(Chip8Scaler));
+    if (!chip8->scaler || !chip8_graphics_set_filter(chip8, chip8->scale_filter)) {
+        fprintf(stderr, "创建显示纹理失败\n");
+        chip8_graphics_cleanup(chip8);
+        return 0;
+    }
+    
+    printf("图形系统初始化成功 (窗口: %dx%d)\n", WINDOW_WIDTH, WINDOW_HEIGHT);
     return 1;
 }
 
-// ͼʾdisplayеػƵ
-void chip8_graphics_update(Chip8* chip8) {
-    if (!chip8 || !chip8->renderer) return;
+// 切换放大滤镜：按输出尺寸重建流式纹理
+int chip8_graphics_set_filter(Chip8* chip8, int filter) {
+    if (!chip8 || !chip8->renderer || !chip8->scaler) return 0;
     
-    // 1. ûɫΪɫ
-    SDL_SetRenderDrawColor(chip8->renderer, 0, 0, 0, 255); // ɫ
-    SDL_RenderClear(chip8->renderer); // 
+    if (!chip8_scaler_init(chip8->scaler, (ScaleFilter)filter)) {
+        return 0;
+    }
     
-    // 2. ûɫΪɫǰ/أ
-    SDL_SetRenderDrawColor(chip8->renderer, 255, 255, 255, 255); // ɫ
+    if (chip8->texture) {
+        SDL_DestroyTexture(chip8->texture);
+    }
     
-    // 3. CHIP-8ʾ(64x32)""ػƵ
-    for (int y = 0; y < DISPLAY_HEIGHT; y++) {
-        for (int x = 0; x < DISPLAY_WIDTH; x++) {
-            // Ϊ""(ֵΪ1)
-            if (chip8->display[y * DISPLAY_WIDTH + x]) {
-                // ŴľλúʹС
-                SDL_Rect pixel_rect = {
-                    x * WINDOW_SCALE,      // ŴX
-                    y * WINDOW_SCALE,      // ŴY
-                    WINDOW_SCALE,          // ؿ
-                    WINDOW_SCALE           // ظ߶
-                };
-                // һʵľδһŴ
-                SDL_RenderFillRect(chip8->renderer, &pixel_rect);
-            }
-        }
+    // 最近邻滤镜依靠GPU放大，其余滤镜的输出同样按最近邻拉伸到窗口
+    SDL_SetHint(SDL_HINT_RENDER_SCALE_QUALITY, "0");
+    chip8->texture = SDL_CreateTexture(chip8->renderer, SDL_PIXELFORMAT_ARGB8888, SDL_TEXTUREACCESS_STREAMING,
+                                       chip8->scaler->width, chip8->scaler->height);
+    if (!chip8->texture) {
+        fprintf(stderr, "创建纹理失败: %s\n", SDL_GetError());
+        return 0;
+    }
+    
+    chip8->scale_filter = filter;
+    chip8->draw_flag = 1;
+    printf("放大滤镜: %s (纹理 %dx%d)\n", chip8_scale_filter_name((ScaleFilter)filter),
+           chip8->scaler->width, chip8->scaler->height);
+    return 1;
+}
+
+// 更新图形显示：放大display数组并只上传变化的行
+void chip8_graphics_update(Chip8* chip8) {
+    if (!chip8 || !chip8->renderer || !chip8->texture) return;
+    
+    // 1. 打包显示并运行放大滤镜
+    uint64_t rows[DISPLAY_HEIGHT];
+    chip8_pack_rows(chip8, rows);
+    
+    Chip8Scaler* scaler = chip8->scaler;
+    if (chip8_scaler_update(scaler, rows) > 0) {
+        // 2. 只上传脏行范围
+        SDL_Rect dirty = { 0, scaler->dirty_first, scaler->width, scaler->dirty_last - scaler->dirty_first + 1 };
+        SDL_UpdateTexture(chip8->texture, &dirty, scaler->pixels + (size_t)scaler->dirty_first * scaler->width,
+                          scaler->width * (int)sizeof(uint32_t));
     }
     
-    // 4. ȾύĻ
+    // 3. 清屏 (黑边) 并把纹理拉伸到窗口
+    SDL_SetRenderDrawColor(chip8->renderer, 0, 0, 0, 255);
+    SDL_RenderClear(chip8->renderer);
+    SDL_RenderCopy(chip8->renderer, chip8->texture, NULL, NULL);
+    
+    // 4. 将渲染结果提交到屏幕
     SDL_RenderPresent(chip8->renderer);
 }
 
-// ͼԴ
+// 清理图形资源
 void chip8_graphics_cleanup(Chip8* chip8) {
     if (!chip8) return;
     
+    if (chip8->texture) {
+        SDL_DestroyTexture(chip8->texture);
+        chip8->texture = NULL;
+    }
+    if (chip8->scaler) {
+        chip8_scaler_cleanup(chip8->scaler);
+        free(chip8->scaler);
+        chip8->scaler = NULL;
+    }
     if (chip8->renderer) {
         SDL_DestroyRenderer(chip8->renderer);
         chip8->renderer = NULL;
@@ -763,9 +1056,9 @@ void chip8_graphics_cleanup(Chip8* chip8) {
         chip8->window = NULL;
     }
     
-    // ƵԴ
+    // 清理音频资源
     chip8_audio_cleanup(chip8);
     
     SDL_Quit();
-    printf("ͼκƵԴ\n");
+    printf("图形和音频资源已清理\n");
 }
\ No newline at end of file
@@ -2,83 +2,155 @@
 #define CHIP8_H
 
 #include <stdint.h>
+#include <stddef.h>
 #include <SDL2/SDL.h>
+#include "chip8_audio.h"
+#include "chip8_rng.h"
 
-// ڴС - 4KB
+// 内存大小 - 4KB
 #define MEMORY_SIZE 4096
-#define PROGRAM_START 0x200  // ʼַ
-#define DISPLAY_WIDTH 64     // 
-#define DISPLAY_HEIGHT 32    // ߶
+#define MEMORY_MASK (MEMORY_SIZE - 1)  // 所有地址按4KB回绕
+#define MEMORY_GUARD 16      // 内存末尾镜像开头的字节数 (精灵最多15行，寄存器块最多16字节)
+#define PROGRAM_START 0x200  // 程序起始地址
+#define DISPLAY_WIDTH 64     // 宽度
+#define DISPLAY_HEIGHT 32    // 高度
+#define DISPLAY_PACKED_SIZE (DISPLAY_WIDTH * DISPLAY_HEIGHT / 8)  // 打包显示大小 (1位/像素)
 
-// ͼʾ
-#define WINDOW_SCALE 10 // ű
+// 图形显示常量
+#define WINDOW_SCALE 10 // 初始窗口缩放倍数 (窗口可任意调整大小)
 #define WINDOW_WIDTH (DISPLAY_WIDTH * WINDOW_SCALE)
 #define WINDOW_HEIGHT (DISPLAY_HEIGHT * WINDOW_SCALE)
 
-// Ƶ
-#define AUDIO_FREQUENCY 44100  // Ƶ (44.1kHz)
-#define AUDIO_FORMAT AUDIO_S16SYS  // Ƶʽ (16λз)
-#define AUDIO_CHANNELS 1       // 
-#define AUDIO_SAMPLES 4096     // ƵС
-#define BEEP_FREQUENCY 800     // Ƶ (800Hz)
-#define BEEP_VOLUME 3000       // 
+// 音频常量
+#define AUDIO_FREQUENCY 44100  // 音频采样率 (44.1kHz)
+#define AUDIO_FORMAT AUDIO_S16SYS  // 音频格式 (16位有符号整数)
+#define AUDIO_CHANNELS 1       // 单声道
+#define AUDIO_SAMPLES 4096     // 音频缓冲区大小
+#define BEEP_FREQUENCY 800     // 蜂鸣频率 (800Hz)
+#define BEEP_VOLUME 3000       // 蜂鸣音量
 
-// CPUִٶȿ (ָ/)
-#define CPU_MIN_SPEED 100      // СCPUٶ (100ָ/)
-#define CPU_MAX_SPEED 2000     // CPUٶ (2000ָ/)
-#define CPU_DEFAULT_SPEED 500  // ĬCPUٶ (500ָ/)
+// CPU执行速度控制 (指令/秒)
+#define CPU_MIN_SPEED 100      // 最小CPU速度 (100指令/秒)
+#define CPU_MAX_SPEED 2000     // 最大CPU速度 (2000指令/秒)
+#define CPU_DEFAULT_SPEED 500  // 默认CPU速度 (500指令/秒)
 
-// CPUṹ
+// 兼容性差异 (quirk) 标志
+#define QUIRK_VF_RESET      0x01   // 8XY1/8XY2/8XY3 之后VF清零
+#define QUIRK_MEMORY_INC_I  0x02   // FX55/FX65 之后I增加
+#define QUIRK_DISPLAY_WAIT  0x04   // DXYN 等待垂直消隐
+#define QUIRK_CLIPPING      0x08   // 精灵在屏幕边缘裁剪而不是环绕
+#define QUIRK_SHIFT_VX      0x10   // 8XY6/8XYE 只移位VX (忽略VY)
+#define QUIRK_JUMP_VX       0x20   // BNNN 使用VX而不是V0
+
+// chip8_reset 之后的默认配置 (与按平台选择之前的行为相同)。
+// QUIRK_DISPLAY_WAIT 只在 COSMAC VIP 时序模型下生效 (按指令/秒运行时没有帧内的时间概念)
+#define CHIP8_QUIRKS_DEFAULT (QUIRK_SHIFT_VX | QUIRK_DISPLAY_WAIT)
+
+struct Chip8Scaler;  // 放大滤镜 (chip8_scale.h)
+struct Chip8Trace;   // 执行跟踪 (chip8_trace.h)
+
+// 运行时故障类型
+typedef enum {
+    CHIP8_FAULT_NONE = 0,
+    CHIP8_FAULT_STACK_UNDERFLOW,   // 00EE时堆栈为空
+    CHIP8_FAULT_STACK_OVERFLOW,    // 2NNN时堆栈已满
+    CHIP8_FAULT_MEMORY_OOB,        // 保留编号 (内存访问按4KB回绕后不再产生)
+    CHIP8_FAULT_UNKNOWN_OPCODE,    // 未知操作码
+    CHIP8_FAULT_COUNT
+} Chip8Fault;
+
+// CPU结构体
 typedef struct {
-    // ڴ
-    uint8_t memory[MEMORY_SIZE];
+    // 内存，末尾 MEMORY_GUARD 字节是 memory[0..MEMORY_GUARD) 的镜像：
+    // 从任意地址 (已回绕) 起读取不超过 MEMORY_GUARD 字节时不需要判断是否越过4KB
+    uint8_t memory[MEMORY_SIZE + MEMORY_GUARD];
     
-    // Ĵ
-    uint8_t V[16];            // 168λͨüĴ (V0-VF)
-    uint16_t I;               // 16λַĴ
-    uint16_t pc;              // 
+    // 寄存器
+    uint8_t V[16];            // 16个8位通用寄存器 (V0-VF)
+    uint16_t I;               // 16位地址寄存器
+    uint16_t pc;              // 程序计数器
     
-    // ջ
-    uint16_t stack[16];       // 16ջ
-    uint8_t sp;               // ջָ
+    // 堆栈
+    uint16_t stack[16];       // 16层堆栈
+    uint8_t sp;               // 堆栈指针
     
-    // ʱ
-    uint8_t delay_timer;      // ӳٶʱ
-    uint8_t sound_timer;      // ʱ
+    // 定时器
+    uint8_t delay_timer;      // 延迟定时器
+    uint8_t sound_timer;      // 声音定时器
     
-    // ʾ
-    uint8_t display[DISPLAY_WIDTH * DISPLAY_HEIGHT];  // ػ (0=, 1=)
+    // 显示
+    uint8_t display[DISPLAY_WIDTH * DISPLAY_HEIGHT];  // 像素缓冲区 (0=关, 1=开)
     
-    //  (16: 0-9, A-F)
+    // 键盘输入 (16键: 0-9, A-F)
     uint8_t key[16];
     
-    // ״̬־
-    uint8_t draw_flag;        // Ҫػʾ
-    uint8_t key_wait;         // ȴ
-    uint8_t key_reg;          // ȴļĴ
+    // 状态标志
+    uint8_t draw_flag;        // 需要重绘显示
+    uint8_t key_wait;         // FX0A 正在等待按键
+    uint8_t wait_key;         // FX0A 等待期间已按下的键 (0xFF=尚未按下)
+    uint16_t key_fresh;       // 按下后还没有被 EX9E/EXA1/FX0A 读到的键 (位掩码)
+    uint16_t key_release;     // 延迟松开的键：被读到一次或下一次定时器更新时松开
+    
+    // 随机数生成器
+    Chip8Rng rng;             // CXNN使用 (种子、实例号和已取出的个数)
     
-    // ״̬
-    unsigned int random_seed; // 
+    // 时序模型
+    int32_t cycle_debt;       // VIP时序：上一帧超出预算的机器周期
     
-    // SDL2ͼ
-    SDL_Window* window;      // 
-    SDL_Renderer* renderer;  // Ⱦ
+    // 兼容性差异
+    uint8_t quirks;           // QUIRK_* (chip8_reset 设为 CHIP8_QUIRKS_DEFAULT，加载ROM后可按平台修改)
     
-    // SDL2Ƶ
-    SDL_AudioDeviceID audio_device;  // Ƶ豸ID
-    int audio_initialized;           // Ƶʼ־
-    double audio_phase;              // ƵλҲ
+    // XO-CHIP音频
+    Chip8Tone tone;           // F002图样与FX3A音高
+    
+    // 故障统计与执行跟踪
+    uint32_t fault_count[CHIP8_FAULT_COUNT];  // 各类故障发生次数
+    struct Chip8Trace* trace;  // 执行跟踪缓冲区 (NULL=关闭)
+    uint8_t quiet;            // 不输出运行时故障信息 (只计数)
+    
+    // SDL2图形相关
+    SDL_Window* window;      // 窗口
+    SDL_Renderer* renderer;  // 渲染器
+    SDL_Texture* texture;    // 流式纹理 (放大后的帧)
+    struct Chip8Scaler* scaler;  // 放大滤镜状态
+    int scale_filter;        // 当前放大滤镜 (ScaleFilter)
+    int present_vsync;       // 提交时等待垂直同步 (chip8_graphics_init 之前设置)
+    
+    // SDL2音频相关
+    SDL_AudioDeviceID audio_device;  // 音频设备ID
+    int audio_initialized;           // 音频初始化标志
+    SDL_Thread* audio_thread;        // 后台打开音频设备的线程 (NULL=没有进行中的打开)
+    SDL_atomic_t audio_opened;       // 后台打开已结束 (成功或失败)
+    SDL_AudioSpec audio_spec;        // 实际得到的音频格式
+    Chip8Voice voice;                // 合成器 (音频线程使用)
+    Chip8ToneMailbox tone_mailbox;   // 发声参数邮箱 (模拟线程 → 音频线程)
+    Chip8Tone published_tone;        // 上次发布的发声参数
 } Chip8;
 
-// 
+// 函数声明
 void chip8_init(Chip8* chip8);
+void chip8_reset(Chip8* chip8, unsigned int seed);  // 静默重置机器状态 (Philox，实例号0；其他配置之后调用 chip8_rng_init)
 int chip8_load_rom(Chip8* chip8, const char* filename);
+int chip8_load_rom_data(Chip8* chip8, const uint8_t* data, size_t size);
+void chip8_pack_display(const Chip8* chip8, uint8_t* packed);  // 打包显示 (DISPLAY_PACKED_SIZE字节)
+void chip8_pack_rows(const Chip8* chip8, uint64_t* rows);      // 打包为每行一个64位字 (最高位为x=0)
 void chip8_cycle(Chip8* chip8);
+void chip8_memory_sync(Chip8* chip8, uint16_t addr, int len);  // 写入 [addr, addr+len) 后维护回绕和镜像
+void chip8_fault(Chip8* chip8, Chip8Fault fault, uint16_t opcode);  // 记录运行时故障
 void chip8_update_timers(Chip8* chip8);
-int chip8_graphics_init(Chip8* chip8);    // ʼͼ
-void chip8_graphics_update(Chip8* chip8); // ͼʾ
-void chip8_graphics_cleanup(Chip8* chip8);// ͼԴ
-int chip8_audio_init(Chip8* chip8);       // ʼƵ
-void chip8_audio_cleanup(Chip8* chip8);   // ƵԴ
+int chip8_graphics_init(Chip8* chip8);    // 初始化图形
+void chip8_graphics_update(Chip8* chip8); // 更新图形显示
+int chip8_graphics_set_filter(Chip8* chip8, int filter);  // 切换放大滤镜
+void chip8_graphics_cleanup(Chip8* chip8);// 清理图形资源
+int chip8_audio_init(Chip8* chip8);       // 初始化音频
+int chip8_audio_init_async(Chip8* chip8); // 在后台线程打开音频设备，打开结束后由 chip8_audio_finish 开始播放
+int chip8_audio_finish(Chip8* chip8, int wait);  // 返回1表示后台打开已结束 (是否成功看 audio_initialized)，wait=0 时不阻塞
+void chip8_audio_cleanup(Chip8* chip8);   // 清理音频资源
+
+// 读取 addr 处的操作码 (地址回绕，0xFFF处的第二个字节来自镜像)
+static inline uint16_t chip8_read_opcode(const Chip8* chip8, uint16_t addr) {
+    const uint8_t* p = &chip8->memory[addr & MEMORY_MASK];
+    return (uint16_t)((p[0] << 8) | p[1]);
+}
 
 #endif // CHIP8_H
\ No newline at end of file
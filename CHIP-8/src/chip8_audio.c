@@ -0,0 +1,136 @@
+#include <string.h>
+#include <math.h>
+#include "chip8.h"
+#include "chip8_audio.h"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define AUDIO_X86 1
+#include <immintrin.h>
+#endif
+
+#define SINE_TABLE_SIZE 256
+
+// 每个音高每个输出样本的相位增量 (2^32 = 整个128位图样)
+static uint32_t PITCH_STEP[256];
+static uint32_t BEEP_STEP;
+static int16_t SINE_TABLE[SINE_TABLE_SIZE];
+static int tables_ready = 0;
+
+typedef void (*RenderPatternFn)(const uint8_t* pattern, uint32_t phase, uint32_t step, int16_t* out, int samples);
+static RenderPatternFn render_pattern = NULL;
+
+void chip8_tone_reset(Chip8Tone* tone) {
+    memset(tone, 0, sizeof(*tone));
+    tone->pitch = AUDIO_DEFAULT_PITCH;
+}
+
+// ============ 邮箱 ============
+
+void chip8_tone_publish(Chip8ToneMailbox* mailbox, const Chip8Tone* tone) {
+    int sequence = SDL_AtomicGet(&mailbox->sequence);
+    SDL_AtomicSet(&mailbox->sequence, sequence + 1);
+    SDL_MemoryBarrierRelease();
+    memcpy(&mailbox->tone, tone, sizeof(*tone));
+    SDL_MemoryBarrierRelease();
+    SDL_AtomicSet(&mailbox->sequence, sequence + 2);
+}
+
+int chip8_voice_receive(Chip8Voice* voice, Chip8ToneMailbox* mailbox) {
+    int sequence = SDL_AtomicGet(&mailbox->sequence);
+    if (sequence == voice->sequence || (sequence & 1)) return 0;  // 没有更新，或正在写入 (下一次回调再取)
+    
+    Chip8Tone tone;
+    memcpy(&tone, &mailbox->tone, sizeof(tone));
+    SDL_MemoryBarrierAcquire();
+    if (SDL_AtomicGet(&mailbox->sequence) != sequence) return 0;  // 读取期间被改写
+    
+    voice->tone = tone;
+    voice->sequence = sequence;
+    return 1;
+}
+
+// ============ 图样展开 ============
+
+static void render_pattern_scalar(const uint8_t* pattern, uint32_t phase, uint32_t step, int16_t* out, int samples) {
+    for (int i = 0; i < samples; i++) {
+        uint32_t bit = phase >> 25;
+        out[i] = ((pattern[bit >> 3] >> (7 - (bit & 7))) & 1) ? BEEP_VOLUME : -BEEP_VOLUME;
+        phase += step;
+    }
+}
+
+#ifdef AUDIO_X86
+// 每次16个样本：计算16个位序号 (0-127) 并压缩为字节，
+// 图样恰好16字节，用PSHUFB按字节序号查表，再用第二次查表得到位掩码
+__attribute__((target("ssse3")))
+static void render_pattern_ssse3(const uint8_t* pattern, uint32_t phase, uint32_t step, int16_t* out, int samples) {
+    const __m128i table = _mm_loadu_si128((const __m128i*)pattern);
+    const __m128i bit_masks = _mm_setr_epi8((char)0x80, 0x40, 0x20, 0x10, 0x08, 0x04, 0x02, 0x01,
+                                            (char)0x80, 0x40, 0x20, 0x10, 0x08, 0x04, 0x02, 0x01);
+    const __m128i low_nibble = _mm_set1_epi8(0x0F);
+    const __m128i low_bits = _mm_set1_epi8(0x07);
+    const __m128i high = _mm_set1_epi16(BEEP_VOLUME);
+    const __m128i low = _mm_set1_epi16(-BEEP_VOLUME);
+    const __m128i lanes = _mm_setr_epi32(0, (int)step, (int)(2 * step), (int)(3 * step));
+    const __m128i step4 = _mm_set1_epi32((int)(4 * step));
+    
+    int i = 0;
+    for (; i + 16 <= samples; i += 16) {
+        __m128i p0 = _mm_add_epi32(_mm_set1_epi32((int)phase), lanes);
+        __m128i p1 = _mm_add_epi32(p0, step4);
+        __m128i p2 = _mm_add_epi32(p1, step4);
+        __m128i p3 = _mm_add_epi32(p2, step4);
+        __m128i bits = _mm_packus_epi16(_mm_packs_epi32(_mm_srli_epi32(p0, 25), _mm_srli_epi32(p1, 25)),
+                                        _mm_packs_epi32(_mm_srli_epi32(p2, 25), _mm_srli_epi32(p3, 25)));
+        
+        __m128i bytes = _mm_shuffle_epi8(table, _mm_and_si128(_mm_srli_epi16(bits, 3), low_nibble));
+        __m128i masks = _mm_shuffle_epi8(bit_masks, _mm_and_si128(bits, low_bits));
+        __m128i on = _mm_cmpeq_epi8(_mm_and_si128(bytes, masks), masks);
+        
+        __m128i on_lo = _mm_unpacklo_epi8(on, on);
+        __m128i on_hi = _mm_unpackhi_epi8(on, on);
+        _mm_storeu_si128((__m128i*)(out + i), _mm_or_si128(_mm_and_si128(on_lo, high), _mm_andnot_si128(on_lo, low)));
+        _mm_storeu_si128((__m128i*)(out + i + 8), _mm_or_si128(_mm_and_si128(on_hi, high), _mm_andnot_si128(on_hi, low)));
+        phase += 16 * step;
+    }
+    render_pattern_scalar(pattern, phase, step, out + i, samples - i);
+}
+#endif
+
+// ============ 合成器 ============
+
+void chip8_voice_init(Chip8Voice* voice) {
+    memset(voice, 0, sizeof(*voice));
+    chip8_tone_reset(&voice->tone);
+    
+    // 查找表只在主线程初始化一次 (音频设备和录制线程启动之前)
+    if (tables_ready) return;
+    for (int pitch = 0; pitch < 256; pitch++) {
+        double rate = 4000.0 * pow(2.0, (pitch - 64) / 48.0);
+        PITCH_STEP[pitch] = (uint32_t)(rate / AUDIO_PATTERN_BITS / AUDIO_FREQUENCY * 4294967296.0);
+    }
+    BEEP_STEP = (uint32_t)((double)BEEP_FREQUENCY / AUDIO_FREQUENCY * 4294967296.0);
+    for (int i = 0; i < SINE_TABLE_SIZE; i++) {
+        SINE_TABLE[i] = (int16_t)(sin(i * 2.0 * M_PI / SINE_TABLE_SIZE) * BEEP_VOLUME);
+    }
+    
+    render_pattern = render_pattern_scalar;
+#ifdef AUDIO_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("ssse3")) render_pattern = render_pattern_ssse3;
+#endif
+    tables_ready = 1;
+}
+
+void chip8_voice_render(Chip8Voice* voice, int16_t* out, int samples) {
+    if (voice->tone.use_pattern) {
+        uint32_t step = PITCH_STEP[voice->tone.pitch];
+        render_pattern(voice->tone.pattern, voice->phase, step, out, samples);
+        voice->phase += (uint32_t)samples * step;
+    } else {
+        for (int i = 0; i < samples; i++) {
+            out[i] = SINE_TABLE[voice->phase >> 24];
+            voice->phase += BEEP_STEP;
+        }
+    }
+}
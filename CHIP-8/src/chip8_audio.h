@@ -0,0 +1,50 @@
+#ifndef CHIP8_AUDIO_H
+#define CHIP8_AUDIO_H
+
+#include <stdint.h>
+#include <SDL2/SDL.h>
+
+// XO-CHIP音频：F002 从 [I] 载入16字节 (128个1位样本) 的图样，FX3A 设置音高，
+// 声音定时器非零时按 4000*2^((pitch-64)/48) Hz 的速率循环播放图样。
+// 尚未执行F002的程序保持原来的正弦蜂鸣声。
+// 模拟线程通过无锁邮箱 (seqlock) 把图样和音高交给音频线程，双方都不会阻塞；
+// 音频线程按预先算好的每个音高的相位步长，用SIMD把图样展开为16位PCM
+
+#define AUDIO_PATTERN_SIZE 16           // 图样字节数
+#define AUDIO_PATTERN_BITS (AUDIO_PATTERN_SIZE * 8)
+#define AUDIO_DEFAULT_PITCH 64          // 4000Hz
+
+// 发声参数 (属于机器状态，随快照、回滚和状态文件保存)
+typedef struct {
+    uint8_t pattern[AUDIO_PATTERN_SIZE];  // 最高位先播放
+    uint8_t pitch;
+    uint8_t use_pattern;                // 已执行过F002 (0=默认蜂鸣)
+} Chip8Tone;
+
+// 单写者邮箱：序号为奇数时写者正在写入，读者在序号前后不一致时放弃本次读取
+typedef struct {
+    SDL_atomic_t sequence;
+    Chip8Tone tone;
+} Chip8ToneMailbox;
+
+// 合成器 (只在一个线程中使用)
+typedef struct {
+    Chip8Tone tone;
+    uint32_t phase;                     // 图样：高7位为当前位序号；蜂鸣：高8位为正弦表序号
+    int sequence;                       // 上次从邮箱取到的序号
+} Chip8Voice;
+
+void chip8_tone_reset(Chip8Tone* tone);
+
+// 模拟线程发布新的发声参数 (只有一个写者)
+void chip8_tone_publish(Chip8ToneMailbox* mailbox, const Chip8Tone* tone);
+
+void chip8_voice_init(Chip8Voice* voice);
+
+// 音频线程取出邮箱中的最新参数，返回1表示有更新
+int chip8_voice_receive(Chip8Voice* voice, Chip8ToneMailbox* mailbox);
+
+// 生成 samples 个 AUDIO_FREQUENCY 采样率的样本
+void chip8_voice_render(Chip8Voice* voice, int16_t* out, int samples);
+
+#endif // CHIP8_AUDIO_H
@@ -0,0 +1,588 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include "chip8_debug.h"
+#include "chip8_disasm.h"
+
+static const char* OP_NAMES[] = { "==", "!=", "<", ">", "<=", ">=" };
+
+// 控制台：读取线程可能一直阻塞在stdin上 (没有可移植的办法打断 fgets)，
+// 所以与调试器分开分配，按引用计数释放：调试器清理后，线程醒来时发现已关闭并释放
+typedef struct DebugConsole {
+    SDL_mutex* lock;
+    SDL_atomic_t refs;         // 调试器和读取线程各持有一个引用
+    int closed;                // 调试器已清理，不再接收命令
+    char lines[DEBUG_CONSOLE_LINES][DEBUG_LINE_SIZE];
+    int line_head;
+    int line_tail;
+} DebugConsole;
+
+static void console_release(DebugConsole* console) {
+    if (SDL_AtomicDecRef(&console->refs)) {
+        SDL_DestroyMutex(console->lock);
+        free(console);
+    }
+}
+
+static int bit_test(const uint8_t* bitmap, uint16_t addr) {
+    return bitmap[addr >> 3] & (1 << (addr & 7));
+}
+
+static void bit_set(uint8_t* bitmap, uint16_t addr, int enable) {
+    if (enable) bitmap[addr >> 3] |= (uint8_t)(1 << (addr & 7));
+    else bitmap[addr >> 3] &= (uint8_t)~(1 << (addr & 7));
+}
+
+void chip8_debug_init(Chip8Debugger* dbg) {
+    memset(dbg, 0, sizeof(*dbg));
+}
+
+void chip8_debug_cleanup(Chip8Debugger* dbg) {
+    // 控制台线程阻塞在stdin上，已经分离，不等待：标记关闭后释放本方的引用
+    if (dbg->console) {
+        SDL_LockMutex(dbg->console->lock);
+        dbg->console->closed = 1;
+        SDL_UnlockMutex(dbg->console->lock);
+        console_release(dbg->console);
+        dbg->console = NULL;
+    }
+    if (dbg->search) {
+        chip8_search_cleanup(dbg->search);
+        free(dbg->search);
+        dbg->search = NULL;
+    }
+}
+
+void chip8_debug_set_breakpoint(Chip8Debugger* dbg, uint16_t addr, int enable) {
+    bit_set(dbg->breakpoints, addr & (MEMORY_SIZE - 1), enable);
+}
+
+// 重新计算一页的监视点标记
+static void update_page(Chip8Debugger* dbg, int page) {
+    uint8_t armed = 0;
+    int first = page * DEBUG_PAGE_SIZE / 8;
+    for (int i = first; i < first + DEBUG_PAGE_SIZE / 8; i++) {
+        if (dbg->watch_read[i]) armed |= DEBUG_WATCH_READ;
+        if (dbg->watch_write[i]) armed |= DEBUG_WATCH_WRITE;
+    }
+    
+    if (armed && !dbg->page_armed[page]) dbg->watch_count++;
+    if (!armed && dbg->page_armed[page]) dbg->watch_count--;
+    dbg->page_armed[page] = armed;
+}
+
+void chip8_debug_set_watch(Chip8Debugger* dbg, uint16_t addr, uint16_t len, int mode, int enable) {
+    for (uint32_t i = 0; i < len; i++) {
+        uint16_t a = (uint16_t)((addr + i) & (MEMORY_SIZE - 1));
+        if (mode & DEBUG_WATCH_READ) bit_set(dbg->watch_read, a, enable);
+        if (mode & DEBUG_WATCH_WRITE) bit_set(dbg->watch_write, a, enable);
+    }
+    for (int page = 0; page < DEBUG_PAGE_COUNT; page++) {
+        update_page(dbg, page);
+    }
+}
+
+int chip8_debug_add_condition(Chip8Debugger* dbg, uint8_t reg, DebugOp op, uint16_t value) {
+    if (dbg->condition_count >= DEBUG_MAX_CONDITIONS) return 0;
+    
+    Chip8DebugCondition* cond = &dbg->conditions[dbg->condition_count++];
+    cond->reg = reg;
+    cond->op = (uint8_t)op;
+    cond->value = value;
+    cond->was_true = 0;
+    return 1;
+}
+
+// 指令即将访问的内存范围 (FX33/FX55/FX65/DXYN/F002)
+static int instruction_access(const Chip8* chip8, uint16_t opcode, uint16_t* addr, uint16_t* len) {
+    uint8_t x = (opcode & 0x0F00) >> 8;
+    *addr = chip8->I;
+    
+    if ((opcode & 0xF000) == 0xD000) {
+        *len = opcode & 0x000F;
+        return DEBUG_WATCH_READ;
+    }
+    if ((opcode & 0xF000) == 0xF000) {
+        switch (opcode & 0x00FF) {
+            case 0x33: *len = 3;     return DEBUG_WATCH_WRITE;
+            case 0x55: *len = x + 1; return DEBUG_WATCH_WRITE;
+            case 0x65: *len = x + 1; return DEBUG_WATCH_READ;
+            case 0x02:
+                if (x != 0) break;
+                *len = AUDIO_PATTERN_SIZE;
+                return DEBUG_WATCH_READ;
+        }
+    }
+    return 0;
+}
+
+// 检查范围内是否有监视点，返回命中的地址，没有则返回-1
+static int check_watch(const Chip8Debugger* dbg, uint16_t addr, uint16_t len, int mode) {
+    const uint8_t* bitmap = (mode == DEBUG_WATCH_READ) ? dbg->watch_read : dbg->watch_write;
+    
+    uint32_t i = 0;
+    while (i < len) {
+        uint16_t a = (uint16_t)((addr + i) & (MEMORY_SIZE - 1));
+        if (!(dbg->page_armed[a / DEBUG_PAGE_SIZE] & mode)) {
+            i += DEBUG_PAGE_SIZE - (a % DEBUG_PAGE_SIZE);  // 本页没有监视点，跳过剩余部分
+            continue;
+        }
+        if (bit_test(bitmap, a)) return a;
+        i++;
+    }
+    return -1;
+}
+
+static uint16_t condition_register(const Chip8* chip8, uint8_t reg) {
+    if (reg < 16) return chip8->V[reg];
+    if (reg == DEBUG_REG_I) return chip8->I;
+    if (reg == DEBUG_REG_DT) return chip8->delay_timer;
+    return chip8->sound_timer;
+}
+
+static int condition_holds(const Chip8* chip8, const Chip8DebugCondition* cond) {
+    uint16_t v = condition_register(chip8, cond->reg);
+    switch (cond->op) {
+        case DEBUG_OP_EQ: return v == cond->value;
+        case DEBUG_OP_NE: return v != cond->value;
+        case DEBUG_OP_LT: return v < cond->value;
+        case DEBUG_OP_GT: return v > cond->value;
+        case DEBUG_OP_LE: return v <= cond->value;
+        default:          return v >= cond->value;
+    }
+}
+
+static void format_register(uint8_t reg, char* buf, size_t size) {
+    if (reg < 16) snprintf(buf, size, "V%X", reg);
+    else if (reg == DEBUG_REG_I) snprintf(buf, size, "I");
+    else if (reg == DEBUG_REG_DT) snprintf(buf, size, "DT");
+    else snprintf(buf, size, "ST");
+}
+
+int chip8_debug_cycle(Chip8Debugger* dbg, Chip8* chip8) {
+    if (dbg->paused) return 0;
+    
+    if (!dbg->skip_checks) {
+        uint16_t pc = chip8->pc & (MEMORY_SIZE - 1);
+        
+        if (bit_test(dbg->breakpoints, pc)) {
+            chip8_debug_pause(dbg, chip8, "断点");
+            return 0;
+        }
+        
+        if (dbg->watch_count > 0) {
+            uint16_t addr, len;
+            int mode = instruction_access(chip8, chip8_read_opcode(chip8, pc), &addr, &len);
+            int hit = mode ? check_watch(dbg, addr, len, mode) : -1;
+            if (hit >= 0) {
+                char reason[64];
+                snprintf(reason, sizeof(reason), "%s监视点 0x%03X", mode == DEBUG_WATCH_READ ? "读" : "写", hit);
+                chip8_debug_pause(dbg, chip8, reason);
+                return 0;
+            }
+        }
+    }
+    dbg->skip_checks = 0;
+    
+    chip8_cycle(chip8);
+    
+    if (dbg->step_over && chip8->pc == dbg->step_over_pc && chip8->sp == dbg->step_over_sp) {
+        dbg->step_over = 0;
+        chip8_debug_pause(dbg, chip8, "单步跳过");
+        return 1;
+    }
+    
+    for (int i = 0; i < dbg->condition_count; i++) {
+        Chip8DebugCondition* cond = &dbg->conditions[i];
+        int holds = condition_holds(chip8, cond);
+        if (holds && !cond->was_true) {
+            char reg[4], reason[64];
+            format_register(cond->reg, reg, sizeof(reg));
+            snprintf(reason, sizeof(reason), "条件 %s %s 0x%X", reg, OP_NAMES[cond->op], cond->value);
+            cond->was_true = 1;
+            chip8_debug_pause(dbg, chip8, reason);
+            return 1;
+        }
+        cond->was_true = (uint8_t)holds;
+    }
+    return 1;
+}
+
+void chip8_debug_pause(Chip8Debugger* dbg, const Chip8* chip8, const char* reason) {
+    char text[32];
+    uint16_t opcode = chip8_read_opcode(chip8, chip8->pc);
+    chip8_disassemble(opcode, text, sizeof(text));
+    
+    dbg->paused = 1;
+    dbg->step_over = 0;
+    printf("[调试] %s，PC=0x%03X: %04X  %s\n", reason, chip8->pc, opcode, text);
+}
+
+void chip8_debug_continue(Chip8Debugger* dbg) {
+    dbg->paused = 0;
+    dbg->skip_checks = 1;
+}
+
+void chip8_debug_step(Chip8Debugger* dbg, Chip8* chip8, int count) {
+    for (int i = 0; i < count; i++) {
+        chip8_cycle(chip8);
+    }
+    chip8_debug_pause(dbg, chip8, "单步");
+}
+
+void chip8_debug_step_over(Chip8Debugger* dbg, Chip8* chip8) {
+    uint16_t opcode = chip8_read_opcode(chip8, chip8->pc);
+    if ((opcode & 0xF000) != 0x2000) {
+        chip8_debug_step(dbg, chip8, 1);
+        return;
+    }
+    
+    // 运行到子程序返回 (返回地址相同且堆栈深度恢复)
+    dbg->step_over = 1;
+    dbg->step_over_pc = (uint16_t)(chip8->pc + 2);
+    dbg->step_over_sp = chip8->sp;
+    chip8_debug_continue(dbg);
+}
+
+void chip8_debug_print_registers(const Chip8* chip8) {
+    printf("PC=0x%03X  I=0x%03X  SP=%u  DT=%u  ST=%u\n",
+           chip8->pc, chip8->I, chip8->sp, chip8->delay_timer, chip8->sound_timer);
+    for (int i = 0; i < 16; i++) {
+        printf("V%X=%02X%s", i, chip8->V[i], (i % 8 == 7) ? "\n" : "  ");
+    }
+    if (chip8->sp > 0) {
+        printf("堆栈:");
+        for (int i = 0; i < chip8->sp && i < 16; i++) {
+            printf(" 0x%03X", chip8->stack[i]);
+        }
+        printf("\n");
+    }
+}
+
+void chip8_debug_print_disassembly(const Chip8* chip8, uint16_t addr, int count) {
+    for (int i = 0; i < count; i++) {
+        uint16_t a = (uint16_t)((addr + i * 2) & (MEMORY_SIZE - 1));
+        uint16_t opcode = chip8_read_opcode(chip8, a);
+        char text[32];
+        chip8_disassemble(opcode, text, sizeof(text));
+        printf("%s 0x%03X: %04X  %s\n", a == chip8->pc ? "=>" : "  ", a, opcode, text);
+    }
+}
+
+static void print_memory(const Chip8* chip8, uint16_t addr, int len) {
+    for (int i = 0; i < len; i += 16) {
+        printf("0x%03X:", (addr + i) & (MEMORY_SIZE - 1));
+        for (int j = i; j < i + 16 && j < len; j++) {
+            printf(" %02X", chip8->memory[(addr + j) & (MEMORY_SIZE - 1)]);
+        }
+        printf("\n");
+    }
+}
+
+static void print_breakpoints(const Chip8Debugger* dbg) {
+    printf("断点:");
+    for (int a = 0; a < MEMORY_SIZE; a++) {
+        if (bit_test(dbg->breakpoints, (uint16_t)a)) printf(" 0x%03X", a);
+    }
+    printf("\n监视点:");
+    for (int a = 0; a < MEMORY_SIZE; a++) {
+        int r = bit_test(dbg->watch_read, (uint16_t)a) != 0;
+        int w = bit_test(dbg->watch_write, (uint16_t)a) != 0;
+        if (r || w) printf(" 0x%03X(%s%s)", a, r ? "r" : "", w ? "w" : "");
+    }
+    printf("\n条件:");
+    for (int i = 0; i < dbg->condition_count; i++) {
+        char reg[4];
+        format_register(dbg->conditions[i].reg, reg, sizeof(reg));
+        printf(" [%d] %s %s 0x%X", i, reg, OP_NAMES[dbg->conditions[i].op], dbg->conditions[i].value);
+    }
+    printf("\n");
+}
+
+static void print_help(void) {
+    printf("调试命令:\n");
+    printf("  c                 继续运行          p           暂停\n");
+    printf("  s [N]             单步执行N条指令    n           单步跳过 (2NNN整体执行)\n");
+    printf("  r                 显示寄存器        l           列出断点/监视点/条件\n");
+    printf("  b <地址>          设置断点          bd <地址>   删除断点\n");
+    printf("  w <地址> [长度] [r|w|rw]  设置监视点 (默认写)\n");
+    printf("  wd <地址> [长度]  删除监视点\n");
+    printf("  if <寄存器> <op> <值>  寄存器条件 (V0-VF/I/DT/ST, op: == != < > <= >=)\n");
+    printf("  ifd               删除全部条件\n");
+    printf("  d [地址] [N]      反汇编            m <地址> [N] 显示内存\n");
+    printf("  sn                拍内存快照        sa          每帧自动拍快照 开/关\n");
+    printf("  sf <条件> [值] [all]  筛选候选地址 (eq/ne/lt/gt N, ch, un, inc [N], dec [N], reg Vx [N];\n");
+    printf("                    默认比较最新两个快照，all 要求上次筛选以来的每个快照都满足)\n");
+    printf("  sl [N]            列出候选          sr          重新开始搜索\n");
+    printf("  fz [地址] [值]    冻结内存 (默认当前值，无参数时列出)  fzd <地址> 取消冻结\n");
+    printf("快捷键: F5=暂停/继续, F10=单步跳过, F11=单步\n");
+}
+
+// 解析寄存器名
+static int parse_register(const char* name) {
+    if ((name[0] == 'V' || name[0] == 'v') && isxdigit((unsigned char)name[1]) && name[2] == '\0') {
+        return (int)strtol(name + 1, NULL, 16);
+    }
+    if (strcasecmp(name, "I") == 0) return DEBUG_REG_I;
+    if (strcasecmp(name, "DT") == 0) return DEBUG_REG_DT;
+    if (strcasecmp(name, "ST") == 0) return DEBUG_REG_ST;
+    return -1;
+}
+
+static int parse_op(const char* op) {
+    for (int i = 0; i < (int)(sizeof(OP_NAMES) / sizeof(OP_NAMES[0])); i++) {
+        if (strcmp(op, OP_NAMES[i]) == 0) return i;
+    }
+    return -1;
+}
+
+// ============ 内存搜索 ============
+
+static Chip8Search* get_search(Chip8Debugger* dbg) {
+    if (dbg->search) return dbg->search;
+    
+    Chip8Search* search = (Chip8Search*)malloc(sizeof(Chip8Search));
+    if (!search || !chip8_search_init(search, 1, SEARCH_DEFAULT_SNAPSHOTS)) {
+        free(search);
+        return NULL;
+    }
+    dbg->search = search;
+    return search;
+}
+
+void chip8_debug_frame(Chip8Debugger* dbg, const Chip8* chip8) {
+    if (dbg->search_auto && dbg->search) {
+        chip8_search_snapshot(dbg->search, chip8, sizeof(Chip8));
+    }
+}
+
+void chip8_debug_apply_freezes(Chip8Debugger* dbg, Chip8* chip8) {
+    if (dbg->search && dbg->search->freeze_count > 0) {
+        chip8_search_apply_freezes(dbg->search, chip8, sizeof(Chip8));
+    }
+}
+
+static void print_candidates(const Chip8Search* search, int max) {
+    Chip8SearchHit hits[256];
+    if (max > 256) max = 256;
+    int count = chip8_search_list(search, hits, max);
+    
+    printf("[搜索] %llu个候选 (%llu个快照)", (unsigned long long)chip8_search_count(search),
+           (unsigned long long)search->taken);
+    for (int i = 0; i < count; i++) {
+        printf("%s0x%03X=%02X", i % 8 == 0 ? "\n  " : "  ", hits[i].addr,
+               chip8_search_value(search, hits[i].instance, hits[i].addr));
+    }
+    printf("\n");
+}
+
+// sf <条件> [值] [all]：eq/ne/lt/gt N, ch, un, inc [N], dec [N], delta N, reg Vx [N]
+static void search_filter_command(Chip8Debugger* dbg, const char* line) {
+    char name[16] = "", a1[32] = "", a2[32] = "", a3[32] = "";
+    int argc = sscanf(line, "%*s %15s %31s %31s %31s", name, a1, a2, a3);
+    
+    Chip8SearchFilter filter = { SEARCH_EQ, 0, 0, 0 };
+    int op = chip8_search_op_from_name(name);
+    if (argc < 1 || op < 0) {
+        printf("[搜索] 未知的条件: %s (eq ne lt gt ch un inc dec delta reg)\n", argc < 1 ? "" : name);
+        return;
+    }
+    filter.op = (Chip8SearchOp)op;
+    
+    // 条件之后依次为 [寄存器] [数值] [all]
+    char* args[3] = { a1, a2, a3 };
+    int next = 0;
+    if (filter.op == SEARCH_REGISTER) {
+        filter.reg = parse_register(args[next]);
+        if (filter.reg < 0 || filter.reg > 15) {
+            printf("[搜索] reg 需要寄存器 V0-VF\n");
+            return;
+        }
+        next++;
+    }
+    if (next < 3 && args[next][0] && strcmp(args[next], "all") != 0) {
+        filter.value = (int)strtol(args[next], NULL, 0);
+        // inc N / dec N：按固定差值筛选
+        if (filter.op == SEARCH_INCREASED) filter.op = SEARCH_DELTA;
+        if (filter.op == SEARCH_DECREASED) {
+            filter.op = SEARCH_DELTA;
+            filter.value = -filter.value;
+        }
+        next++;
+    }
+    if (next < 3 && strcmp(args[next], "all") == 0) {
+        filter.all = 1;
+    }
+    
+    Chip8Search* search = get_search(dbg);
+    if (!search) return;
+    uint64_t start = SDL_GetPerformanceCounter();
+    if (!chip8_search_filter(search, &filter)) {
+        printf("[搜索] 快照不够，先用 sn 拍快照 (ch/un/inc/dec/delta 至少需要两个)\n");
+        return;
+    }
+    double ms = (SDL_GetPerformanceCounter() - start) * 1000.0 / SDL_GetPerformanceFrequency();
+    printf("[搜索] 筛选用时 %.2fms\n", ms);
+    print_candidates(search, 16);
+}
+
+static void print_freezes(const Chip8Search* search) {
+    printf("[搜索] 冻结:");
+    for (int i = 0; search && i < search->freeze_count; i++) {
+        printf(" 0x%03X=%02X", search->freezes[i].addr, search->freezes[i].value);
+    }
+    printf("\n");
+}
+
+void chip8_debug_command(Chip8Debugger* dbg, Chip8* chip8, const char* line) {
+    char cmd[16] = "", a1[32] = "", a2[32] = "", a3[32] = "";
+    int argc = sscanf(line, "%15s %31s %31s %31s", cmd, a1, a2, a3);
+    if (argc <= 0) return;
+    
+    // 地址和数值接受十六进制 (0x前缀) 或十进制
+    uint16_t v1 = (uint16_t)strtoul(a1, NULL, 0);
+    uint16_t v2 = (uint16_t)strtoul(a2, NULL, 0);
+    
+    if (strcmp(cmd, "c") == 0) {
+        chip8_debug_continue(dbg);
+        printf("[调试] 继续运行\n");
+    } else if (strcmp(cmd, "p") == 0) {
+        chip8_debug_pause(dbg, chip8, "暂停");
+    } else if (strcmp(cmd, "s") == 0) {
+        chip8_debug_step(dbg, chip8, argc > 1 && v1 > 0 ? v1 : 1);
+    } else if (strcmp(cmd, "n") == 0) {
+        chip8_debug_step_over(dbg, chip8);
+    } else if (strcmp(cmd, "r") == 0) {
+        chip8_debug_print_registers(chip8);
+    } else if (strcmp(cmd, "l") == 0) {
+        print_breakpoints(dbg);
+    } else if (strcmp(cmd, "b") == 0 && argc > 1) {
+        chip8_debug_set_breakpoint(dbg, v1, 1);
+        printf("[调试] 断点: 0x%03X\n", v1 & (MEMORY_SIZE - 1));
+    } else if (strcmp(cmd, "bd") == 0 && argc > 1) {
+        chip8_debug_set_breakpoint(dbg, v1, 0);
+    } else if (strcmp(cmd, "w") == 0 && argc > 1) {
+        uint16_t len = argc > 2 && v2 > 0 ? v2 : 1;
+        int mode = DEBUG_WATCH_WRITE;
+        if (argc > 3) {
+            mode = (strchr(a3, 'r') ? DEBUG_WATCH_READ : 0) | (strchr(a3, 'w') ? DEBUG_WATCH_WRITE : 0);
+        }
+        chip8_debug_set_watch(dbg, v1, len, mode, 1);
+        printf("[调试] 监视点: 0x%03X-0x%03X\n", v1 & (MEMORY_SIZE - 1), (v1 + len - 1) & (MEMORY_SIZE - 1));
+    } else if (strcmp(cmd, "wd") == 0 && argc > 1) {
+        chip8_debug_set_watch(dbg, v1, argc > 2 && v2 > 0 ? v2 : 1, DEBUG_WATCH_READ | DEBUG_WATCH_WRITE, 0);
+    } else if (strcmp(cmd, "if") == 0 && argc > 3) {
+        int reg = parse_register(a1);
+        int op = parse_op(a2);
+        if (reg < 0 || op < 0) {
+            printf("[调试] 无效的条件: %s", line);
+        } else if (!chip8_debug_add_condition(dbg, (uint8_t)reg, (DebugOp)op, (uint16_t)strtoul(a3, NULL, 0))) {
+            printf("[调试] 条件数量已达上限 (%d)\n", DEBUG_MAX_CONDITIONS);
+        }
+    } else if (strcmp(cmd, "ifd") == 0) {
+        dbg->condition_count = 0;
+    } else if (strcmp(cmd, "d") == 0) {
+        chip8_debug_print_disassembly(chip8, argc > 1 ? v1 : chip8->pc, argc > 2 && v2 > 0 ? v2 : 8);
+    } else if (strcmp(cmd, "m") == 0 && argc > 1) {
+        print_memory(chip8, v1, argc > 2 && v2 > 0 ? v2 : 64);
+    } else if (strcmp(cmd, "sn") == 0) {
+        Chip8Search* search = get_search(dbg);
+        if (search) {
+            chip8_search_snapshot(search, chip8, sizeof(Chip8));
+            print_candidates(search, 0);
+        }
+    } else if (strcmp(cmd, "sa") == 0) {
+        dbg->search_auto = get_search(dbg) && !dbg->search_auto;
+        printf("[搜索] 每帧自动拍快照: %s\n", dbg->search_auto ? "开" : "关");
+    } else if (strcmp(cmd, "sf") == 0) {
+        search_filter_command(dbg, line);
+    } else if (strcmp(cmd, "sl") == 0) {
+        if (dbg->search) print_candidates(dbg->search, argc > 1 && v1 > 0 ? v1 : 64);
+    } else if (strcmp(cmd, "sr") == 0) {
+        if (dbg->search) chip8_search_reset(dbg->search);
+        printf("[搜索] 已重新开始\n");
+    } else if (strcmp(cmd, "fz") == 0) {
+        Chip8Search* search = argc > 1 ? get_search(dbg) : dbg->search;
+        if (argc > 1 && search) {
+            uint8_t value = argc > 2 ? (uint8_t)v2 : chip8->memory[v1 & MEMORY_MASK];
+            if (chip8_search_freeze(search, -1, v1, value)) {
+                chip8_debug_apply_freezes(dbg, chip8);
+            } else {
+                printf("[搜索] 冻结数量已达上限 (%d)\n", SEARCH_MAX_FREEZES);
+            }
+        }
+        print_freezes(search);
+    } else if (strcmp(cmd, "fzd") == 0 && argc > 1) {
+        if (dbg->search) chip8_search_unfreeze(dbg->search, -1, v1);
+        print_freezes(dbg->search);
+    } else if (strcmp(cmd, "h") == 0 || strcmp(cmd, "help") == 0) {
+        print_help();
+    } else {
+        printf("[调试] 未知命令: %s (输入 h 查看帮助)\n", cmd);
+    }
+}
+
+// 控制台线程：逐行读取stdin放入队列
+static int console_thread(void* data) {
+    DebugConsole* console = (DebugConsole*)data;
+    char line[DEBUG_LINE_SIZE];
+    
+    while (fgets(line, sizeof(line), stdin)) {
+        SDL_LockMutex(console->lock);
+        int closed = console->closed;
+        if (!closed && console->line_head - console->line_tail < DEBUG_CONSOLE_LINES) {
+            memcpy(console->lines[console->line_head % DEBUG_CONSOLE_LINES], line, sizeof(line));
+            console->line_head++;
+        }
+        SDL_UnlockMutex(console->lock);
+        if (closed) break;
+    }
+    
+    console_release(console);
+    return 0;
+}
+
+int chip8_debug_console_start(Chip8Debugger* dbg) {
+    if (dbg->console) return 1;
+    
+    DebugConsole* console = (DebugConsole*)calloc(1, sizeof(DebugConsole));
+    if (!console || !(console->lock = SDL_CreateMutex())) {
+        fprintf(stderr, "错误: 无法创建调试控制台\n");
+        free(console);
+        return 0;
+    }
+    SDL_AtomicSet(&console->refs, 2);
+    
+    SDL_Thread* thread = SDL_CreateThread(console_thread, "chip8_debug", console);
+    if (!thread) {
+        fprintf(stderr, "错误: 无法创建调试控制台线程: %s\n", SDL_GetError());
+        SDL_DestroyMutex(console->lock);
+        free(console);
+        return 0;
+    }
+    SDL_DetachThread(thread);
+    dbg->console = console;
+    
+    printf("调试器已启用 (输入 h 查看命令)\n");
+    return 1;
+}
+
+void chip8_debug_poll(Chip8Debugger* dbg, Chip8* chip8) {
+    DebugConsole* console = dbg->console;
+    char line[DEBUG_LINE_SIZE];
+    if (!console) return;
+    
+    for (;;) {
+        SDL_LockMutex(console->lock);
+        int have = console->line_tail != console->line_head;
+        if (have) {
+            memcpy(line, console->lines[console->line_tail % DEBUG_CONSOLE_LINES], sizeof(line));
+            console->line_tail++;
+        }
+        SDL_UnlockMutex(console->lock);
+        
+        if (!have) break;
+        chip8_debug_command(dbg, chip8, line);
+    }
+}
@@ -0,0 +1,97 @@
+#ifndef CHIP8_DEBUG_H
+#define CHIP8_DEBUG_H
+
+#include "chip8.h"
+#include "chip8_search.h"
+
+// 调试器：断点、内存监视点、寄存器条件、单步/单步跳过。
+// 检查全部放在 chip8_debug_cycle 中，正常运行仍调用 chip8_cycle，没有额外开销；
+// 监视点按256字节分页标记，访问范围所在页未设置监视点时直接跳过逐字节检查
+
+#define DEBUG_PAGE_SIZE 256
+#define DEBUG_PAGE_COUNT (MEMORY_SIZE / DEBUG_PAGE_SIZE)
+#define DEBUG_MAX_CONDITIONS 8
+#define DEBUG_CONSOLE_LINES 16
+#define DEBUG_LINE_SIZE 128
+
+// 监视点类型
+#define DEBUG_WATCH_READ  0x01
+#define DEBUG_WATCH_WRITE 0x02
+
+// 条件中的寄存器编号：0-15为V0-VF
+#define DEBUG_REG_I  16
+#define DEBUG_REG_DT 17
+#define DEBUG_REG_ST 18
+
+typedef enum {
+    DEBUG_OP_EQ = 0,
+    DEBUG_OP_NE,
+    DEBUG_OP_LT,
+    DEBUG_OP_GT,
+    DEBUG_OP_LE,
+    DEBUG_OP_GE
+} DebugOp;
+
+// 寄存器条件：从不成立变为成立时中断
+typedef struct {
+    uint8_t reg;
+    uint8_t op;
+    uint16_t value;
+    uint8_t was_true;
+} Chip8DebugCondition;
+
+typedef struct {
+    uint8_t breakpoints[MEMORY_SIZE / 8];   // PC断点位图
+    uint8_t watch_read[MEMORY_SIZE / 8];    // 读监视点位图
+    uint8_t watch_write[MEMORY_SIZE / 8];   // 写监视点位图
+    uint8_t page_armed[DEBUG_PAGE_COUNT];   // 每页已设置的监视点类型
+    int watch_count;                        // 已设置监视点的页数
+    
+    Chip8DebugCondition conditions[DEBUG_MAX_CONDITIONS];
+    int condition_count;
+    
+    int paused;                // 已暂停
+    int skip_checks;           // 继续运行时不再在当前指令上中断
+    int step_over;             // 正在单步跳过 2NNN
+    uint16_t step_over_pc;     // 子程序返回地址
+    uint8_t step_over_sp;      // 调用前的堆栈深度
+    
+    Chip8Search* search;       // 内存搜索 (第一次使用时分配)
+    int search_auto;           // 每帧自动拍快照
+    
+    // 控制台 (stdin读取线程 -> 主循环)，与读取线程共享，最后一个使用者释放
+    struct DebugConsole* console;
+} Chip8Debugger;
+
+void chip8_debug_init(Chip8Debugger* dbg);
+void chip8_debug_cleanup(Chip8Debugger* dbg);
+
+void chip8_debug_set_breakpoint(Chip8Debugger* dbg, uint16_t addr, int enable);
+void chip8_debug_set_watch(Chip8Debugger* dbg, uint16_t addr, uint16_t len, int mode, int enable);
+int chip8_debug_add_condition(Chip8Debugger* dbg, uint8_t reg, DebugOp op, uint16_t value);
+
+// 带检查地执行一条指令，中断时返回0 (指令未执行)
+int chip8_debug_cycle(Chip8Debugger* dbg, Chip8* chip8);
+
+void chip8_debug_pause(Chip8Debugger* dbg, const Chip8* chip8, const char* reason);
+void chip8_debug_continue(Chip8Debugger* dbg);
+void chip8_debug_step(Chip8Debugger* dbg, Chip8* chip8, int count);
+void chip8_debug_step_over(Chip8Debugger* dbg, Chip8* chip8);
+
+// 每个60Hz帧调用：自动拍内存快照
+void chip8_debug_frame(Chip8Debugger* dbg, const Chip8* chip8);
+
+// 每批指令之前调用：写回冻结的内存
+void chip8_debug_apply_freezes(Chip8Debugger* dbg, Chip8* chip8);
+
+void chip8_debug_print_registers(const Chip8* chip8);
+void chip8_debug_print_disassembly(const Chip8* chip8, uint16_t addr, int count);
+
+// 执行一条控制台命令
+void chip8_debug_command(Chip8Debugger* dbg, Chip8* chip8, const char* line);
+
+// 启动stdin控制台线程，主循环中调用 chip8_debug_poll 处理收到的命令
+int chip8_debug_console_start(Chip8Debugger* dbg);
+void chip8_debug_poll(Chip8Debugger* dbg, Chip8* chip8);
+
+#endif // CHIP8_DEBUG_H
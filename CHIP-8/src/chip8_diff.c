@@ -0,0 +1,300 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "chip8_diff.h"
+#include "chip8_disasm.h"
+
+// ---------------------------------------------------------------
+// 执行引擎
+// ---------------------------------------------------------------
+
+// 参考引擎：逐条调用 chip8_cycle
+static int engine_ref_step(Chip8* chip8, int limit) {
+    (void)limit;
+    chip8_cycle(chip8);
+    return 1;
+}
+
+// 是否为结束基本块的指令 (跳转、调用、返回、条件跳过、等待按键)
+static int ends_block(uint16_t opcode) {
+    switch (opcode & 0xF000) {
+        case 0x0000: return opcode == 0x00EE;
+        case 0x1000:
+        case 0x2000:
+        case 0x3000:
+        case 0x4000:
+        case 0x5000:
+        case 0x9000:
+        case 0xB000:
+        case 0xE000: return 1;
+        case 0xF000: return (opcode & 0xFF) == 0x0A;
+        default: return 0;
+    }
+}
+
+// 基本块引擎：执行到控制流指令为止 (用于验证按块比较的路径，
+// 之后的块编译/缓存引擎以同样的粒度接入)
+static int engine_block_step(Chip8* chip8, int limit) {
+    int count = 0;
+    while (count < limit) {
+        uint16_t opcode = chip8_read_opcode(chip8, chip8->pc);
+        chip8_cycle(chip8);
+        count++;
+        if (ends_block(opcode)) break;
+    }
+    return count;
+}
+
+static const Chip8Engine ENGINES[] = {
+    { "ref",   "参考解释器 (chip8_cycle)",     engine_ref_step },
+    { "block", "按基本块执行的解释器",         engine_block_step },
+};
+
+#define ENGINE_COUNT ((int)(sizeof(ENGINES) / sizeof(ENGINES[0])))
+
+const Chip8Engine* chip8_engine_find(const char* name) {
+    for (int i = 0; i < ENGINE_COUNT; i++) {
+        if (strcmp(ENGINES[i].name, name) == 0) return &ENGINES[i];
+    }
+    return NULL;
+}
+
+void chip8_engine_list(FILE* out) {
+    for (int i = 0; i < ENGINE_COUNT; i++) {
+        fprintf(out, "  %-8s %s\n", ENGINES[i].name, ENGINES[i].description);
+    }
+}
+
+// ---------------------------------------------------------------
+// 状态比较
+// ---------------------------------------------------------------
+
+int chip8_diff_state(const Chip8* expected, const Chip8* actual, char* field, size_t size) {
+    if (expected->pc != actual->pc) { snprintf(field, size, "PC"); return 0; }
+    if (expected->I != actual->I) { snprintf(field, size, "I"); return 0; }
+    if (expected->sp != actual->sp) { snprintf(field, size, "SP"); return 0; }
+    for (int i = 0; i < 16; i++) {
+        if (expected->V[i] != actual->V[i]) { snprintf(field, size, "V%X", i); return 0; }
+    }
+    for (int i = 0; i < 16; i++) {
+        if (expected->stack[i] != actual->stack[i]) { snprintf(field, size, "stack[%d]", i); return 0; }
+    }
+    if (expected->delay_timer != actual->delay_timer) { snprintf(field, size, "DT"); return 0; }
+    if (expected->sound_timer != actual->sound_timer) { snprintf(field, size, "ST"); return 0; }
+    if (expected->key_wait != actual->key_wait || expected->wait_key != actual->wait_key) {
+        snprintf(field, size, "FX0A等待状态");
+        return 0;
+    }
+    if (expected->rng.counter != actual->rng.counter || expected->rng.lcg != actual->rng.lcg) {
+        snprintf(field, size, "随机数状态");
+        return 0;
+    }
+    
+    if (memcmp(expected->memory, actual->memory, MEMORY_SIZE) != 0) {
+        int addr = 0;
+        while (expected->memory[addr] == actual->memory[addr]) addr++;
+        snprintf(field, size, "memory[0x%03X]", addr);
+        return 0;
+    }
+    if (memcmp(expected->display, actual->display, sizeof(expected->display)) != 0) {
+        int pixel = 0;
+        while (expected->display[pixel] == actual->display[pixel]) pixel++;
+        snprintf(field, size, "display(%d,%d)", pixel % DISPLAY_WIDTH, pixel / DISPLAY_WIDTH);
+        return 0;
+    }
+    return 1;
+}
+
+// ---------------------------------------------------------------
+// 同步运行
+// ---------------------------------------------------------------
+
+static Chip8* clone_state(const Chip8* chip8) {
+    Chip8* copy = (Chip8*)malloc(sizeof(Chip8));
+    if (copy) {
+        memcpy(copy, chip8, sizeof(Chip8));
+        copy->trace = NULL;
+    }
+    return copy;
+}
+
+int chip8_diff_run(const uint8_t* rom, size_t size, const Chip8RunConfig* config,
+                   const Chip8Engine* reference, const Chip8Engine* engine, Chip8DiffResult* result) {
+    memset(result, 0, sizeof(*result));
+    
+    Chip8* a = (Chip8*)calloc(1, sizeof(Chip8));
+    Chip8* b = (Chip8*)calloc(1, sizeof(Chip8));
+    if (!a || !b) {
+        free(a);
+        free(b);
+        return 0;
+    }
+    
+    a->quiet = 1;
+    b->quiet = 1;
+    chip8_reset(a, config->seed);
+    chip8_reset(b, config->seed);
+    chip8_rng_init(&a->rng, (Chip8RngKind)config->rng, config->seed, 0);  // 与基准运行相同的随机数生成器
+    chip8_rng_init(&b->rng, (Chip8RngKind)config->rng, config->seed, 0);
+    if (!chip8_load_rom_data(a, rom, size) || !chip8_load_rom_data(b, rom, size)) {
+        free(a);
+        free(b);
+        return 0;
+    }
+    
+    // 参考引擎挂一个小的执行跟踪缓冲区作为分歧前的指令窗口 (标记所有故障已转储，不写文件)
+    Chip8TraceEntry entries[DIFF_TRACE_WINDOW];
+    Chip8Trace trace;
+    memset(&trace, 0, sizeof(trace));
+    memset(entries, 0, sizeof(entries));
+    trace.entries = entries;
+    trace.mask = DIFF_TRACE_WINDOW - 1;
+    trace.dumped_faults = ~0u;
+    a->trace = &trace;
+    
+    const Chip8InputScript* script = config->script;
+    int next_event = 0;
+    int per_frame = config->cycles_per_frame > 0 ? config->cycles_per_frame : 1;
+    
+    for (int frame = 0; frame < config->frames && !result->diverged; frame++) {
+        while (script && next_event < script->count && script->events[next_event].frame <= (uint32_t)frame) {
+            const RunnerInputEvent* ev = &script->events[next_event++];
+            a->key[ev->key] = ev->pressed;
+            b->key[ev->key] = ev->pressed;
+        }
+        
+        int remaining = per_frame;
+        while (remaining > 0) {
+            int count = engine->step(b, remaining);
+            if (count <= 0 || count > remaining) {
+                snprintf(result->field, sizeof(result->field), "引擎返回了无效的指令数 %d", count);
+                result->diverged = 1;
+                break;
+            }
+            for (int i = 0; i < count; i++) {
+                reference->step(a, 1);
+            }
+            remaining -= count;
+            
+            if (!chip8_diff_state(a, b, result->field, sizeof(result->field))) {
+                result->diverged = 1;
+                break;
+            }
+            result->instructions += (uint64_t)count;
+        }
+        
+        if (result->diverged) {
+            result->frame = frame;
+            break;
+        }
+        
+        chip8_update_timers(a);
+        chip8_update_timers(b);
+    }
+    
+    if (result->diverged) {
+        uint64_t total = trace.count;
+        int count = total < DIFF_TRACE_WINDOW ? (int)total : DIFF_TRACE_WINDOW;
+        for (int i = 0; i < count; i++) {
+            result->window[i] = entries[(total - count + i) & trace.mask];
+        }
+        result->window_count = count;
+        result->expected = clone_state(a);
+        result->actual = clone_state(b);
+    }
+    
+    a->trace = NULL;
+    free(a);
+    free(b);
+    result->ok = 1;
+    return 1;
+}
+
+void chip8_diff_free(Chip8DiffResult* result) {
+    free(result->expected);
+    free(result->actual);
+    result->expected = NULL;
+    result->actual = NULL;
+}
+
+// ---------------------------------------------------------------
+// 报告
+// ---------------------------------------------------------------
+
+static void report_registers(FILE* out, const Chip8* e, const Chip8* a) {
+    fprintf(out, "  寄存器      参考    被测\n");
+    for (int i = 0; i < 16; i++) {
+        fprintf(out, "  %c V%X       %02X      %02X\n", e->V[i] != a->V[i] ? '*' : ' ', i, e->V[i], a->V[i]);
+    }
+    fprintf(out, "  %c I        %03X     %03X\n", e->I != a->I ? '*' : ' ', e->I, a->I);
+    fprintf(out, "  %c PC       %03X     %03X\n", e->pc != a->pc ? '*' : ' ', e->pc, a->pc);
+    fprintf(out, "  %c SP       %02X      %02X\n", e->sp != a->sp ? '*' : ' ', e->sp, a->sp);
+    fprintf(out, "  %c DT       %02X      %02X\n", e->delay_timer != a->delay_timer ? '*' : ' ', e->delay_timer, a->delay_timer);
+    fprintf(out, "  %c ST       %02X      %02X\n", e->sound_timer != a->sound_timer ? '*' : ' ', e->sound_timer, a->sound_timer);
+    
+    for (int i = 0; i < 16; i++) {
+        if (e->stack[i] != a->stack[i]) {
+            fprintf(out, "  * stack[%d] %03X     %03X\n", i, e->stack[i], a->stack[i]);
+        }
+    }
+}
+
+static void report_memory(FILE* out, const Chip8* e, const Chip8* a) {
+    int shown = 0, total = 0;
+    for (int addr = 0; addr < MEMORY_SIZE; addr++) {
+        if (e->memory[addr] == a->memory[addr]) continue;
+        if (shown < 8) {
+            fprintf(out, "  * memory[0x%03X] %02X      %02X\n", addr, e->memory[addr], a->memory[addr]);
+            shown++;
+        }
+        total++;
+    }
+    if (total > shown) fprintf(out, "    ... 共 %d 字节不一致\n", total);
+    
+    int pixels = 0;
+    for (int i = 0; i < DISPLAY_WIDTH * DISPLAY_HEIGHT; i++) {
+        if (e->display[i] != a->display[i]) pixels++;
+    }
+    if (pixels) fprintf(out, "  * 显示: %d 个像素不一致\n", pixels);
+}
+
+void chip8_diff_report(FILE* out, const char* rom_path, const Chip8RunConfig* config,
+                       const Chip8Engine* reference, const Chip8Engine* engine, const Chip8DiffResult* result) {
+    if (!result->diverged) return;
+    
+    fprintf(out, "分歧: %s\n", rom_path);
+    fprintf(out, "  %s 与 %s 在一致执行 %llu 条指令后 (第%d帧) 出现分歧: %s\n",
+            reference->name, engine->name, (unsigned long long)result->instructions, result->frame, result->field);
+    
+    if (result->expected && result->actual) {
+        report_registers(out, result->expected, result->actual);
+        report_memory(out, result->expected, result->actual);
+    }
+    
+    // 最后一行是出现分歧的这一步中参考引擎执行的最后一条指令
+    if (result->window_count > 0) {
+        fprintf(out, "  最近执行的指令 (参考引擎):\n");
+        for (int i = 0; i < result->window_count; i++) {
+            const Chip8TraceEntry* entry = &result->window[i];
+            char text[32];
+            chip8_disassemble(entry->opcode, text, sizeof(text));
+            fprintf(out, "    0x%03X: %04X  %-18s I=%03X", entry->pc, entry->opcode, text, entry->I);
+            if (entry->reg != TRACE_NO_REG) fprintf(out, "  V%X=%02X", entry->reg, entry->value);
+            fprintf(out, "\n");
+        }
+    }
+    
+    // 最小复现：运行到分歧所在帧为止，以及到该帧为止的输入
+    fprintf(out, "  复现: rom_test \"%s\" --diff %s,%s --frames %d --seed %u --rng %s --speed %d\n",
+            rom_path, reference->name, engine->name, result->frame + 1, config->seed,
+            chip8_rng_name((Chip8RngKind)config->rng), config->cycles_per_frame * 60);
+    const Chip8InputScript* script = config->script;
+    int printed = 0;
+    for (int i = 0; script && i < script->count; i++) {
+        const RunnerInputEvent* ev = &script->events[i];
+        if (ev->frame > (uint32_t)result->frame) break;
+        if (!printed) fprintf(out, "  输入脚本 (--script):\n");
+        fprintf(out, "    %u %X %s\n", ev->frame, ev->key, ev->pressed ? "down" : "up");
+        printed = 1;
+    }
+}
@@ -0,0 +1,51 @@
+#ifndef CHIP8_DIFF_H
+#define CHIP8_DIFF_H
+
+#include <stdio.h>
+#include "chip8.h"
+#include "chip8_trace.h"
+#include "chip8_runner.h"
+
+// 差分执行检查：两个执行引擎以相同的ROM、种子和输入脚本同步运行，
+// 每一步之后比较完整的体系结构状态 (V/I/PC/SP/堆栈/定时器/内存/显示)，
+// 第一次出现分歧时停止，保留两边的状态和参考引擎最近的执行跟踪
+
+#define DIFF_TRACE_WINDOW 32       // 保留的最近指令数 (2的幂)
+
+// 执行引擎：step 执行一个单位 (一条指令或一个基本块)，返回执行的指令数 (<=limit)。
+// 参考引擎之外的新引擎在 chip8_diff.c 的引擎表中注册
+typedef struct {
+    const char* name;
+    const char* description;
+    int (*step)(Chip8* chip8, int limit);
+} Chip8Engine;
+
+// 差分结果
+typedef struct {
+    int diverged;              // 1=发现分歧
+    int frame;                 // 分歧所在帧
+    char field[64];            // 第一个不一致的状态 (如 "V3", "memory[0x2A0]")
+    Chip8* expected;           // 分歧时参考引擎的状态 (堆上分配)
+    Chip8* actual;             // 分歧时被测引擎的状态
+    Chip8TraceEntry window[DIFF_TRACE_WINDOW];  // 参考引擎最近执行的指令 (从旧到新)
+    int window_count;
+    uint64_t instructions;     // 已比较且一致的指令数
+    int ok;                    // 0=ROM无法加载
+} Chip8DiffResult;
+
+const Chip8Engine* chip8_engine_find(const char* name);
+void chip8_engine_list(FILE* out);
+
+// 比较两个状态，一致返回1，否则把第一个不一致的字段名写入 field
+int chip8_diff_state(const Chip8* expected, const Chip8* actual, char* field, size_t size);
+
+// 以 reference 为基准同步运行 engine (按 TIMING_MODEL_SPEED，每帧 config->cycles_per_frame 条指令)
+int chip8_diff_run(const uint8_t* rom, size_t size, const Chip8RunConfig* config,
+                   const Chip8Engine* reference, const Chip8Engine* engine, Chip8DiffResult* result);
+void chip8_diff_free(Chip8DiffResult* result);
+
+// 打印分歧报告：不一致的状态、执行跟踪和最小复现条件
+void chip8_diff_report(FILE* out, const char* rom_path, const Chip8RunConfig* config,
+                       const Chip8Engine* reference, const Chip8Engine* engine, const Chip8DiffResult* result);
+
+#endif // CHIP8_DIFF_H
@@ -0,0 +1,71 @@
+#include <stdio.h>
+#include "chip8_disasm.h"
+
+// 反汇编一条指令
+void chip8_disassemble(uint16_t opcode, char* buf, size_t size) {
+    unsigned x = (opcode & 0x0F00) >> 8;
+    unsigned y = (opcode & 0x00F0) >> 4;
+    unsigned n = opcode & 0x000F;
+    unsigned nn = opcode & 0x00FF;
+    unsigned nnn = opcode & 0x0FFF;
+    
+    switch (opcode & 0xF000) {
+        case 0x0000:
+            if (opcode == 0x00E0) snprintf(buf, size, "CLS");
+            else if (opcode == 0x00EE) snprintf(buf, size, "RET");
+            else snprintf(buf, size, "SYS 0x%03X", nnn);
+            return;
+        case 0x1000: snprintf(buf, size, "JP 0x%03X", nnn); return;
+        case 0x2000: snprintf(buf, size, "CALL 0x%03X", nnn); return;
+        case 0x3000: snprintf(buf, size, "SE V%X, 0x%02X", x, nn); return;
+        case 0x4000: snprintf(buf, size, "SNE V%X, 0x%02X", x, nn); return;
+        case 0x5000:
+            if (n == 0) { snprintf(buf, size, "SE V%X, V%X", x, y); return; }
+            break;
+        case 0x6000: snprintf(buf, size, "LD V%X, 0x%02X", x, nn); return;
+        case 0x7000: snprintf(buf, size, "ADD V%X, 0x%02X", x, nn); return;
+        case 0x8000:
+            switch (n) {
+                case 0x0: snprintf(buf, size, "LD V%X, V%X", x, y); return;
+                case 0x1: snprintf(buf, size, "OR V%X, V%X", x, y); return;
+                case 0x2: snprintf(buf, size, "AND V%X, V%X", x, y); return;
+                case 0x3: snprintf(buf, size, "XOR V%X, V%X", x, y); return;
+                case 0x4: snprintf(buf, size, "ADD V%X, V%X", x, y); return;
+                case 0x5: snprintf(buf, size, "SUB V%X, V%X", x, y); return;
+                case 0x6: snprintf(buf, size, "SHR V%X", x); return;
+                case 0x7: snprintf(buf, size, "SUBN V%X, V%X", x, y); return;
+                case 0xE: snprintf(buf, size, "SHL V%X", x); return;
+                default: break;
+            }
+            break;
+        case 0x9000:
+            if (n == 0) { snprintf(buf, size, "SNE V%X, V%X", x, y); return; }
+            break;
+        case 0xA000: snprintf(buf, size, "LD I, 0x%03X", nnn); return;
+        case 0xB000: snprintf(buf, size, "JP V0, 0x%03X", nnn); return;
+        case 0xC000: snprintf(buf, size, "RND V%X, 0x%02X", x, nn); return;
+        case 0xD000: snprintf(buf, size, "DRW V%X, V%X, %u", x, y, n); return;
+        case 0xE000:
+            if (nn == 0x9E) { snprintf(buf, size, "SKP V%X", x); return; }
+            if (nn == 0xA1) { snprintf(buf, size, "SKNP V%X", x); return; }
+            break;
+        case 0xF000:
+            switch (nn) {
+                case 0x02: if (x == 0) { snprintf(buf, size, "AUDIO"); return; } break;
+                case 0x07: snprintf(buf, size, "LD V%X, DT", x); return;
+                case 0x0A: snprintf(buf, size, "LD V%X, K", x); return;
+                case 0x15: snprintf(buf, size, "LD DT, V%X", x); return;
+                case 0x18: snprintf(buf, size, "LD ST, V%X", x); return;
+                case 0x1E: snprintf(buf, size, "ADD I, V%X", x); return;
+                case 0x29: snprintf(buf, size, "LD F, V%X", x); return;
+                case 0x33: snprintf(buf, size, "LD B, V%X", x); return;
+                case 0x55: snprintf(buf, size, "LD [I], V%X", x); return;
+                case 0x65: snprintf(buf, size, "LD V%X, [I]", x); return;
+                case 0x3A: snprintf(buf, size, "PITCH V%X", x); return;
+                default: break;
+            }
+            break;
+    }
+    
+    snprintf(buf, size, "DW 0x%04X", opcode);
+}
@@ -0,0 +1,11 @@
+#ifndef CHIP8_DISASM_H
+#define CHIP8_DISASM_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+// CHIP-8反汇编 (不依赖SDL，供离线工具和调试器使用)
+// 输出形如 "LD V3, 0x1F"，未知操作码输出 "DW 0xXXXX"
+void chip8_disassemble(uint16_t opcode, char* buf, size_t size);
+
+#endif // CHIP8_DISASM_H
@@ -0,0 +1,215 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "chip8_env.h"
+
+// 设置默认配置
+void chip8_env_default_config(Chip8EnvConfig* config, int num_envs) {
+    if (!config) return;
+    
+    config->num_envs = num_envs;
+    config->frame_skip = 4;
+    config->cycles_per_frame = CPU_DEFAULT_SPEED / 60;  // 与默认速度一致
+    config->timing_model = TIMING_MODEL_SPEED;
+    config->max_frames = 0;
+    config->reward_addr = -1;
+    config->done_addr = -1;
+    config->obs_format = CHIP8_OBS_PACKED;
+    config->rng = CHIP8_RNG_PHILOX;
+    config->seed = 1;
+}
+
+// 读取整个ROM文件
+static uint8_t* read_rom_file(const char* path, size_t* size) {
+    FILE* file = fopen(path, "rb");
+    if (!file) {
+        fprintf(stderr, "错误: 无法打开ROM文件: %s\n", path);
+        return NULL;
+    }
+    
+    fseek(file, 0, SEEK_END);
+    long file_size = ftell(file);
+    rewind(file);
+    
+    if (file_size <= 0 || file_size > MEMORY_SIZE - PROGRAM_START) {
+        fprintf(stderr, "错误: ROM文件大小无效 (%ld字节)\n", file_size);
+        fclose(file);
+        return NULL;
+    }
+    
+    uint8_t* data = (uint8_t*)malloc((size_t)file_size);
+    if (data && fread(data, 1, (size_t)file_size, file) != (size_t)file_size) {
+        free(data);
+        data = NULL;
+    }
+    fclose(file);
+    
+    *size = (size_t)file_size;
+    return data;
+}
+
+// 创建环境
+int chip8_env_create(Chip8Env* env, const Chip8EnvConfig* config, const char* rom_path) {
+    if (!env || !config || !rom_path || config->num_envs <= 0) {
+        fprintf(stderr, "错误: chip8_env_create 参数无效\n");
+        return 0;
+    }
+    
+    memset(env, 0, sizeof(*env));
+    env->config = *config;
+    if (env->config.frame_skip < 1) env->config.frame_skip = 1;
+    if (env->config.cycles_per_frame < 1) env->config.cycles_per_frame = 1;
+    
+    env->rom = read_rom_file(rom_path, &env->rom_size);
+    if (!env->rom) {
+        return 0;
+    }
+    
+    int n = env->config.num_envs;
+    env->cores = (Chip8*)calloc((size_t)n, sizeof(Chip8));
+    env->reward_value = (uint8_t*)calloc((size_t)n, 1);
+    env->done = (uint8_t*)calloc((size_t)n, 1);
+    env->episode_frames = (int*)calloc((size_t)n, sizeof(int));
+    if (!env->cores || !env->reward_value || !env->done || !env->episode_frames) {
+        fprintf(stderr, "错误: 环境内存分配失败 (%d个实例)\n", n);
+        chip8_env_destroy(env);
+        return 0;
+    }
+    
+    // 大量并行实例的运行时故障只计数，不逐条输出
+    for (int i = 0; i < n; i++) {
+        env->cores[i].quiet = 1;
+    }
+    
+    chip8_env_reset(env, NULL, NULL);
+    return 1;
+}
+
+// 销毁环境
+void chip8_env_destroy(Chip8Env* env) {
+    if (!env) return;
+    
+    free(env->cores);
+    free(env->rom);
+    free(env->reward_value);
+    free(env->done);
+    free(env->episode_frames);
+    memset(env, 0, sizeof(*env));
+}
+
+// 单个实例的观测字节数
+size_t chip8_env_obs_size(const Chip8Env* env) {
+    if (env->config.obs_format == CHIP8_OBS_U8) {
+        return DISPLAY_WIDTH * DISPLAY_HEIGHT;
+    }
+    return DISPLAY_PACKED_SIZE;
+}
+
+// 将实例的显示写入观测缓冲区
+static void write_observation(const Chip8Env* env, int index, uint8_t* obs) {
+    uint8_t* dst = obs + (size_t)index * chip8_env_obs_size(env);
+    const Chip8* core = &env->cores[index];
+    
+    if (env->config.obs_format == CHIP8_OBS_U8) {
+        memcpy(dst, core->display, DISPLAY_WIDTH * DISPLAY_HEIGHT);
+    } else {
+        chip8_pack_display(core, dst);
+    }
+}
+
+// 读取奖励地址当前的值
+static uint8_t read_reward_byte(const Chip8Env* env, const Chip8* core) {
+    if (env->config.reward_addr < 0) return 0;
+    return core->memory[env->config.reward_addr & (MEMORY_SIZE - 1)];
+}
+
+// 判断实例是否结束：结束标志、停机 (跳转到自身) 或达到最大帧数
+static int is_episode_done(const Chip8Env* env, const Chip8* core, int frames) {
+    if (env->config.done_addr >= 0 && core->memory[env->config.done_addr & (MEMORY_SIZE - 1)]) {
+        return 1;
+    }
+    
+    uint16_t opcode = chip8_read_opcode(core, core->pc);
+    if ((opcode & 0xF000) == 0x1000 && (opcode & 0x0FFF) == core->pc) {
+        return 1;
+    }
+    
+    return env->config.max_frames > 0 && frames >= env->config.max_frames;
+}
+
+// 重置单个实例
+void chip8_env_reset_one(Chip8Env* env, int index, unsigned int seed, uint8_t* obs) {
+    if (!env || index < 0 || index >= env->config.num_envs) return;
+    
+    Chip8* core = &env->cores[index];
+    chip8_reset(core, seed);
+    chip8_rng_init(&core->rng, env->config.rng, seed, (uint32_t)index);
+    chip8_load_rom_data(core, env->rom, env->rom_size);
+    
+    env->reward_value[index] = read_reward_byte(env, core);
+    env->done[index] = 0;
+    env->episode_frames[index] = 0;
+    
+    if (obs) {
+        write_observation(env, index, obs);
+    }
+}
+
+// 重置全部实例
+void chip8_env_reset(Chip8Env* env, const unsigned int* seeds, uint8_t* obs) {
+    if (!env) return;
+    
+    for (int i = 0; i < env->config.num_envs; i++) {
+        chip8_env_reset_one(env, i, seeds ? seeds[i] : env->config.seed, obs);
+    }
+}
+
+// 所有实例执行一步：每个动作重复K帧，每帧执行固定指令数 (或VIP周期预算) 后更新一次定时器
+void chip8_env_step(Chip8Env* env, const int* actions, uint8_t* obs, float* rewards, uint8_t* dones) {
+    if (!env) return;
+    
+    const int frame_skip = env->config.frame_skip;
+    const int cycles_per_frame = env->config.cycles_per_frame;
+    
+    // 所有实例的下一组随机数按SIMD通道一起算好，CXNN直接取缓存
+    chip8_rng_prefetch(&env->cores[0].rng, sizeof(Chip8), env->config.num_envs);
+    
+    for (int i = 0; i < env->config.num_envs; i++) {
+        Chip8* core = &env->cores[i];
+        
+        if (!env->done[i]) {
+            // 设置按键状态
+            int action = actions ? actions[i] : -1;
+            memset(core->key, 0, sizeof(core->key));
+            if (action >= 0 && action < 16) {
+                core->key[action] = 1;
+            }
+            
+            for (int frame = 0; frame < frame_skip; frame++) {
+                if (env->config.timing_model == TIMING_MODEL_VIP) {
+                    chip8_run_frame(core, (core->quirks & QUIRK_DISPLAY_WAIT) != 0);
+                } else {
+                    for (int c = 0; c < cycles_per_frame; c++) {
+                        chip8_cycle(core);
+                    }
+                }
+                chip8_update_timers(core);
+                env->episode_frames[i]++;
+                
+                if (is_episode_done(env, core, env->episode_frames[i])) {
+                    env->done[i] = 1;
+                    break;
+                }
+            }
+            
+            uint8_t value = read_reward_byte(env, core);
+            if (rewards) rewards[i] = (float)(int8_t)(value - env->reward_value[i]);
+            env->reward_value[i] = value;
+        } else if (rewards) {
+            rewards[i] = 0.0f;
+        }
+        
+        if (dones) dones[i] = env->done[i];
+        if (obs) write_observation(env, i, obs);
+    }
+}
@@ -0,0 +1,55 @@
+#ifndef CHIP8_ENV_H
+#define CHIP8_ENV_H
+
+#include "chip8.h"
+#include "chip8_timing.h"
+
+// 批量强化学习环境：N个CHIP-8实例同步 reset/step，
+// 观测直接写入调用者提供的连续缓冲区，step过程中不分配内存
+
+// 观测格式
+typedef enum {
+    CHIP8_OBS_PACKED = 0,  // 1位/像素，每实例 DISPLAY_PACKED_SIZE 字节
+    CHIP8_OBS_U8 = 1       // 1字节/像素 (0/1)，每实例 DISPLAY_WIDTH*DISPLAY_HEIGHT 字节
+} Chip8ObsFormat;
+
+// 环境配置
+typedef struct {
+    int num_envs;              // 实例数量 N
+    int frame_skip;            // 每个动作重复的帧数 K
+    int cycles_per_frame;      // 每帧执行的指令数 (TIMING_MODEL_SPEED)
+    Chip8TimingModel timing_model;  // TIMING_MODEL_VIP 时按VIP周期预算执行每帧
+    int max_frames;            // 每回合最大帧数 (0=不限)
+    int reward_addr;           // 奖励所在RAM地址，奖励=该字节的变化量 (-1=不使用)
+    int done_addr;             // 结束标志RAM地址，非0即结束 (-1=不使用)
+    Chip8ObsFormat obs_format; // 观测格式
+    Chip8RngKind rng;          // 随机数生成器
+    unsigned int seed;         // 运行种子 (reset 未指定种子时使用)
+} Chip8EnvConfig;
+
+// 环境状态
+typedef struct {
+    Chip8EnvConfig config;
+    Chip8* cores;              // N个实例 (连续存放)
+    uint8_t* rom;              // ROM数据 (只读取一次)
+    size_t rom_size;
+    uint8_t* reward_value;     // 上一步奖励地址的值
+    uint8_t* done;             // 每个实例是否已结束
+    int* episode_frames;       // 每个实例本回合已运行帧数
+} Chip8Env;
+
+void chip8_env_default_config(Chip8EnvConfig* config, int num_envs);
+int chip8_env_create(Chip8Env* env, const Chip8EnvConfig* config, const char* rom_path);
+void chip8_env_destroy(Chip8Env* env);
+size_t chip8_env_obs_size(const Chip8Env* env);  // 单个实例的观测字节数
+
+// 实例 i 的随机数按 (种子, i) 生成，同一种子下各实例的序列相互独立。
+// seeds 可为NULL (所有实例使用 config.seed)，obs 可为NULL (不输出观测)
+void chip8_env_reset(Chip8Env* env, const unsigned int* seeds, uint8_t* obs);
+void chip8_env_reset_one(Chip8Env* env, int index, unsigned int seed, uint8_t* obs);
+
+// actions[i]: 0-15=按住的按键，-1=无按键
+// obs: N*obs_size 字节，rewards: N个，dones: N个 (已结束的实例不再运行，需要reset)
+void chip8_env_step(Chip8Env* env, const int* actions, uint8_t* obs, float* rewards, uint8_t* dones);
+
+#endif // CHIP8_ENV_H
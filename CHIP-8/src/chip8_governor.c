@@ -0,0 +1,136 @@
+#include <string.h>
+#include "chip8_governor.h"
+
+#define GOVERNOR_EMA_WEIGHT 0.125      // 移动平均中新样本的权重
+
+int chip8_governor_profile_ipf(const RomEntry* entry) {
+    if (!entry) return GOVERNOR_IPF_CHIP8;
+    switch (entry->platform) {
+        case ROM_PLATFORM_SCHIP:  return GOVERNOR_IPF_SCHIP;
+        case ROM_PLATFORM_XOCHIP: return GOVERNOR_IPF_XOCHIP;
+        default:                  return GOVERNOR_IPF_CHIP8;
+    }
+}
+
+void chip8_governor_init(Chip8Governor* gov, int ipf, double cpu_share) {
+    memset(gov, 0, sizeof(*gov));
+    gov->ipf = ipf > 0 ? ipf : GOVERNOR_IPF_CHIP8;
+    gov->effective_ipf = gov->ipf;
+    gov->cpu_share = (cpu_share > 0.0 && cpu_share < 1.0) ? cpu_share : 1.0;
+}
+
+void chip8_governor_add_busy(Chip8Governor* gov, double us) {
+    gov->busy_us += us;
+}
+
+static double ema(double avg, double sample, uint64_t samples) {
+    return samples == 0 ? sample : avg + (sample - avg) * GOVERNOR_EMA_WEIGHT;
+}
+
+int chip8_governor_begin(Chip8Governor* gov) {
+    // 未初始化 (漏调 chip8_governor_init) 时按默认配置运行，而不是每帧0条指令
+    if (gov->ipf <= 0) chip8_governor_init(gov, GOVERNOR_IPF_CHIP8, 1.0);
+    
+    gov->busy_avg = ema(gov->busy_avg, gov->busy_us, gov->frames);
+    gov->busy_us = 0.0;
+    gov->loop_valid = 0;
+    
+    if (gov->cpu_share >= 1.0 || gov->instr_avg <= 0.0) {
+        gov->effective_ipf = gov->ipf;
+        return gov->effective_ipf;
+    }
+    
+    // 忙碌时间中与指令数无关的部分 (事件处理、渲染等) 保持不变，
+    // 剩余的预算按每条指令的平均耗时换算成指令数
+    double allowed = gov->cpu_share * GOVERNOR_FRAME_US;
+    double overhead = gov->busy_avg - gov->emu_avg;
+    if (overhead < 0.0) overhead = 0.0;
+    double limit = (allowed - overhead) / gov->instr_avg;
+    
+    if (limit >= gov->ipf) {
+        gov->effective_ipf = gov->ipf;
+    } else {
+        gov->effective_ipf = limit > GOVERNOR_MIN_IPF ? (int)limit : GOVERNOR_MIN_IPF;
+    }
+    return gov->effective_ipf;
+}
+
+// 循环体 [start, end] 中是否只有不写内存、堆栈、定时器和显示的指令
+static int loop_is_pure(const Chip8* chip8, uint16_t start, uint16_t end) {
+    for (uint16_t addr = start; addr <= end; addr += 2) {
+        uint16_t op = chip8_read_opcode(chip8, addr);
+        switch (op & 0xF000) {
+            case 0x0000:               // 00E0/00EE/0NNN
+            case 0x2000:               // 调用
+            case 0xB000:               // 间接跳转
+            case 0xC000:               // 随机数
+            case 0xD000:               // 绘图
+                return 0;
+            case 0xF000:
+                switch (op & 0x00FF) {
+                    case 0x0A: case 0x15: case 0x18: case 0x33: case 0x55:
+                        return 0;
+                }
+                break;
+        }
+    }
+    return 1;
+}
+
+int chip8_governor_spinning(Chip8Governor* gov, const Chip8* chip8, uint16_t pc, uint16_t opcode) {
+    gov->steps++;
+    
+    // FX0A：第二次执行时按键状态没有变化，在新的按键事件之前不会前进
+    if ((opcode & 0xF0FF) == 0xF00A && chip8->key_wait) {
+        if (gov->loop_valid && gov->loop_pc == pc && memcmp(gov->loop_keys, chip8->key, 16) == 0) {
+            gov->loop_length = (int)(gov->steps - gov->loop_steps);
+            return 1;
+        }
+        gov->loop_pc = pc;
+        memcpy(gov->loop_keys, chip8->key, 16);
+        gov->loop_steps = gov->steps;
+        gov->loop_valid = 1;
+        return 0;
+    }
+    
+    // 短的向后跳转：两次经过时寄存器、随机数状态和按键完全相同，
+    // 且循环体不写内存，则在定时器或按键变化之前会一直重复
+    if ((opcode & 0xF000) != 0x1000) return 0;
+    uint16_t target = opcode & 0x0FFF;
+    if (target > pc || pc - target > GOVERNOR_MAX_LOOP_BYTES) return 0;
+    
+    if (gov->loop_valid && gov->loop_pc == pc &&
+        gov->loop_I == chip8->I && gov->loop_sp == chip8->sp && gov->loop_random == chip8->rng.counter &&
+        memcmp(gov->loop_V, chip8->V, 16) == 0 && memcmp(gov->loop_keys, chip8->key, 16) == 0) {
+        gov->loop_length = (int)(gov->steps - gov->loop_steps);
+        return loop_is_pure(chip8, target, pc);
+    }
+    
+    gov->loop_pc = pc;
+    gov->loop_I = chip8->I;
+    gov->loop_sp = chip8->sp;
+    gov->loop_random = chip8->rng.counter;
+    memcpy(gov->loop_V, chip8->V, 16);
+    memcpy(gov->loop_keys, chip8->key, 16);
+    gov->loop_steps = gov->steps;
+    gov->loop_valid = 1;
+    return 0;
+}
+
+void chip8_governor_end(Chip8Governor* gov, int executed, double emu_us, int idle) {
+    gov->emu_avg = ema(gov->emu_avg, emu_us, gov->frames);
+    
+    // 只用完整执行的帧估计每条指令耗时 (空转帧指令太少，计时误差大)
+    if (!idle && executed > 0) {
+        double per_instr = emu_us / executed;
+        if (gov->instr_avg > 0.0) {
+            gov->instr_avg += (per_instr - gov->instr_avg) * GOVERNOR_EMA_WEIGHT;
+        } else {
+            gov->instr_avg = per_instr;
+        }
+    }
+    
+    gov->frames++;
+    if (idle) gov->idle_frames++;
+    if (gov->effective_ipf < gov->ipf) gov->throttled_frames++;
+}
@@ -0,0 +1,67 @@
+#ifndef CHIP8_GOVERNOR_H
+#define CHIP8_GOVERNOR_H
+
+#include "chip8.h"
+#include "chip8_romlib.h"
+
+// 速度调节器：每个60Hz帧执行按ROM平台选定的指令数，
+// 测量每帧实际消耗的主机时间，超出配置的CPU份额时降低每帧指令数；
+// 程序空转 (FX0A等待按键、只读DT的忙等循环) 时提前结束本帧，
+// 主循环睡眠到下一帧，把时间让给同一台机器上的其他实例
+
+#define GOVERNOR_FRAME_US 16667        // 一帧的时长 (微秒)
+#define GOVERNOR_MIN_IPF 1             // 限流时每帧至少执行的指令数
+#define GOVERNOR_MAX_LOOP_BYTES 16     // 空转检测的最大循环体长度 (8条指令)
+
+// 各平台的默认每帧指令数
+#define GOVERNOR_IPF_CHIP8  15
+#define GOVERNOR_IPF_SCHIP  30
+#define GOVERNOR_IPF_XOCHIP 1000
+
+typedef struct {
+    int ipf;                   // 目标每帧指令数
+    int effective_ipf;         // 受CPU份额限制后的每帧指令数
+    double cpu_share;          // 允许使用的CPU份额 (0-1]，1=不限制
+    
+    // 主机时间测量 (指数移动平均，微秒)
+    double busy_us;            // 上一帧周期内主循环的忙碌时间
+    double busy_avg;           // 每帧忙碌时间平均值
+    double emu_avg;            // 每帧执行指令时间平均值
+    double instr_avg;          // 每条指令平均耗时
+    
+    // 空转检测：同一个向后跳转再次执行时状态完全相同，说明本帧内不会再有变化
+    uint16_t loop_pc;
+    uint16_t loop_I;
+    uint8_t loop_V[16];
+    uint8_t loop_sp;
+    uint64_t loop_random;      // 已取出的随机数个数
+    uint8_t loop_keys[16];
+    int loop_valid;
+    uint32_t steps;            // chip8_governor_spinning 的调用次数
+    uint32_t loop_steps;       // 记录快照时的 steps
+    int loop_length;           // 检测到空转时循环一周的指令数
+    
+    // 统计
+    uint64_t frames;
+    uint64_t idle_frames;      // 提前结束的帧
+    uint64_t throttled_frames; // 因CPU份额降低了指令数的帧
+} Chip8Governor;
+
+// 根据ROM分析结果选择每帧指令数
+int chip8_governor_profile_ipf(const RomEntry* entry);
+
+void chip8_governor_init(Chip8Governor* gov, int ipf, double cpu_share);
+
+// 累计主循环一次迭代的忙碌时间 (不含睡眠)
+void chip8_governor_add_busy(Chip8Governor* gov, double us);
+
+// 开始一帧：根据测量结果调整并返回本帧指令数
+int chip8_governor_begin(Chip8Governor* gov);
+
+// 执行一条指令后调用 (pc/opcode 为执行前的值)，返回1表示程序在空转，本帧可以提前结束
+int chip8_governor_spinning(Chip8Governor* gov, const Chip8* chip8, uint16_t pc, uint16_t opcode);
+
+// 结束一帧：executed 为执行的指令数，emu_us 为执行用时，idle 表示提前结束
+void chip8_governor_end(Chip8Governor* gov, int executed, double emu_us, int idle);
+
+#endif // CHIP8_GOVERNOR_H
@@ -0,0 +1,17 @@
+#ifndef CHIP8_HASH_H
+#define CHIP8_HASH_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+// ROM内容哈希：SHA-1 (与常见ROM数据库一致) 和 XXH64 (快速校验/查找)
+
+#define SHA1_DIGEST_SIZE 20
+
+void chip8_sha1(const void* data, size_t size, uint8_t digest[SHA1_DIGEST_SIZE]);
+uint64_t chip8_xxh64(const void* data, size_t size, uint64_t seed);
+
+// 将摘要格式化为十六进制字符串 (out 至少 2*size+1 字节)
+void chip8_hash_hex(const uint8_t* digest, size_t size, char* out);
+
+#endif // CHIP8_HASH_H
@@ -0,0 +1,64 @@
+#include <string.h>
+#include "chip8_input.h"
+
+void chip8_input_init(Chip8InputQueue* queue) {
+    memset(queue, 0, sizeof(*queue));
+    SDL_AtomicSet(&queue->head, 0);
+    SDL_AtomicSet(&queue->tail, 0);
+}
+
+int chip8_input_push(Chip8InputQueue* queue, uint64_t timestamp, uint8_t key, int pressed) {
+    int head = SDL_AtomicGet(&queue->head);
+    
+    if (head - SDL_AtomicGet(&queue->tail) >= INPUT_QUEUE_SIZE) {
+        queue->dropped++;
+        return 0;
+    }
+    
+    InputEvent* event = &queue->events[head & (INPUT_QUEUE_SIZE - 1)];
+    event->timestamp = timestamp;
+    event->key = key & 0xF;
+    event->pressed = pressed ? 1 : 0;
+    
+    // SDL_AtomicSet 带完整内存屏障，消费者看到新的head时事件内容已经写完
+    SDL_AtomicSet(&queue->head, head + 1);
+    return 1;
+}
+
+void chip8_input_apply(Chip8InputQueue* queue, Chip8* chip8, uint64_t until) {
+    int tail = SDL_AtomicGet(&queue->tail);
+    int head = SDL_AtomicGet(&queue->head);
+    uint16_t changed = 0;  // 本周期已改变状态的按键
+    
+    while (tail != head) {
+        const InputEvent* event = &queue->events[tail & (INPUT_QUEUE_SIZE - 1)];
+        if (event->timestamp > until || (changed & (1u << event->key))) {
+            break;  // 留到后面的周期
+        }
+        
+        uint16_t bit = (uint16_t)(1u << event->key);
+        if (event->pressed) {
+            chip8->key[event->key] = 1;
+            chip8->key_fresh |= bit;
+            chip8->key_release &= (uint16_t)~bit;
+        } else if (chip8->key_fresh & bit) {
+            chip8->key_release |= bit;  // 还没有被读到过：保持按下，读到一次后再松开
+        } else {
+            chip8->key[event->key] = 0;
+        }
+        changed |= bit;
+        if (queue->applied_count < INPUT_APPLIED_MAX) {
+            queue->applied[queue->applied_count++] = event->timestamp;
+        }
+        tail++;
+    }
+    
+    SDL_AtomicSet(&queue->tail, tail);
+}
+
+int chip8_input_take_applied(Chip8InputQueue* queue, uint64_t* out, int max) {
+    int count = queue->applied_count < max ? queue->applied_count : max;
+    memcpy(out, queue->applied, (size_t)count * sizeof(uint64_t));
+    queue->applied_count = 0;
+    return count;
+}
@@ -0,0 +1,44 @@
+#ifndef CHIP8_INPUT_H
+#define CHIP8_INPUT_H
+
+#include "chip8.h"
+
+// 带时间戳的输入队列：事件回调 (生产者) 用高精度计数器标记按键事件，
+// 主循环 (消费者) 在每个模拟周期之前应用已收到的事件，同一按键每个周期最多改变一次。
+// 时间戳是SDL取出事件的时刻 (同一次事件泵中的事件几乎相同)，用于输入到画面的延迟统计
+
+#define INPUT_QUEUE_SIZE 256   // 必须是2的幂
+#define INPUT_APPLIED_MAX 16   // 等待画面反映的事件数上限 (延迟统计)
+
+typedef struct {
+    uint64_t timestamp;        // SDL_GetPerformanceCounter() 时刻
+    uint8_t key;               // CHIP-8按键 0-F
+    uint8_t pressed;           // 1=按下，0=松开
+} InputEvent;
+
+// 单生产者单消费者无锁环形队列
+typedef struct {
+    InputEvent events[INPUT_QUEUE_SIZE];
+    SDL_atomic_t head;         // 生产者写入位置
+    SDL_atomic_t tail;         // 消费者读取位置
+    uint32_t dropped;          // 队列满时丢弃的事件数 (生产者计数)
+    
+    // 消费者：已应用但还没有提交到屏幕的事件时间戳 (输入到画面的延迟统计)
+    uint64_t applied[INPUT_APPLIED_MAX];
+    int applied_count;
+} Chip8InputQueue;
+
+void chip8_input_init(Chip8InputQueue* queue);
+
+// 生产者：加入一个事件，队列满时返回0
+int chip8_input_push(Chip8InputQueue* queue, uint64_t timestamp, uint8_t key, int pressed);
+
+// 消费者：应用时间戳不晚于 until 的事件。
+// 同一周期内每个按键最多改变一次状态，快速的按下+松开会分到相邻周期，不会互相抵消；
+// 按下后还没被 EX9E/EXA1/FX0A 读到的键，松开会推迟到读到一次或下一次定时器更新
+void chip8_input_apply(Chip8InputQueue* queue, Chip8* chip8, uint64_t until);
+
+// 消费者：取出上次调用以来已应用的事件时间戳 (最多 max 个)，提交一帧之后调用
+int chip8_input_take_applied(Chip8InputQueue* queue, uint64_t* out, int max);
+
+#endif // CHIP8_INPUT_H
@@ -0,0 +1,181 @@
+#include <stdio.h>
+#include <string.h>
+#include <SDL2/SDL.h>
+#include "chip8_metrics.h"
+
+#ifndef _WIN32
+#include <poll.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#endif
+
+MetricsBlock chip8_metrics_blocks[METRICS_THREAD_COUNT];
+
+static const char* COUNTER_NAMES[METRIC_COUNTER_COUNT] = {
+    "chip8_instructions_total",
+    "chip8_emulated_frames_total",
+    "chip8_presented_frames_total",
+    "chip8_dropped_frames_total",
+    "chip8_record_dropped_frames_total",
+    "chip8_audio_callbacks_total",
+    "chip8_audio_underruns_total",
+    "chip8_idle_frames_total"
+};
+
+static const char* GAUGE_NAMES[METRIC_GAUGE_COUNT] = {
+    "chip8_fps",
+    "chip8_cycle_lag",
+    "chip8_speed_instructions_per_second",
+    "chip8_host_load"
+};
+
+static const char* HIST_NAMES[METRIC_HIST_COUNT] = {
+    "chip8_emulated_frame_time_us",
+    "chip8_wall_frame_time_us",
+    "chip8_present_time_us",
+    "chip8_input_latency_us"
+};
+
+// 服务线程状态
+static SDL_Thread* server_thread = NULL;
+static SDL_atomic_t server_running;
+static char server_path[108];
+
+// 汇总所有线程的计数
+static uint64_t sum_counter(MetricCounter counter) {
+    uint64_t total = 0;
+    for (int t = 0; t < METRICS_THREAD_COUNT; t++) {
+        total += __atomic_load_n(&chip8_metrics_blocks[t].counters[counter], __ATOMIC_RELAXED);
+    }
+    return total;
+}
+
+// 生成文本快照：每行 "名称 值"，直方图按累计桶输出
+size_t chip8_metrics_format(char* buf, size_t size) {
+    size_t len = 0;
+#define APPEND(...) do { \
+        int n = snprintf(buf + len, len < size ? size - len : 0, __VA_ARGS__); \
+        if (n > 0) len += (size_t)n; \
+    } while (0)
+    
+    for (int c = 0; c < METRIC_COUNTER_COUNT; c++) {
+        APPEND("%s %llu\n", COUNTER_NAMES[c], (unsigned long long)sum_counter((MetricCounter)c));
+    }
+    
+    for (int g = 0; g < METRIC_GAUGE_COUNT; g++) {
+        int64_t value = 0;
+        for (int t = 0; t < METRICS_THREAD_COUNT; t++) {
+            value += (int64_t)__atomic_load_n(&chip8_metrics_blocks[t].gauges[g], __ATOMIC_RELAXED);
+        }
+        APPEND("%s %.3f\n", GAUGE_NAMES[g], value / 1000.0);
+    }
+    
+    for (int h = 0; h < METRIC_HIST_COUNT; h++) {
+        uint64_t cumulative = 0, sum = 0;
+        for (int b = 0; b < METRICS_HIST_BUCKETS; b++) {
+            for (int t = 0; t < METRICS_THREAD_COUNT; t++) {
+                cumulative += __atomic_load_n(&chip8_metrics_blocks[t].hist[h][b], __ATOMIC_RELAXED);
+            }
+            if (b < METRICS_HIST_BUCKETS - 1) {
+                APPEND("%s_bucket{le=\"%llu\"} %llu\n", HIST_NAMES[h], 1ull << b, (unsigned long long)cumulative);
+            } else {
+                APPEND("%s_bucket{le=\"+Inf\"} %llu\n", HIST_NAMES[h], (unsigned long long)cumulative);
+            }
+        }
+        for (int t = 0; t < METRICS_THREAD_COUNT; t++) {
+            sum += __atomic_load_n(&chip8_metrics_blocks[t].hist_sum[h], __ATOMIC_RELAXED);
+        }
+        APPEND("%s_sum %llu\n", HIST_NAMES[h], (unsigned long long)sum);
+        APPEND("%s_count %llu\n", HIST_NAMES[h], (unsigned long long)cumulative);
+    }
+    
+#undef APPEND
+    return len < size ? len : size;
+}
+
+#ifndef _WIN32
+// 服务线程：每个连接写出一份快照后关闭
+static int metrics_server_thread(void* data) {
+    int listen_fd = (int)(intptr_t)data;
+    static char snapshot[16384];
+    
+    while (SDL_AtomicGet(&server_running)) {
+        struct pollfd pfd = { listen_fd, POLLIN, 0 };
+        if (poll(&pfd, 1, 200) <= 0) continue;
+        
+        int client = accept(listen_fd, NULL, NULL);
+        if (client < 0) continue;
+        
+        size_t len = chip8_metrics_format(snapshot, sizeof(snapshot));
+        const char* p = snapshot;
+        while (len > 0) {
+            // MSG_NOSIGNAL：抓取方提前关闭连接时得到EPIPE，而不是SIGPIPE结束整个进程
+            ssize_t n = send(client, p, len, MSG_NOSIGNAL);
+            if (n <= 0) break;
+            p += n;
+            len -= (size_t)n;
+        }
+        close(client);
+    }
+    
+    close(listen_fd);
+    unlink(server_path);
+    return 0;
+}
+#endif
+
+// 启动指标服务
+int chip8_metrics_serve(const char* socket_path) {
+#ifdef _WIN32
+    (void)socket_path;
+    fprintf(stderr, "警告: 当前平台不支持UNIX域套接字指标服务\n");
+    return 0;
+#else
+    if (!socket_path || server_thread) return 0;
+    
+    struct sockaddr_un addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    if (strlen(socket_path) >= sizeof(addr.sun_path)) {
+        fprintf(stderr, "错误: 套接字路径太长: %s\n", socket_path);
+        return 0;
+    }
+    strcpy(addr.sun_path, socket_path);
+    snprintf(server_path, sizeof(server_path), "%s", socket_path);
+    
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0) {
+        perror("socket");
+        return 0;
+    }
+    
+    unlink(socket_path);  // 清理上次异常退出留下的套接字文件
+    if (bind(fd, (struct sockaddr*)&addr, sizeof(addr)) != 0 || listen(fd, 8) != 0) {
+        perror("bind/listen");
+        close(fd);
+        return 0;
+    }
+    
+    SDL_AtomicSet(&server_running, 1);
+    server_thread = SDL_CreateThread(metrics_server_thread, "chip8_metrics", (void*)(intptr_t)fd);
+    if (!server_thread) {
+        fprintf(stderr, "错误: 无法创建指标服务线程: %s\n", SDL_GetError());
+        close(fd);
+        unlink(socket_path);
+        return 0;
+    }
+    
+    printf("指标服务已启动: %s\n", socket_path);
+    return 1;
+#endif
+}
+
+// 停止指标服务
+void chip8_metrics_stop(void) {
+    if (!server_thread) return;
+    
+    SDL_AtomicSet(&server_running, 0);
+    SDL_WaitThread(server_thread, NULL);
+    server_thread = NULL;
+}
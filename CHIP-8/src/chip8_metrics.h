@@ -0,0 +1,92 @@
+#ifndef CHIP8_METRICS_H
+#define CHIP8_METRICS_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+// 运行指标：每个线程只写自己的计数块 (无锁、无原子读改写)，
+// 指标服务线程在本地UNIX域套接字上按需汇总并输出文本快照
+
+#define METRICS_HIST_BUCKETS 21        // 直方图桶数：<=1us, <=2us, ... <=2^19us, +Inf
+
+// 计数器
+typedef enum {
+    METRIC_INSTRUCTIONS = 0,           // 已执行的模拟指令
+    METRIC_EMULATED_FRAMES,            // 已模拟的帧 (60Hz定时器节拍)
+    METRIC_PRESENTED_FRAMES,           // 已提交到屏幕的帧
+    METRIC_DROPPED_FRAMES,             // 主循环错过的显示节拍
+    METRIC_RECORD_DROPPED_FRAMES,      // 录制队列满时丢弃的帧
+    METRIC_AUDIO_CALLBACKS,            // 音频回调次数
+    METRIC_AUDIO_UNDERRUNS,            // 音频欠载 (回调间隔超过缓冲区时长的1.5倍)
+    METRIC_IDLE_FRAMES,                // 速度调节器检测到空转而提前结束的帧
+    METRIC_COUNTER_COUNT
+} MetricCounter;
+
+// 瞬时值 (以千分之一为单位存储)
+typedef enum {
+    METRIC_GAUGE_FPS = 0,              // update_fps_display 计算的FPS
+    METRIC_GAUGE_CYCLE_LAG,            // cycle_accumulator 中尚未执行的周期数
+    METRIC_GAUGE_SPEED,                // 当前游戏速度 (指令/秒)
+    METRIC_GAUGE_HOST_LOAD,            // 速度调节器：每帧忙碌时间占帧时长的比例
+    METRIC_GAUGE_COUNT
+} MetricGauge;
+
+// 直方图 (微秒)
+typedef enum {
+    METRIC_HIST_EMU_FRAME = 0,         // 模拟一帧所用的主机时间
+    METRIC_HIST_WALL_FRAME,            // 相邻两次提交之间的实际时间
+    METRIC_HIST_PRESENT,               // chip8_graphics_update 耗时
+    METRIC_HIST_INPUT_LATENCY,         // 按键事件到第一次反映它的提交完成
+    METRIC_HIST_COUNT
+} MetricHist;
+
+// 写入指标的线程
+typedef enum {
+    METRICS_THREAD_MAIN = 0,
+    METRICS_THREAD_AUDIO,
+    METRICS_THREAD_COUNT
+} MetricsThread;
+
+// 单个线程的计数块 (按缓存行对齐，避免线程间伪共享)
+typedef struct {
+    uint64_t counters[METRIC_COUNTER_COUNT];
+    uint64_t gauges[METRIC_GAUGE_COUNT];
+    uint64_t hist[METRIC_HIST_COUNT][METRICS_HIST_BUCKETS];
+    uint64_t hist_sum[METRIC_HIST_COUNT];
+} __attribute__((aligned(64))) MetricsBlock;
+
+extern MetricsBlock chip8_metrics_blocks[METRICS_THREAD_COUNT];
+
+// 单写者更新：普通加法 + relaxed原子存储，读者不会读到撕裂的值
+static inline void metrics_store(uint64_t* slot, uint64_t value) {
+    __atomic_store_n(slot, value, __ATOMIC_RELAXED);
+}
+
+static inline void metrics_add(MetricsThread thread, MetricCounter counter, uint64_t value) {
+    uint64_t* slot = &chip8_metrics_blocks[thread].counters[counter];
+    metrics_store(slot, *slot + value);
+}
+
+static inline void metrics_gauge(MetricsThread thread, MetricGauge gauge, double value) {
+    metrics_store(&chip8_metrics_blocks[thread].gauges[gauge], (uint64_t)(int64_t)(value * 1000.0));
+}
+
+static inline void metrics_observe(MetricsThread thread, MetricHist hist, uint64_t us) {
+    MetricsBlock* block = &chip8_metrics_blocks[thread];
+    int bucket = 0;
+    while (bucket < METRICS_HIST_BUCKETS - 1 && (1ull << bucket) < us) {
+        bucket++;
+    }
+    metrics_store(&block->hist[hist][bucket], block->hist[hist][bucket] + 1);
+    metrics_store(&block->hist_sum[hist], block->hist_sum[hist] + us);
+}
+
+// 生成文本快照，返回写入的字节数。只输出单调计数，不保存上次快照的状态：
+// 多个采集者互不影响，速率由采集端计算 (例如 rate(chip8_instructions_total[1m]))
+size_t chip8_metrics_format(char* buf, size_t size);
+
+// 启动/停止指标服务 (UNIX域套接字)
+int chip8_metrics_serve(const char* socket_path);
+void chip8_metrics_stop(void);
+
+#endif // CHIP8_METRICS_H
@@ -0,0 +1,179 @@
+#include <stdio.h>
+#include <string.h>
+#include "chip8_mmap.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+#ifdef _WIN32
+
+int chip8_mmap_open(Chip8MappedFile* map, const char* path, int writable, size_t size) {
+    memset(map, 0, sizeof(*map));
+    
+    HANDLE file = CreateFileA(path, writable ? (GENERIC_READ | GENERIC_WRITE) : GENERIC_READ,
+                              FILE_SHARE_READ | FILE_SHARE_WRITE, NULL,
+                              writable ? OPEN_ALWAYS : OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (file == INVALID_HANDLE_VALUE) {
+        return 0;
+    }
+    
+    // 锁住文件末尾之外的一个字节：字节范围锁是强制的，锁在映射区域内会影响其他进程读取
+    if (writable == MMAP_EXCLUSIVE) {
+        OVERLAPPED ov;
+        memset(&ov, 0, sizeof(ov));
+        ov.OffsetHigh = 0x40000000;
+        if (!LockFileEx(file, LOCKFILE_EXCLUSIVE_LOCK | LOCKFILE_FAIL_IMMEDIATELY, 0, 1, 0, &ov)) {
+            fprintf(stderr, "错误: 文件正在被另一个进程使用: %s\n", path);
+            CloseHandle(file);
+            return 0;
+        }
+        map->locked = 1;
+    }
+    
+    if (writable && size > 0) {
+        LARGE_INTEGER li;
+        li.QuadPart = (LONGLONG)size;
+        if (!SetFilePointerEx(file, li, NULL, FILE_BEGIN) || !SetEndOfFile(file)) {
+            fprintf(stderr, "错误: 无法调整文件大小: %s\n", path);
+            CloseHandle(file);
+            return 0;
+        }
+    } else {
+        LARGE_INTEGER li;
+        if (!GetFileSizeEx(file, &li)) {
+            CloseHandle(file);
+            return 0;
+        }
+        size = (size_t)li.QuadPart;
+    }
+    
+    map->file = file;
+    map->is_open = 1;
+    map->size = size;
+    map->writable = writable;
+    if (size == 0) {
+        return 1;
+    }
+    
+    HANDLE mapping = CreateFileMappingA(file, NULL, writable ? PAGE_READWRITE : PAGE_READONLY, 0, 0, NULL);
+    if (!mapping) {
+        fprintf(stderr, "错误: 无法创建文件映射: %s\n", path);
+        CloseHandle(file);
+        map->is_open = 0;
+        return 0;
+    }
+    
+    map->data = (uint8_t*)MapViewOfFile(mapping, writable ? FILE_MAP_WRITE : FILE_MAP_READ, 0, 0, size);
+    if (!map->data) {
+        fprintf(stderr, "错误: 无法映射文件视图: %s\n", path);
+        CloseHandle(mapping);
+        CloseHandle(file);
+        map->is_open = 0;
+        return 0;
+    }
+    
+    map->mapping = mapping;
+    return 1;
+}
+
+void chip8_mmap_sync(Chip8MappedFile* map) {
+    if (map->data && map->writable) {
+        FlushViewOfFile(map->data, map->size);
+        FlushFileBuffers((HANDLE)map->file);
+    }
+}
+
+void chip8_mmap_close(Chip8MappedFile* map) {
+    if (!map->is_open) return;
+    if (map->data) UnmapViewOfFile(map->data);
+    if (map->mapping) CloseHandle((HANDLE)map->mapping);
+    if (map->locked) {
+        OVERLAPPED ov;
+        memset(&ov, 0, sizeof(ov));
+        ov.OffsetHigh = 0x40000000;
+        UnlockFileEx((HANDLE)map->file, 0, 1, 0, &ov);
+    }
+    CloseHandle((HANDLE)map->file);
+    memset(map, 0, sizeof(*map));
+}
+
+#else
+
+int chip8_mmap_open(Chip8MappedFile* map, const char* path, int writable, size_t size) {
+    memset(map, 0, sizeof(*map));
+    map->fd = -1;
+    
+    int fd = writable ? open(path, O_RDWR | O_CREAT, 0644) : open(path, O_RDONLY);
+    if (fd < 0) {
+        return 0;
+    }
+    
+    // flock 锁属于打开的文件描述，关闭 fd 时自动释放
+    if (writable == MMAP_EXCLUSIVE) {
+        if (flock(fd, LOCK_EX | LOCK_NB) != 0) {
+            fprintf(stderr, "错误: 文件正在被另一个进程使用: %s\n", path);
+            close(fd);
+            return 0;
+        }
+        map->locked = 1;
+    }
+    
+    if (writable && size > 0) {
+        if (ftruncate(fd, (off_t)size) != 0) {
+            fprintf(stderr, "错误: 无法调整文件大小: %s\n", path);
+            close(fd);
+            return 0;
+        }
+    } else {
+        struct stat st;
+        if (fstat(fd, &st) != 0) {
+            close(fd);
+            return 0;
+        }
+        size = (size_t)st.st_size;
+    }
+    
+    map->fd = fd;
+    map->is_open = 1;
+    map->size = size;
+    map->writable = writable;
+    if (size == 0) {
+        return 1;
+    }
+    
+    void* data = mmap(NULL, size, writable ? (PROT_READ | PROT_WRITE) : PROT_READ,
+                      writable ? MAP_SHARED : MAP_PRIVATE, fd, 0);
+    if (data == MAP_FAILED) {
+        fprintf(stderr, "错误: 无法映射文件: %s\n", path);
+        close(fd);
+        map->fd = -1;
+        map->is_open = 0;
+        return 0;
+    }
+    
+    map->data = (uint8_t*)data;
+    return 1;
+}
+
+void chip8_mmap_sync(Chip8MappedFile* map) {
+    if (map->data && map->writable) {
+        msync(map->data, map->size, MS_SYNC);
+    }
+}
+
+void chip8_mmap_close(Chip8MappedFile* map) {
+    if (!map->is_open) return;
+    if (map->data) munmap(map->data, map->size);
+    close(map->fd);
+    memset(map, 0, sizeof(*map));
+    map->fd = -1;
+}
+
+#endif
@@ -0,0 +1,36 @@
+#ifndef CHIP8_MMAP_H
+#define CHIP8_MMAP_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+// 可移植的文件内存映射 (POSIX mmap / Windows文件映射)
+
+#define MMAP_EXCLUSIVE 2         // writable 取值：读写并独占 (其他进程已独占时打开失败)
+
+typedef struct {
+    uint8_t* data;           // 映射起始地址 (空文件时为NULL)
+    size_t size;             // 映射大小
+    int writable;            // 是否为可写的共享映射
+    int is_open;             // 文件已打开
+    int locked;              // 持有独占锁 (MMAP_EXCLUSIVE)
+#ifdef _WIN32
+    void* file;              // HANDLE
+    void* mapping;           // HANDLE
+#else
+    int fd;
+#endif
+} Chip8MappedFile;
+
+// 映射文件。writable=0 时只读映射整个文件；
+// writable=1 时以读写方式打开 (不存在则创建)，并在 size>0 时将文件调整为 size 字节；
+// writable=MMAP_EXCLUSIVE 时另外在调整大小之前加独占锁，关闭时释放
+int chip8_mmap_open(Chip8MappedFile* map, const char* path, int writable, size_t size);
+
+// 将修改写回磁盘
+void chip8_mmap_sync(Chip8MappedFile* map);
+
+// 解除映射并关闭文件
+void chip8_mmap_close(Chip8MappedFile* map);
+
+#endif // CHIP8_MMAP_H
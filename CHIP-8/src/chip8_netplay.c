@@ -0,0 +1,375 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "chip8_netplay.h"
+#include "chip8_hash.h"
+
+#ifdef _WIN32
+#include <winsock2.h>
+#include <ws2tcpip.h>
+typedef int socklen_t;
+#define close_socket(s) closesocket((SOCKET)(s))
+#else
+#include <errno.h>
+#include <fcntl.h>
+#include <netdb.h>
+#include <unistd.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#define close_socket(s) close((int)(s))
+#endif
+
+#define NETPLAY_MAGIC "C8NP"
+#define NETPLAY_VERSION 1
+#define NETPLAY_HEADER_SIZE 42
+#define NETPLAY_PACKET_SIZE (NETPLAY_HEADER_SIZE + NETPLAY_HISTORY * 2)
+
+#define HISTORY_INDEX(f) ((f) & (NETPLAY_HISTORY - 1))
+#define SNAPSHOT_INDEX(f) ((f) & (NETPLAY_SNAPSHOTS - 1))
+
+// ---------------------------------------------------------------
+// 数据包 (小端序)
+// ---------------------------------------------------------------
+//  0  magic[4]      "C8NP"
+//  4  version       u8
+//  5  player        u8    发送方玩家编号
+//  6  ipf           u16
+//  8  rom_tag       u32
+// 12  frame         u32   发送方下一个要模拟的帧
+// 16  ack           u32   发送方已连续收到的对端输入帧数
+// 20  advantage     s8    发送方领先对端的帧数
+// 21  reserved      u8
+// 22  sync_frame    u32
+// 26  sync_hash     u64
+// 34  first         u32   inputs[0] 对应的帧
+// 38  count         u16
+// 40  reserved      u16
+// 42  inputs[count] u16   发送方的按键位掩码
+
+static void put16(uint8_t* p, uint16_t v) { p[0] = (uint8_t)v; p[1] = (uint8_t)(v >> 8); }
+static void put32(uint8_t* p, uint32_t v) { put16(p, (uint16_t)v); put16(p + 2, (uint16_t)(v >> 16)); }
+static void put64(uint8_t* p, uint64_t v) { put32(p, (uint32_t)v); put32(p + 4, (uint32_t)(v >> 32)); }
+static uint16_t get16(const uint8_t* p) { return (uint16_t)(p[0] | (p[1] << 8)); }
+static uint32_t get32(const uint8_t* p) { return get16(p) | ((uint32_t)get16(p + 2) << 16); }
+static uint64_t get64(const uint8_t* p) { return get32(p) | ((uint64_t)get32(p + 4) << 32); }
+
+// ---------------------------------------------------------------
+// 套接字
+// ---------------------------------------------------------------
+
+int chip8_netplay_open(Chip8Netplay* np, const char* spec, int player, int ipf) {
+    memset(np, 0, sizeof(*np));
+    np->sock = -1;
+    
+    char host[256];
+    int local_port = 0;
+    int peer_port = NETPLAY_DEFAULT_PORT;
+    const char* comma = spec ? strchr(spec, ',') : NULL;
+    if (!comma || (local_port = atoi(spec)) <= 0 || local_port > 65535) {
+        fprintf(stderr, "错误: 联机参数格式应为 <本地端口>,<对端地址>:<端口>: %s\n", spec ? spec : "");
+        return 0;
+    }
+    snprintf(host, sizeof(host), "%s", comma + 1);
+    char* colon = strrchr(host, ':');
+    if (colon) {
+        *colon = '\0';
+        peer_port = atoi(colon + 1);
+    }
+    if (player != 1 && player != 2) {
+        fprintf(stderr, "错误: 玩家编号必须是1或2\n");
+        return 0;
+    }
+
+#ifdef _WIN32
+    WSADATA wsa;
+    if (WSAStartup(MAKEWORD(2, 2), &wsa) != 0) {
+        fprintf(stderr, "错误: Winsock初始化失败\n");
+        return 0;
+    }
+#endif
+    
+    struct addrinfo hints, *result = NULL;
+    memset(&hints, 0, sizeof(hints));
+    hints.ai_family = AF_INET;
+    hints.ai_socktype = SOCK_DGRAM;
+    char port_text[16];
+    snprintf(port_text, sizeof(port_text), "%d", peer_port);
+    if (getaddrinfo(host, port_text, &hints, &result) != 0 || !result) {
+        fprintf(stderr, "错误: 无法解析对端地址: %s\n", host);
+        chip8_netplay_close(np);
+        return 0;
+    }
+    memcpy(np->peer_addr, result->ai_addr, sizeof(struct sockaddr_in));
+    freeaddrinfo(result);
+
+#ifdef _WIN32
+    SOCKET fd = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+    if (fd == INVALID_SOCKET) {
+#else
+    int fd = socket(AF_INET, SOCK_DGRAM, 0);
+    if (fd < 0) {
+#endif
+        fprintf(stderr, "错误: 无法创建UDP套接字\n");
+        chip8_netplay_close(np);
+        return 0;
+    }
+    np->sock = (intptr_t)fd;
+    
+    struct sockaddr_in local;
+    memset(&local, 0, sizeof(local));
+    local.sin_family = AF_INET;
+    local.sin_addr.s_addr = htonl(INADDR_ANY);
+    local.sin_port = htons((uint16_t)local_port);
+    if (bind(fd, (struct sockaddr*)&local, sizeof(local)) != 0) {
+        fprintf(stderr, "错误: 无法绑定UDP端口 %d\n", local_port);
+        chip8_netplay_close(np);
+        return 0;
+    }
+    
+    // 非阻塞：每个节拍读完已到达的数据包就返回
+#ifdef _WIN32
+    u_long nonblocking = 1;
+    ioctlsocket(fd, FIONBIO, &nonblocking);
+#else
+    fcntl(fd, F_SETFL, fcntl(fd, F_GETFL, 0) | O_NONBLOCK);
+#endif
+    
+    np->player = player;
+    np->local_mask = player == 1 ? NETPLAY_KEYS_P1 : NETPLAY_KEYS_P2;
+    np->remote_mask = player == 1 ? NETPLAY_KEYS_P2 : NETPLAY_KEYS_P1;
+    np->ipf = ipf > 0 ? ipf : 1;
+    
+    printf("联机已启动: 本地UDP端口 %d, 对端 %s:%d, %dP, 每帧%d条指令\n",
+           local_port, host, peer_port, player, np->ipf);
+    return 1;
+}
+
+void chip8_netplay_close(Chip8Netplay* np) {
+    if (np->sock != -1) {
+        close_socket(np->sock);
+        np->sock = -1;
+    }
+#ifdef _WIN32
+    WSACleanup();
+#endif
+}
+
+void chip8_netplay_begin(Chip8Netplay* np, Chip8* chip8, uint64_t rom_hash) {
+    np->rom_tag = (uint32_t)rom_hash;
+    np->frame = 0;
+    np->remote_confirmed = 0;
+    np->remote_ack = 0;
+    np->remote_frame = 0;
+    np->remote_advantage = 0;
+    np->sync_frame = 0;
+    np->remote_sync_frame = 0;
+    np->desynced = 0;
+    memset(np->local_input, 0, sizeof(np->local_input));
+    memset(np->remote_input, 0, sizeof(np->remote_input));
+    memset(np->remote_stamp, 0, sizeof(np->remote_stamp));
+    memset(np->predicted, 0, sizeof(np->predicted));
+    
+    // 双方从完全相同的机器状态开始
+    chip8_rng_init(&chip8->rng, (Chip8RngKind)chip8->rng.kind, (uint32_t)rom_hash, 0);
+    memset(chip8->key, 0, sizeof(chip8->key));
+}
+
+// ---------------------------------------------------------------
+// 模拟
+// ---------------------------------------------------------------
+
+// 模拟第 f 帧：保存快照，合并双方输入，执行一帧的指令并更新定时器
+static void simulate_frame(Chip8Netplay* np, Chip8* chip8, uint32_t f) {
+    uint16_t remote;
+    if (np->remote_stamp[HISTORY_INDEX(f)] == f + 1) {
+        remote = np->remote_input[HISTORY_INDEX(f)];
+    } else if (np->remote_confirmed > 0) {
+        remote = np->remote_input[HISTORY_INDEX(np->remote_confirmed - 1)];  // 预测：保持最后确认的状态
+    } else {
+        remote = 0;
+    }
+    np->predicted[HISTORY_INDEX(f)] = remote;
+    memcpy(np->snapshots[SNAPSHOT_INDEX(f)], chip8, STATE_MACHINE_SIZE);
+    
+    uint16_t keys = (uint16_t)((np->local_input[HISTORY_INDEX(f)] & np->local_mask) | (remote & np->remote_mask));
+    for (int k = 0; k < 16; k++) {
+        chip8->key[k] = (uint8_t)((keys >> k) & 1);
+    }
+    for (int i = 0; i < np->ipf; i++) {
+        chip8_cycle(chip8);
+    }
+    chip8_update_timers(chip8);
+}
+
+// 快照哈希 (不含由本地渲染清除的 draw_flag)
+static uint64_t snapshot_hash(const uint8_t* snapshot) {
+    static Chip8 copy;
+    memcpy(&copy, snapshot, STATE_MACHINE_SIZE);
+    copy.draw_flag = 0;
+    return chip8_xxh64(&copy, STATE_MACHINE_SIZE, 0);
+}
+
+static void check_sync(Chip8Netplay* np) {
+    if (np->desynced || np->sync_frame == 0 || np->sync_frame != np->remote_sync_frame) return;
+    if (np->sync_hash != np->remote_sync_hash) {
+        np->desynced = 1;
+        fprintf(stderr, "警告: 联机状态不同步 (第%u帧，本地%016llx，对端%016llx)\n", np->sync_frame,
+                (unsigned long long)np->sync_hash, (unsigned long long)np->remote_sync_hash);
+    }
+}
+
+// 已确认的最新校验帧：该帧之前双方的输入都已确定，快照不会再被回滚改变
+static void update_sync(Chip8Netplay* np) {
+    if (np->frame == 0) return;
+    uint32_t limit = np->remote_confirmed < np->frame ? np->remote_confirmed : np->frame - 1;
+    uint32_t f = limit - limit % NETPLAY_SYNC_INTERVAL;
+    if (f == 0 || f <= np->sync_frame || np->frame - f >= NETPLAY_SNAPSHOTS) return;
+    
+    np->sync_frame = f;
+    np->sync_hash = snapshot_hash(np->snapshots[SNAPSHOT_INDEX(f)]);
+    check_sync(np);
+}
+
+// ---------------------------------------------------------------
+// 收发
+// ---------------------------------------------------------------
+
+static void send_inputs(Chip8Netplay* np) {
+    uint8_t packet[NETPLAY_PACKET_SIZE];
+    uint32_t first = np->remote_ack;
+    if (np->frame - first > NETPLAY_HISTORY) first = np->frame - NETPLAY_HISTORY;
+    uint32_t count = np->frame - first;
+    int advantage = (int)(np->frame - np->remote_frame);
+    if (advantage > 127) advantage = 127;
+    if (advantage < -127) advantage = -127;
+    
+    memcpy(packet, NETPLAY_MAGIC, 4);
+    packet[4] = NETPLAY_VERSION;
+    packet[5] = (uint8_t)np->player;
+    put16(packet + 6, (uint16_t)np->ipf);
+    put32(packet + 8, np->rom_tag);
+    put32(packet + 12, np->frame);
+    put32(packet + 16, np->remote_confirmed);
+    packet[20] = (uint8_t)(int8_t)advantage;
+    packet[21] = 0;
+    put32(packet + 22, np->sync_frame);
+    put64(packet + 26, np->sync_hash);
+    put32(packet + 34, first);
+    put16(packet + 38, (uint16_t)count);
+    put16(packet + 40, 0);
+    for (uint32_t i = 0; i < count; i++) {
+        put16(packet + NETPLAY_HEADER_SIZE + i * 2, np->local_input[HISTORY_INDEX(first + i)]);
+    }
+    
+    sendto(np->sock, (const char*)packet, NETPLAY_HEADER_SIZE + count * 2, 0,
+           (const struct sockaddr*)np->peer_addr, sizeof(struct sockaddr_in));
+    np->packets_out++;
+}
+
+// 处理一个数据包，返回最早的预测错误帧 (没有时返回 UINT32_MAX)
+static uint32_t handle_packet(Chip8Netplay* np, const uint8_t* packet, int size) {
+    if (size < NETPLAY_HEADER_SIZE || memcmp(packet, NETPLAY_MAGIC, 4) != 0) return UINT32_MAX;
+    
+    const char* problem = NULL;
+    if (packet[4] != NETPLAY_VERSION) problem = "协议版本不同";
+    else if (packet[5] == np->player) problem = "双方使用了同一个玩家编号";
+    else if (get16(packet + 6) != np->ipf) problem = "每帧指令数不同 (请使用相同的游戏速度)";
+    else if (get32(packet + 8) != np->rom_tag) problem = "双方加载的ROM不同";
+    if (problem) {
+        if (!np->warned) fprintf(stderr, "警告: 忽略对端数据包: %s\n", problem);
+        np->warned = 1;
+        return UINT32_MAX;
+    }
+    
+    uint32_t first = get32(packet + 34);
+    uint32_t count = get16(packet + 38);
+    if (size < NETPLAY_HEADER_SIZE + (int)count * 2) return UINT32_MAX;
+    np->packets_in++;
+    
+    uint32_t ack = get32(packet + 16);
+    if (ack > np->remote_ack && ack <= np->frame) np->remote_ack = ack;
+    np->remote_frame = get32(packet + 12);
+    np->remote_advantage = (int8_t)packet[20];
+    uint32_t sync_frame = get32(packet + 22);
+    if (sync_frame > np->remote_sync_frame) {
+        np->remote_sync_frame = sync_frame;
+        np->remote_sync_hash = get64(packet + 26);
+        check_sync(np);
+    }
+    
+    uint32_t rollback = UINT32_MAX;
+    for (uint32_t i = 0; i < count; i++) {
+        uint32_t f = first + i;
+        if (f < np->remote_confirmed || f - np->remote_confirmed >= NETPLAY_HISTORY / 2) continue;
+        uint16_t input = get16(packet + NETPLAY_HEADER_SIZE + i * 2);
+        np->remote_input[HISTORY_INDEX(f)] = input;
+        np->remote_stamp[HISTORY_INDEX(f)] = f + 1;
+        
+        // 已经用预测值模拟过的帧：只比较对端玩家的按键
+        if (f < np->frame && ((input ^ np->predicted[HISTORY_INDEX(f)]) & np->remote_mask) && f < rollback) {
+            rollback = f;
+        }
+    }
+    while (np->remote_stamp[HISTORY_INDEX(np->remote_confirmed)] == np->remote_confirmed + 1) {
+        np->remote_confirmed++;
+    }
+    return rollback;
+}
+
+static uint32_t receive_inputs(Chip8Netplay* np) {
+    uint8_t packet[NETPLAY_PACKET_SIZE];
+    uint32_t rollback = UINT32_MAX;
+    for (;;) {
+        struct sockaddr_in from;
+        socklen_t from_len = sizeof(from);
+        int size = (int)recvfrom(np->sock, (char*)packet, sizeof(packet), 0, (struct sockaddr*)&from, &from_len);
+        if (size < 0) {
+#ifdef _WIN32
+            if (WSAGetLastError() == WSAECONNRESET) continue;  // 对端尚未启动时的ICMP端口不可达
+#else
+            if (errno == EINTR || errno == ECONNREFUSED) continue;
+#endif
+            break;
+        }
+        uint32_t f = handle_packet(np, packet, size);
+        if (f < rollback) rollback = f;
+    }
+    return rollback;
+}
+
+int chip8_netplay_frame(Chip8Netplay* np, Chip8* chip8, uint16_t local_keys) {
+    int simulated = 0;
+    
+    // 迟到的输入与预测不同：回到该帧之前的快照，用已知输入重新模拟到当前帧
+    uint32_t rollback = receive_inputs(np);
+    if (rollback < np->frame) {
+        int depth = (int)(np->frame - rollback);
+        memcpy(chip8, np->snapshots[SNAPSHOT_INDEX(rollback)], STATE_MACHINE_SIZE);
+        for (uint32_t f = rollback; f < np->frame; f++) {
+            simulate_frame(np, chip8, f);
+        }
+        chip8->draw_flag = 1;
+        simulated += depth;
+        np->rollbacks++;
+        np->resimulated += (uint64_t)depth;
+        if (depth > np->max_depth) np->max_depth = depth;
+    }
+    
+    if ((int32_t)(np->frame - np->remote_confirmed) >= NETPLAY_MAX_ROLLBACK) {
+        // 领先对端太多 (对端未启动或数据包丢失)：不再预测，等待对端输入
+        np->stalls++;
+    } else if ((int)(np->frame - np->remote_frame) - np->remote_advantage > NETPLAY_FRAME_SLACK) {
+        // 本地比对端快：等待一个主机帧，双方的领先帧数趋于相同，减少回滚
+        np->waits++;
+    } else {
+        np->local_input[HISTORY_INDEX(np->frame)] = local_keys;
+        simulate_frame(np, chip8, np->frame);
+        np->frame++;
+        simulated++;
+    }
+    
+    update_sync(np);
+    send_inputs(np);
+    return simulated;
+}
@@ -0,0 +1,74 @@
+#ifndef CHIP8_NETPLAY_H
+#define CHIP8_NETPLAY_H
+
+#include "chip8.h"
+#include "chip8_state.h"
+
+// 回滚联机：两个对等端各自运行完整的模拟，通过UDP交换每帧的按键状态。
+// 本地输入立即生效 (没有额外的输入延迟)，对端输入未到时沿用最后确认的按键状态预测；
+// 迟到的输入与预测不一致时恢复该帧之前的快照，在同一个主机帧内重新模拟到当前帧。
+// 按键按键盘布局分给两名玩家：1P为左半边 (1 2 4 5 7 8 A 0)，2P为右半边 (3 C 6 D 9 E B F)，
+// 正好对应Pong等双人ROM的两组按键
+
+#define NETPLAY_DEFAULT_PORT 7800
+#define NETPLAY_MAX_ROLLBACK 8         // 最多领先对端的帧数 (超过时等待)
+#define NETPLAY_HISTORY 32             // 输入历史环形缓冲区帧数 (2的幂)
+#define NETPLAY_SNAPSHOTS 16           // 快照环形缓冲区帧数 (2的幂，> NETPLAY_MAX_ROLLBACK)
+#define NETPLAY_FRAME_SLACK 2          // 比对端领先超过该帧数时等待一个主机帧
+#define NETPLAY_SYNC_INTERVAL 60       // 同步校验间隔 (帧)
+
+#define NETPLAY_KEYS_P1 0x05B7u        // 1P按键位掩码
+#define NETPLAY_KEYS_P2 0xFA48u        // 2P按键位掩码
+
+typedef struct {
+    intptr_t sock;                     // 平台相关套接字 (-1=未打开)
+    uint8_t peer_addr[16];             // 对端地址 (struct sockaddr_in)
+    int player;                        // 1 或 2
+    uint16_t local_mask;
+    uint16_t remote_mask;
+    int ipf;                           // 每帧指令数 (双方必须相同)
+    uint32_t rom_tag;                  // ROM哈希的低32位 (双方必须相同)
+    
+    uint32_t frame;                    // 下一个要模拟的帧
+    uint32_t remote_confirmed;         // 对端输入已连续收到的帧数 (0..remote_confirmed-1)
+    uint32_t remote_ack;               // 对端已连续收到的本地输入帧数 (之后的帧每个数据包都重发)
+    uint32_t remote_frame;             // 对端最近报告的帧
+    int remote_advantage;              // 对端报告的领先帧数
+    
+    uint16_t local_input[NETPLAY_HISTORY];
+    uint16_t remote_input[NETPLAY_HISTORY];
+    uint32_t remote_stamp[NETPLAY_HISTORY];  // 已收到的对端输入的帧号+1 (0=未收到)
+    uint16_t predicted[NETPLAY_HISTORY];  // 模拟该帧时使用的对端输入
+    uint8_t snapshots[NETPLAY_SNAPSHOTS][STATE_MACHINE_SIZE];  // 模拟该帧之前的机器状态
+    
+    // 同步校验：双方在同一帧开始时的机器状态哈希 (该帧之前的输入都已确认)
+    uint32_t sync_frame;
+    uint64_t sync_hash;
+    uint32_t remote_sync_frame;
+    uint64_t remote_sync_hash;
+    int desynced;
+    
+    // 统计
+    uint64_t rollbacks;                // 回滚次数
+    uint64_t resimulated;              // 重新模拟的帧数
+    int max_depth;                     // 最大回滚深度
+    uint64_t stalls;                   // 等待对端输入的主机帧
+    uint64_t waits;                    // 为与对端对齐而等待的主机帧
+    uint64_t packets_in;
+    uint64_t packets_out;
+    int warned;                        // 已报告的协议不匹配 (只报告一次)
+} Chip8Netplay;
+
+// 打开UDP套接字。spec 为 "<本地端口>,<对端地址>:<端口>"，player 为1或2
+int chip8_netplay_open(Chip8Netplay* np, const char* spec, int player, int ipf);
+
+// 加载ROM后调用：重置帧计数和输入历史，以ROM哈希作为双方共同的随机数种子
+void chip8_netplay_begin(Chip8Netplay* np, Chip8* chip8, uint64_t rom_hash);
+
+// 每个60Hz节拍调用一次：接收对端输入并在需要时回滚，然后以本地按键 (位掩码) 模拟一帧。
+// 返回本节拍模拟的帧数 (包括重新模拟的帧)，等待对端时返回0
+int chip8_netplay_frame(Chip8Netplay* np, Chip8* chip8, uint16_t local_keys);
+
+void chip8_netplay_close(Chip8Netplay* np);
+
+#endif // CHIP8_NETPLAY_H
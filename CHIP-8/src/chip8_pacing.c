@@ -0,0 +1,156 @@
+#include <string.h>
+#include <SDL2/SDL.h>
+#include "chip8_pacing.h"
+
+#define PACING_WORK_DECAY 0.02         // 工作量估计回落时新样本的权重
+#define PACING_PHASE_WEIGHT 0.1        // 提交返回晚于预测时相位向后靠拢的权重
+#define PACING_SPIN_US 1000            // 睡眠的最后这段时间忙等
+#define PACING_BAR_WIDTH 40            // 直方图最长的条
+
+void chip8_pacer_init(Chip8Pacer* pacer, int refresh_hz, double margin_us) {
+    memset(pacer, 0, sizeof(*pacer));
+    pacer->freq = SDL_GetPerformanceFrequency();
+    pacer->period = (double)pacer->freq / (refresh_hz > 0 ? refresh_hz : 60);
+    pacer->margin_us = margin_us >= 0.0 ? margin_us : PACING_DEFAULT_MARGIN_US;
+}
+
+void chip8_pacer_wait(Chip8Pacer* pacer) {
+    if (pacer->vblank > 0.0) {
+        // 本帧应在下一次消隐之前 (工作量 + 余量) 开始；上一帧超时则立即开始
+        double lead = (pacer->work_us + pacer->margin_us) * pacer->freq / 1000000.0;
+        double target = pacer->vblank + pacer->period - lead;
+        uint64_t now = SDL_GetPerformanceCounter();
+        
+        if (target > (double)now) {
+            double remaining_us = (target - (double)now) * 1000000.0 / pacer->freq;
+            if (remaining_us > PACING_SPIN_US) {
+                SDL_Delay((Uint32)((remaining_us - PACING_SPIN_US) / 1000.0));
+            }
+            while ((double)SDL_GetPerformanceCounter() < target) {
+                // SDL_Delay 的精度只有毫秒，最后一段忙等
+            }
+        }
+    }
+    pacer->frame_start = SDL_GetPerformanceCounter();
+}
+
+int chip8_pacer_tick(Chip8Pacer* pacer) {
+    uint64_t now = SDL_GetPerformanceCounter();
+    double step = pacer->freq / 60.0;
+    
+    // 很久没有节拍 (刚开始、加载ROM或调试器暂停)：从现在重新开始
+    if (pacer->next_tick == 0 || (double)now > pacer->next_tick + 4.0 * step) {
+        pacer->next_tick = now + (uint64_t)step;
+        return 1;
+    }
+    
+    // 节拍落在本次刷新的半个周期之内就算到本帧，
+    // 60Hz显示器上每帧恰好一个节拍，不会因为相位抖动变成0个和2个交替
+    if ((double)now + pacer->period / 2.0 >= (double)pacer->next_tick) {
+        pacer->next_tick += (uint64_t)step;
+        return 1;
+    }
+    return 0;
+}
+
+void chip8_pacer_presented(Chip8Pacer* pacer, uint64_t before, uint64_t after) {
+    if (pacer->frame_start && before >= pacer->frame_start) {
+        double work = (before - pacer->frame_start) * 1000000.0 / pacer->freq;
+        if (work > pacer->work_us) {
+            pacer->work_us = work;
+        } else {
+            pacer->work_us += (work - pacer->work_us) * PACING_WORK_DECAY;
+        }
+    }
+    
+    // 提交返回的时刻不早于消隐 (线程可能被推迟唤醒)：早于预测说明预测偏晚，立即对齐；
+    // 晚于预测只缓慢靠拢，偶尔的延迟唤醒不会打乱之后每帧的开始时刻
+    double observed = (double)after;
+    if (pacer->vblank <= 0.0) {
+        pacer->vblank = observed;
+    } else {
+        double predicted = pacer->vblank + pacer->period;
+        if (observed - predicted > pacer->period / 2.0) {
+            pacer->missed++;
+            while (observed - predicted > pacer->period / 2.0) {
+                predicted += pacer->period;
+            }
+        }
+        if (observed < predicted) {
+            predicted = observed;
+        } else {
+            predicted += (observed - predicted) * PACING_PHASE_WEIGHT;
+        }
+        pacer->vblank = predicted;
+    }
+    pacer->frames++;
+}
+
+uint64_t chip8_pacer_latency(Chip8Pacer* pacer, uint64_t input, uint64_t present) {
+    uint64_t us = present > input ? (uint64_t)((present - input) * 1000000.0 / pacer->freq) : 0;
+    
+    uint64_t bucket = us / PACING_LATENCY_BUCKET_US;
+    if (bucket >= PACING_LATENCY_BUCKETS) bucket = PACING_LATENCY_BUCKETS - 1;
+    pacer->latency_hist[bucket]++;
+    pacer->latency_count++;
+    pacer->latency_sum_us += us;
+    if (us > pacer->latency_max_us) pacer->latency_max_us = us;
+    return us;
+}
+
+uint64_t chip8_pacer_latency_percentile(const Chip8Pacer* pacer, double percentile) {
+    if (pacer->latency_count == 0) return 0;
+    
+    uint64_t rank = (uint64_t)(percentile / 100.0 * pacer->latency_count + 0.5);
+    if (rank < 1) rank = 1;
+    uint64_t cumulative = 0;
+    for (int b = 0; b < PACING_LATENCY_BUCKETS - 1; b++) {
+        cumulative += pacer->latency_hist[b];
+        if (cumulative >= rank) {
+            uint64_t upper = (uint64_t)(b + 1) * PACING_LATENCY_BUCKET_US;
+            return upper < pacer->latency_max_us ? upper : pacer->latency_max_us;
+        }
+    }
+    return pacer->latency_max_us;
+}
+
+void chip8_pacer_print_latency(Chip8Pacer* pacer, FILE* out) {
+    pacer->latency_reported = pacer->latency_count;
+    if (pacer->latency_count == 0) {
+        fprintf(out, "输入延迟: 没有样本\n");
+        return;
+    }
+    
+    fprintf(out, "输入延迟: %llu个样本, 平均%.1fms, p50<=%.1fms, p95<=%.1fms, p99<=%.1fms, 最大%.1fms\n",
+            (unsigned long long)pacer->latency_count,
+            pacer->latency_sum_us / 1000.0 / pacer->latency_count,
+            chip8_pacer_latency_percentile(pacer, 50.0) / 1000.0,
+            chip8_pacer_latency_percentile(pacer, 95.0) / 1000.0,
+            chip8_pacer_latency_percentile(pacer, 99.0) / 1000.0,
+            pacer->latency_max_us / 1000.0);
+    
+    // 只打印第一个到最后一个非空桶
+    int first = 0, last = PACING_LATENCY_BUCKETS - 1;
+    uint64_t peak = 0;
+    while (pacer->latency_hist[first] == 0) first++;
+    while (pacer->latency_hist[last] == 0) last--;
+    for (int b = first; b <= last; b++) {
+        if (pacer->latency_hist[b] > peak) peak = pacer->latency_hist[b];
+    }
+    
+    for (int b = first; b <= last; b++) {
+        char bar[PACING_BAR_WIDTH + 1];
+        int width = (int)((pacer->latency_hist[b] * PACING_BAR_WIDTH + peak - 1) / peak);
+        memset(bar, '#', (size_t)width);
+        bar[width] = '\0';
+        
+        int low = b * PACING_LATENCY_BUCKET_US / 1000;
+        if (b == PACING_LATENCY_BUCKETS - 1) {
+            fprintf(out, "  >=%2dms   %-*s %llu\n", low, PACING_BAR_WIDTH, bar,
+                    (unsigned long long)pacer->latency_hist[b]);
+        } else {
+            fprintf(out, "  %2d-%2dms  %-*s %llu\n", low, low + PACING_LATENCY_BUCKET_US / 1000, PACING_BAR_WIDTH, bar,
+                    (unsigned long long)pacer->latency_hist[b]);
+        }
+    }
+}
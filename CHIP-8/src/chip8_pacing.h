@@ -0,0 +1,59 @@
+#ifndef CHIP8_PACING_H
+#define CHIP8_PACING_H
+
+#include <stdio.h>
+#include <stdint.h>
+
+// 垂直同步节奏：渲染器开启 PRESENTVSYNC 后，提交会阻塞到显示器的垂直消隐，
+// 提交返回的时刻不早于消隐，据此锁定消隐的相位。每帧开始前睡眠到
+// "下一次消隐 - 一帧工作量估计 - 预留余量"，让事件处理、模拟和渲染
+// 恰好在消隐之前完成，按键采样尽量晚、每帧的延迟尽量一致。
+// 同时统计输入到画面的延迟：从按键事件的时间戳到第一次反映该事件的提交返回
+
+#define PACING_DEFAULT_MARGIN_US 2000  // 默认预留余量 (微秒)
+#define PACING_LATENCY_BUCKET_US 2000  // 延迟直方图每个桶的宽度
+#define PACING_LATENCY_BUCKETS 25      // 0-48ms 每2ms一个桶，最后一个桶为 >=48ms
+
+typedef struct {
+    uint64_t freq;             // SDL_GetPerformanceFrequency()
+    double period;             // 显示刷新周期 (计数器刻度)
+    double margin_us;          // 预留余量
+    double work_us;            // 一帧工作量估计 (遇到更长的帧立即跟上，之后缓慢回落)
+    double vblank;             // 最近一次消隐的估计时刻 (0=尚未提交)
+    uint64_t frame_start;      // 本帧开始工作的时刻
+    uint64_t next_tick;        // 下一个60Hz定时器节拍的时刻
+    
+    // 统计
+    uint64_t frames;
+    uint64_t missed;           // 错过消隐的帧 (两次提交之间跳过了至少一次消隐)
+    
+    // 输入到画面的延迟
+    uint64_t latency_hist[PACING_LATENCY_BUCKETS];
+    uint64_t latency_count;
+    uint64_t latency_sum_us;
+    uint64_t latency_max_us;
+    uint64_t latency_reported; // 上次打印时的样本数
+} Chip8Pacer;
+
+// refresh_hz<=0 时按60Hz
+void chip8_pacer_init(Chip8Pacer* pacer, int refresh_hz, double margin_us);
+
+// 一帧开始之前调用：睡眠到本帧应该开始工作的时刻 (最后一毫秒忙等以保证精度)
+void chip8_pacer_wait(Chip8Pacer* pacer);
+
+// 返回1表示到了下一个60Hz定时器节拍 (显示器刷新率不是60Hz时定时器仍按60Hz)
+int chip8_pacer_tick(Chip8Pacer* pacer);
+
+// 提交完成：before 为开始提交的时刻，after 为提交返回的时刻 (消隐)
+void chip8_pacer_presented(Chip8Pacer* pacer, uint64_t before, uint64_t after);
+
+// 记录一个输入事件的延迟 (input 为事件时间戳，present 为反映它的提交返回时刻)，返回微秒
+uint64_t chip8_pacer_latency(Chip8Pacer* pacer, uint64_t input, uint64_t present);
+
+// 估计延迟的百分位数 (按桶上界，微秒)
+uint64_t chip8_pacer_latency_percentile(const Chip8Pacer* pacer, double percentile);
+
+// 打印延迟摘要和直方图
+void chip8_pacer_print_latency(Chip8Pacer* pacer, FILE* out);
+
+#endif // CHIP8_PACING_H
@@ -0,0 +1,315 @@
+#include <stdio.h>
+#include <string.h>
+#include "chip8_perf.h"
+
+#ifdef __linux__
+#include <errno.h>
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+#endif
+
+#define PERF_CALIBRATION_RUNS 1000
+
+static const char* COUNTER_NAMES[PERF_COUNTER_COUNT] = {
+    "cycles", "instructions", "branch-misses", "L1d-read-misses"
+};
+
+static const char* REGION_NAMES[PERF_REGION_COUNT] = {
+    "指令执行", "画面刷新"
+};
+
+static const char* FAMILY_NAMES[PERF_OPCODE_FAMILIES] = {
+    "0 系统/清屏/返回", "1 跳转", "2 调用", "3 SE Vx,NN", "4 SNE Vx,NN", "5 SE Vx,Vy",
+    "6 LD Vx,NN", "7 ADD Vx,NN", "8 算术逻辑", "9 SNE Vx,Vy", "A LD I", "B 间接跳转",
+    "C 随机数", "D 绘图", "E 按键跳过", "F 定时器/内存"
+};
+
+static uint64_t now_ns(void) {
+    static uint64_t freq = 0;
+    if (!freq) freq = SDL_GetPerformanceFrequency();
+    uint64_t ticks = SDL_GetPerformanceCounter();
+    return (ticks / freq) * 1000000000ull + (ticks % freq) * 1000000000ull / freq;
+}
+
+// ---------------------------------------------------------------
+// 计数器
+// ---------------------------------------------------------------
+
+#ifdef __linux__
+static int open_counter(uint32_t type, uint64_t config, int group_fd) {
+    struct perf_event_attr attr;
+    memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.type = type;
+    attr.config = config;
+    attr.disabled = group_fd < 0;  // 组长创建时停止，全部加入后整组启动
+    attr.exclude_kernel = 1;       // 只计用户态 (perf_event_paranoid<=2 时允许)
+    attr.exclude_hv = 1;
+    attr.read_format = PERF_FORMAT_GROUP | PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+    return (int)syscall(__NR_perf_event_open, &attr, 0, -1, group_fd, 0);
+}
+#endif
+
+// 读取整组计数器 (按 perf->index 排列)，返回0表示读取失败
+static int read_counters(const Chip8Perf* perf, uint64_t* values, uint64_t* enabled, uint64_t* running) {
+#ifdef __linux__
+    uint64_t data[3 + PERF_COUNTER_COUNT];
+    if (perf->group_fd < 0) return 0;
+    ssize_t size = read(perf->group_fd, data, sizeof(uint64_t) * (3 + (size_t)perf->group_size));
+    if (size < (ssize_t)(sizeof(uint64_t) * 3)) return 0;
+    *enabled = data[1];
+    *running = data[2];
+    for (int i = 0; i < PERF_COUNTER_COUNT; i++) {
+        values[i] = perf->index[i] >= 0 ? data[3 + perf->index[i]] : 0;
+    }
+    return 1;
+#else
+    (void)perf;
+    (void)values;
+    (void)enabled;
+    (void)running;
+    return 0;
+#endif
+}
+
+int chip8_perf_init(Chip8Perf* perf, int opcodes) {
+    memset(perf, 0, sizeof(*perf));
+    perf->group_fd = -1;
+    for (int i = 0; i < PERF_COUNTER_COUNT; i++) {
+        perf->fd[i] = -1;
+        perf->index[i] = -1;
+    }
+    perf->enabled = 1;
+    perf->opcodes = opcodes;
+
+#ifdef __linux__
+    static const struct { uint32_t type; uint64_t config; } EVENTS[PERF_COUNTER_COUNT] = {
+        { PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES },
+        { PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS },
+        { PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES },
+        { PERF_TYPE_HW_CACHE, PERF_COUNT_HW_CACHE_L1D | (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+                              (PERF_COUNT_HW_CACHE_RESULT_MISS << 16) },
+    };
+    
+    // 第一个能打开的计数器作为组长，其余加入同一组 (同时开始、同时读取)
+    int errors[PERF_COUNTER_COUNT] = {0};
+    for (int i = 0; i < PERF_COUNTER_COUNT; i++) {
+        int fd = open_counter(EVENTS[i].type, EVENTS[i].config, perf->group_fd);
+        if (fd < 0) {
+            errors[i] = errno;
+            continue;
+        }
+        perf->fd[i] = fd;
+        perf->index[i] = perf->group_size++;
+        if (perf->group_fd < 0) perf->group_fd = fd;
+    }
+    
+    if (perf->group_fd >= 0) {
+        // 部分可用 (例如虚拟机不提供缓存事件)：缺少的列显示为 "-"
+        for (int i = 0; i < PERF_COUNTER_COUNT; i++) {
+            if (errors[i]) fprintf(stderr, "警告: 性能计数器 %s 不可用: %s\n", COUNTER_NAMES[i], strerror(errors[i]));
+        }
+        ioctl(perf->group_fd, PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+        ioctl(perf->group_fd, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+    } else if (errors[0] == EACCES || errors[0] == EPERM) {
+        fprintf(stderr, "警告: 没有权限打开性能计数器 (检查 /proc/sys/kernel/perf_event_paranoid)，只统计主机时间\n");
+    } else {
+        fprintf(stderr, "警告: 性能计数器不可用，只统计主机时间\n");
+    }
+#else
+    fprintf(stderr, "警告: 当前平台不支持性能计数器，只统计主机时间\n");
+#endif
+    
+    // 逐条测量时扣除一次空测量本身的计数
+    if (opcodes) {
+        PerfTotals calibration;
+        memset(&calibration, 0, sizeof(calibration));
+        for (int run = 0; run < PERF_CALIBRATION_RUNS; run++) {
+            chip8_perf_begin(perf);
+            chip8_perf_end(perf, PERF_REGION_GRAPHICS, 0);
+        }
+        calibration = perf->regions[PERF_REGION_GRAPHICS];
+        for (int i = 0; i < PERF_COUNTER_COUNT; i++) {
+            perf->overhead[i] = calibration.counters[i] / PERF_CALIBRATION_RUNS;
+        }
+        perf->overhead_ns = calibration.time_ns / PERF_CALIBRATION_RUNS;
+        memset(&perf->regions[PERF_REGION_GRAPHICS], 0, sizeof(PerfTotals));
+    }
+    return 1;
+}
+
+void chip8_perf_cleanup(Chip8Perf* perf) {
+#ifdef __linux__
+    for (int i = 0; i < PERF_COUNTER_COUNT; i++) {
+        if (perf->fd[i] >= 0) close(perf->fd[i]);
+        perf->fd[i] = -1;
+    }
+#endif
+    perf->group_fd = -1;
+    perf->enabled = 0;
+}
+
+// ---------------------------------------------------------------
+// 测量
+// ---------------------------------------------------------------
+
+void chip8_perf_begin(Chip8Perf* perf) {
+    if (!perf->enabled) return;
+    read_counters(perf, perf->start, &perf->start_enabled, &perf->start_running);
+    perf->start_time = now_ns();
+}
+
+// 把本次测量的增量加到 totals (计数器被复用时按实际运行时间比例放大)
+static void accumulate(Chip8Perf* perf, PerfTotals* totals, int subtract_overhead) {
+    uint64_t end_time = now_ns();
+    uint64_t values[PERF_COUNTER_COUNT], enabled, running;
+    uint64_t elapsed = end_time - perf->start_time;
+    
+    if (read_counters(perf, values, &enabled, &running)) {
+        uint64_t delta_enabled = enabled - perf->start_enabled;
+        uint64_t delta_running = running - perf->start_running;
+        for (int i = 0; i < PERF_COUNTER_COUNT; i++) {
+            uint64_t delta = values[i] - perf->start[i];
+            if (delta_running > 0 && delta_running < delta_enabled) {
+                delta = (uint64_t)((double)delta * delta_enabled / delta_running);
+            }
+            if (subtract_overhead) delta = delta > perf->overhead[i] ? delta - perf->overhead[i] : 0;
+            totals->counters[i] += delta;
+        }
+    }
+    if (subtract_overhead) elapsed = elapsed > perf->overhead_ns ? elapsed - perf->overhead_ns : 0;
+    totals->time_ns += elapsed;
+    totals->calls++;
+}
+
+void chip8_perf_end(Chip8Perf* perf, PerfRegion region, uint64_t instructions) {
+    if (!perf->enabled) return;
+    if (region == PERF_REGION_CPU && perf->opcodes) {
+        // 逐条测量时指令执行的总计由各操作码类别相加
+        perf->regions[region].calls++;
+        perf->regions[region].instructions += instructions;
+        return;
+    }
+    accumulate(perf, &perf->regions[region], 0);
+    perf->regions[region].instructions += instructions;
+}
+
+void chip8_perf_cycle(Chip8Perf* perf, Chip8* chip8) {
+    if (!perf->enabled || !perf->opcodes) {
+        chip8_cycle(chip8);
+        return;
+    }
+    
+    int family = chip8->memory[chip8->pc & (MEMORY_SIZE - 1)] >> 4;
+    chip8_perf_begin(perf);
+    chip8_cycle(chip8);
+    accumulate(perf, &perf->families[family], 1);
+    perf->families[family].instructions++;
+}
+
+void chip8_perf_frame(Chip8Perf* perf) {
+    if (perf->enabled) perf->frames++;
+}
+
+// ---------------------------------------------------------------
+// 报告
+// ---------------------------------------------------------------
+
+static void print_value(FILE* out, const Chip8Perf* perf, const PerfTotals* totals, int counter, double divisor) {
+    if (perf->index[counter] < 0 || divisor <= 0.0) {
+        fprintf(out, " %12s", "-");
+    } else {
+        fprintf(out, " %12.2f", totals->counters[counter] / divisor);
+    }
+}
+
+// 一行：每个单位 (条/帧/次) 的主机时间和各计数器
+static void print_row(FILE* out, const Chip8Perf* perf, const char* name, const PerfTotals* totals, double divisor) {
+    fprintf(out, "  %-20s %12.1f", name, divisor > 0.0 ? totals->time_ns / divisor : 0.0);
+    for (int i = 0; i < PERF_COUNTER_COUNT; i++) {
+        print_value(out, perf, totals, i, divisor);
+    }
+    fprintf(out, "\n");
+}
+
+static void print_header(FILE* out, const char* unit) {
+    fprintf(out, "  %-20s %12s", unit, "ns");
+    for (int i = 0; i < PERF_COUNTER_COUNT; i++) {
+        fprintf(out, " %12s", COUNTER_NAMES[i]);
+    }
+    fprintf(out, "\n");
+}
+
+// IPC 和每千条主机指令的分支失败/L1d缺失，用于判断瓶颈在分支预测还是访存
+static void print_ratios(FILE* out, const Chip8Perf* perf, const char* name, const PerfTotals* totals) {
+    if (perf->index[PERF_CYCLES] < 0 || perf->index[PERF_INSTRUCTIONS] < 0) return;
+    double cycles = (double)totals->counters[PERF_CYCLES];
+    double instructions = (double)totals->counters[PERF_INSTRUCTIONS];
+    if (cycles <= 0.0 || instructions <= 0.0) return;
+    
+    fprintf(out, "  %s: IPC %.2f", name, instructions / cycles);
+    if (perf->index[PERF_BRANCH_MISSES] >= 0) {
+        fprintf(out, ", 分支失败 %.2f/千条指令", totals->counters[PERF_BRANCH_MISSES] * 1000.0 / instructions);
+    }
+    if (perf->index[PERF_L1D_MISSES] >= 0) {
+        fprintf(out, ", L1d缺失 %.2f/千条指令", totals->counters[PERF_L1D_MISSES] * 1000.0 / instructions);
+    }
+    fprintf(out, "\n");
+}
+
+void chip8_perf_report(const Chip8Perf* perf, FILE* out) {
+    if (!perf->enabled) return;
+    
+    // 逐条测量模式下指令执行区域由各类别相加
+    PerfTotals cpu = perf->regions[PERF_REGION_CPU];
+    if (perf->opcodes) {
+        memset(cpu.counters, 0, sizeof(cpu.counters));
+        cpu.time_ns = 0;
+        for (int f = 0; f < PERF_OPCODE_FAMILIES; f++) {
+            for (int i = 0; i < PERF_COUNTER_COUNT; i++) cpu.counters[i] += perf->families[f].counters[i];
+            cpu.time_ns += perf->families[f].time_ns;
+        }
+    }
+    const PerfTotals* gfx = &perf->regions[PERF_REGION_GRAPHICS];
+    
+    fprintf(out, "性能计数器报告 (%s): %llu帧, %llu条模拟指令\n",
+            perf->group_fd >= 0 ? "perf_event_open, 用户态" : "计数器不可用，只有主机时间",
+            (unsigned long long)perf->frames, (unsigned long long)cpu.instructions);
+    
+    print_header(out, "每条模拟指令");
+    print_row(out, perf, REGION_NAMES[PERF_REGION_CPU], &cpu, (double)cpu.instructions);
+    
+    print_header(out, "每帧");
+    print_row(out, perf, REGION_NAMES[PERF_REGION_CPU], &cpu, (double)perf->frames);
+    if (gfx->calls > 0) {
+        // 无窗口模式不刷新画面
+        print_row(out, perf, REGION_NAMES[PERF_REGION_GRAPHICS], gfx, (double)perf->frames);
+        print_header(out, "每次调用");
+        print_row(out, perf, REGION_NAMES[PERF_REGION_GRAPHICS], gfx, (double)gfx->calls);
+    }
+    
+    print_ratios(out, perf, REGION_NAMES[PERF_REGION_CPU], &cpu);
+    if (gfx->calls > 0) print_ratios(out, perf, REGION_NAMES[PERF_REGION_GRAPHICS], gfx);
+    
+    if (!perf->opcodes) return;
+    
+    fprintf(out, "按操作码类别 (逐条测量，已扣除空测量开销，绝对值偏高，适合相互比较)\n");
+    fprintf(out, "  %-20s %10s %7s %12s", "类别", "条数", "占比", "ns");
+    for (int i = 0; i < PERF_COUNTER_COUNT; i++) {
+        fprintf(out, " %12s", COUNTER_NAMES[i]);
+    }
+    fprintf(out, "\n");
+    for (int f = 0; f < PERF_OPCODE_FAMILIES; f++) {
+        const PerfTotals* family = &perf->families[f];
+        if (family->instructions == 0) continue;
+        fprintf(out, "  %-20s %10llu %6.1f%% %12.1f", FAMILY_NAMES[f], (unsigned long long)family->instructions,
+                cpu.instructions ? 100.0 * family->instructions / cpu.instructions : 0.0,
+                (double)family->time_ns / family->instructions);
+        for (int i = 0; i < PERF_COUNTER_COUNT; i++) {
+            print_value(out, perf, family, i, (double)family->instructions);
+        }
+        fprintf(out, "\n");
+    }
+}
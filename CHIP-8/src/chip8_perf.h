@@ -0,0 +1,73 @@
+#ifndef CHIP8_PERF_H
+#define CHIP8_PERF_H
+
+#include <stdio.h>
+#include "chip8.h"
+
+// 硬件性能计数器：在Linux上用 perf_event_open 统计主机的时钟周期、指令数、
+// 分支预测失败和L1数据缓存读缺失 (只计用户态)，按区域 (指令执行、画面刷新) 累计，
+// 报告每条模拟指令和每帧的开销，可选按操作码类别 (最高4位) 细分。
+// 计数器不可用时 (非Linux、权限不足、虚拟机没有PMU) 只统计主机时间
+
+typedef enum {
+    PERF_CYCLES = 0,           // 主机时钟周期
+    PERF_INSTRUCTIONS,         // 主机指令数
+    PERF_BRANCH_MISSES,        // 分支预测失败
+    PERF_L1D_MISSES,           // L1数据缓存读缺失
+    PERF_COUNTER_COUNT
+} PerfCounter;
+
+typedef enum {
+    PERF_REGION_CPU = 0,       // 成批执行 chip8_cycle
+    PERF_REGION_GRAPHICS,      // chip8_graphics_update
+    PERF_REGION_COUNT
+} PerfRegion;
+
+#define PERF_OPCODE_FAMILIES 16
+
+// 一个区域的累计值
+typedef struct {
+    uint64_t counters[PERF_COUNTER_COUNT];
+    uint64_t time_ns;          // 主机时间
+    uint64_t calls;            // 测量次数
+    uint64_t instructions;     // 期间执行的模拟指令数
+} PerfTotals;
+
+typedef struct {
+    int enabled;
+    int opcodes;               // 按操作码类别逐条测量
+    int fd[PERF_COUNTER_COUNT];  // 计数器描述符 (-1=不可用)，fd[0] 为组长
+    int index[PERF_COUNTER_COUNT];  // 计数器在组读取结果中的位置
+    int group_fd;              // 组长描述符 (-1=全部不可用，只统计时间)
+    int group_size;
+    
+    // 正在进行的测量的起点
+    uint64_t start[PERF_COUNTER_COUNT];
+    uint64_t start_enabled;
+    uint64_t start_running;
+    uint64_t start_time;
+    
+    PerfTotals regions[PERF_REGION_COUNT];
+    PerfTotals families[PERF_OPCODE_FAMILIES];
+    uint64_t overhead[PERF_COUNTER_COUNT];  // 一次空测量的计数 (逐条测量时扣除)
+    uint64_t overhead_ns;
+    uint64_t frames;           // 模拟的60Hz帧数
+} Chip8Perf;
+
+// 打开计数器。opcodes=1 时逐条测量并按操作码类别统计 (开销很大，结果会偏高)
+int chip8_perf_init(Chip8Perf* perf, int opcodes);
+void chip8_perf_cleanup(Chip8Perf* perf);
+
+// 测量一个区域，instructions 为期间执行的模拟指令数 (画面刷新传0)
+void chip8_perf_begin(Chip8Perf* perf);
+void chip8_perf_end(Chip8Perf* perf, PerfRegion region, uint64_t instructions);
+
+// 执行一条指令 (opcodes 模式下单独测量并计入操作码类别)
+void chip8_perf_cycle(Chip8Perf* perf, Chip8* chip8);
+
+// 完成一个60Hz帧
+void chip8_perf_frame(Chip8Perf* perf);
+
+void chip8_perf_report(const Chip8Perf* perf, FILE* out);
+
+#endif // CHIP8_PERF_H
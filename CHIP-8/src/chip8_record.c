@@ -0,0 +1,225 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "chip8_record.h"
+#include "chip8_metrics.h"
+
+// 写入小端整数
+static void write_u32(FILE* file, uint32_t value) {
+    uint8_t b[4] = { value & 0xFF, (value >> 8) & 0xFF, (value >> 16) & 0xFF, (value >> 24) & 0xFF };
+    fwrite(b, 1, 4, file);
+}
+
+static void write_u16(FILE* file, uint16_t value) {
+    uint8_t b[2] = { value & 0xFF, (value >> 8) & 0xFF };
+    fwrite(b, 1, 2, file);
+}
+
+// 写入WAV头部 (数据大小在停止录制时回填)
+static void write_wav_header(FILE* file, uint32_t samples) {
+    uint32_t data_size = samples * sizeof(int16_t);
+    
+    fwrite("RIFF", 1, 4, file);
+    write_u32(file, 36 + data_size);
+    fwrite("WAVEfmt ", 1, 8, file);
+    write_u32(file, 16);                                  // fmt块大小
+    write_u16(file, 1);                                   // PCM
+    write_u16(file, 1);                                   // 单声道
+    write_u32(file, AUDIO_FREQUENCY);
+    write_u32(file, AUDIO_FREQUENCY * sizeof(int16_t));   // 字节率
+    write_u16(file, sizeof(int16_t));                     // 块对齐
+    write_u16(file, 16);                                  // 位深
+    fwrite("data", 1, 4, file);
+    write_u32(file, data_size);
+}
+
+// 将一行打包像素按缩放倍数展开 (Y4M为亮度，RGB为3字节/像素)
+static void scale_row(const Chip8Recorder* rec, const uint8_t* packed_row, uint8_t* out) {
+    const int bytes_per_pixel = (rec->format == RECORD_FORMAT_RGB) ? 3 : 1;
+    const int run = rec->scale * bytes_per_pixel;
+    
+    for (int x = 0; x < DISPLAY_WIDTH; x++) {
+        uint8_t value = (packed_row[x >> 3] & (0x80 >> (x & 7))) ? 255 : 0;
+        memset(out + x * run, value, run);
+    }
+}
+
+// 写入一帧视频
+static void write_video_frame(Chip8Recorder* rec, const RecordFrame* frame) {
+    const int row_bytes = rec->width * ((rec->format == RECORD_FORMAT_RGB) ? 3 : 1);
+    
+    if (rec->format == RECORD_FORMAT_Y4M) {
+        fwrite("FRAME\n", 1, 6, rec->video);
+    }
+    
+    // 每个模拟器行只缩放一次，然后重复写入 scale 次
+    for (int y = 0; y < DISPLAY_HEIGHT; y++) {
+        scale_row(rec, &frame->display[y * (DISPLAY_WIDTH / 8)], rec->row);
+        for (int i = 0; i < rec->scale; i++) {
+            fwrite(rec->row, 1, row_bytes, rec->video);
+        }
+    }
+    
+    // Y4M色度平面：灰度图像的U/V恒为128
+    if (rec->format == RECORD_FORMAT_Y4M) {
+        int chroma_size = (rec->width / 2) * (rec->height / 2);
+        memset(rec->row, 128, rec->width);
+        for (int written = 0; written < chroma_size * 2; written += rec->width / 2) {
+            fwrite(rec->row, 1, rec->width / 2, rec->video);
+        }
+    }
+}
+
+// 写入一帧音频 (与视频帧严格对齐的蜂鸣声)
+static void write_audio_frame(Chip8Recorder* rec, const RecordFrame* frame) {
+    if (!rec->audio) return;
+    
+    if (frame->beep) {
+        rec->voice.tone = frame->tone;
+        chip8_voice_render(&rec->voice, rec->pcm, RECORD_SAMPLES_PER_FRAME);
+    } else {
+        memset(rec->pcm, 0, sizeof(rec->pcm));
+    }
+    
+    fwrite(rec->pcm, sizeof(int16_t), RECORD_SAMPLES_PER_FRAME, rec->audio);
+    rec->audio_samples += RECORD_SAMPLES_PER_FRAME;
+}
+
+// 写入线程：取出队列中的帧并编码写盘
+static int record_thread(void* data) {
+    Chip8Recorder* rec = (Chip8Recorder*)data;
+    
+    for (;;) {
+        SDL_SemWait(rec->pending);
+        
+        int tail = SDL_AtomicGet(&rec->tail);
+        if (tail == SDL_AtomicGet(&rec->head)) {
+            // 队列已空，只有停止录制时才会被唤醒到这里
+            if (!SDL_AtomicGet(&rec->running)) break;
+            continue;
+        }
+        
+        const RecordFrame* frame = &rec->queue[tail & (RECORD_QUEUE_SIZE - 1)];
+        write_video_frame(rec, frame);
+        write_audio_frame(rec, frame);
+        rec->frames_written++;
+        
+        SDL_AtomicSet(&rec->tail, tail + 1);
+    }
+    
+    return 0;
+}
+
+// 根据视频文件名生成音频文件名
+static void make_audio_path(const char* path, char* out, size_t size) {
+    snprintf(out, size, "%s", path);
+    char* dot = strrchr(out, '.');
+    char* slash = strrchr(out, '/');
+    char* backslash = strrchr(out, '\\');
+    if (dot && dot > (slash ? slash : out) && dot > (backslash ? backslash : out)) {
+        *dot = '\0';
+    }
+    strncat(out, ".wav", size - strlen(out) - 1);
+}
+
+// 开始录制
+int chip8_record_start(Chip8Recorder* rec, const char* path, int scale) {
+    if (!rec || !path) return 0;
+    
+    memset(rec, 0, sizeof(*rec));
+    if (scale < 1) scale = 1;
+    if (scale > RECORD_MAX_SCALE) scale = RECORD_MAX_SCALE;
+    
+    const char* dot = strrchr(path, '.');
+    rec->format = (dot && strcasecmp(dot, ".y4m") == 0) ? RECORD_FORMAT_Y4M : RECORD_FORMAT_RGB;
+    rec->scale = scale;
+    rec->width = DISPLAY_WIDTH * scale;
+    rec->height = DISPLAY_HEIGHT * scale;
+    
+    rec->video = fopen(path, "wb");
+    if (!rec->video) {
+        fprintf(stderr, "错误: 无法创建录制文件: %s\n", path);
+        return 0;
+    }
+    
+    char audio_path[512];
+    make_audio_path(path, audio_path, sizeof(audio_path));
+    rec->audio = fopen(audio_path, "wb");
+    if (rec->audio) {
+        write_wav_header(rec->audio, 0);
+    } else {
+        fprintf(stderr, "警告: 无法创建音频文件: %s，只录制视频\n", audio_path);
+    }
+    
+    if (rec->format == RECORD_FORMAT_Y4M) {
+        fprintf(rec->video, "YUV4MPEG2 W%d H%d F%d:1 Ip A1:1 C420jpeg\n", rec->width, rec->height, RECORD_FPS);
+    }
+    
+    chip8_voice_init(&rec->voice);
+    rec->row = (uint8_t*)malloc((size_t)rec->width * 3);
+    rec->pending = SDL_CreateSemaphore(0);
+    SDL_AtomicSet(&rec->running, 1);
+    rec->thread = rec->row && rec->pending ? SDL_CreateThread(record_thread, "chip8_record", rec) : NULL;
+    if (!rec->thread) {
+        fprintf(stderr, "错误: 无法创建录制线程: %s\n", SDL_GetError());
+        fclose(rec->video);
+        if (rec->audio) fclose(rec->audio);
+        if (rec->pending) SDL_DestroySemaphore(rec->pending);
+        free(rec->row);
+        memset(rec, 0, sizeof(*rec));
+        return 0;
+    }
+    
+    printf("开始录制: %s (%s, %dx%d)", path, rec->format == RECORD_FORMAT_Y4M ? "Y4M" : "RGB24",
+           rec->width, rec->height);
+    if (rec->audio) printf(", 音频: %s", audio_path);
+    printf("\n");
+    return 1;
+}
+
+// 提交一帧：只复制256字节的打包显示，不做任何I/O
+void chip8_record_push(Chip8Recorder* rec, const Chip8* chip8) {
+    if (!rec || !rec->thread) return;
+    
+    int head = SDL_AtomicGet(&rec->head);
+    rec->frames_pushed++;
+    
+    if (head - SDL_AtomicGet(&rec->tail) >= RECORD_QUEUE_SIZE) {
+        rec->frames_dropped++;
+        metrics_add(METRICS_THREAD_MAIN, METRIC_RECORD_DROPPED_FRAMES, 1);
+        return;
+    }
+    
+    RecordFrame* frame = &rec->queue[head & (RECORD_QUEUE_SIZE - 1)];
+    chip8_pack_display(chip8, frame->display);
+    frame->beep = chip8->sound_timer > 0;
+    frame->tone = chip8->tone;
+    
+    SDL_AtomicSet(&rec->head, head + 1);
+    SDL_SemPost(rec->pending);
+}
+
+// 停止录制：等待写入线程处理完队列中剩余的帧
+void chip8_record_stop(Chip8Recorder* rec) {
+    if (!rec || !rec->thread) return;
+    
+    SDL_AtomicSet(&rec->running, 0);
+    SDL_SemPost(rec->pending);
+    SDL_WaitThread(rec->thread, NULL);
+    rec->thread = NULL;
+    
+    fclose(rec->video);
+    if (rec->audio) {
+        // 回填WAV头部的数据大小
+        fseek(rec->audio, 0, SEEK_SET);
+        write_wav_header(rec->audio, rec->audio_samples);
+        fclose(rec->audio);
+    }
+    SDL_DestroySemaphore(rec->pending);
+    free(rec->row);
+    rec->row = NULL;
+    
+    printf("录制结束: 写入 %llu 帧, 丢弃 %llu 帧 (共提交 %llu 帧)\n",
+           (unsigned long long)rec->frames_written, (unsigned long long)rec->frames_dropped,
+           (unsigned long long)rec->frames_pushed);
+}
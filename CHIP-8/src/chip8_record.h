@@ -0,0 +1,59 @@
+#ifndef CHIP8_RECORD_H
+#define CHIP8_RECORD_H
+
+#include <stdio.h>
+#include "chip8.h"
+
+// 后台录制：主循环只把打包帧放入有界队列，
+// 缩放、编码和磁盘写入全部在独立的写入线程中完成
+
+#define RECORD_QUEUE_SIZE 128          // 队列容量 (帧)，必须是2的幂
+#define RECORD_DEFAULT_SCALE 4         // 默认缩放倍数
+#define RECORD_MAX_SCALE 16            // 最大缩放倍数
+#define RECORD_FPS 60                  // 录制帧率
+#define RECORD_SAMPLES_PER_FRAME (AUDIO_FREQUENCY / RECORD_FPS)  // 每帧音频采样数
+
+// 视频格式
+typedef enum {
+    RECORD_FORMAT_Y4M = 0,             // YUV4MPEG2 (C420jpeg)
+    RECORD_FORMAT_RGB = 1              // 原始RGB24
+} RecordFormat;
+
+// 队列中的一帧
+typedef struct {
+    uint8_t display[DISPLAY_PACKED_SIZE];  // 打包显示
+    uint8_t beep;                          // 本帧是否在蜂鸣
+    Chip8Tone tone;                        // 本帧的XO-CHIP图样和音高
+} RecordFrame;
+
+// 录制器
+typedef struct {
+    FILE* video;
+    FILE* audio;
+    RecordFormat format;
+    int scale;
+    int width, height;                 // 输出尺寸
+    
+    RecordFrame queue[RECORD_QUEUE_SIZE];  // 单生产者单消费者环形队列
+    SDL_atomic_t head;                 // 生产者写入位置 (主线程)
+    SDL_atomic_t tail;                 // 消费者读取位置 (写入线程)
+    SDL_atomic_t running;
+    SDL_sem* pending;                  // 队列中待处理的帧数
+    SDL_Thread* thread;
+    
+    uint64_t frames_pushed;            // 主线程提交的帧数
+    uint64_t frames_dropped;           // 队列满时丢弃的帧数
+    uint64_t frames_written;           // 写入线程完成的帧数
+    uint32_t audio_samples;            // 已写入的音频采样数
+    Chip8Voice voice;                  // 合成器 (写入线程使用)
+    uint8_t* row;                      // 缩放后的一行 (写入线程使用)
+    int16_t pcm[RECORD_SAMPLES_PER_FRAME];
+} Chip8Recorder;
+
+// path 后缀为 .y4m 时输出Y4M，否则输出原始RGB；音频写入同名 .wav 文件
+int chip8_record_start(Chip8Recorder* rec, const char* path, int scale);
+// 提交一帧 (主线程调用，永不阻塞；队列满时丢帧并计数)
+void chip8_record_push(Chip8Recorder* rec, const Chip8* chip8);
+void chip8_record_stop(Chip8Recorder* rec);
+
+#endif // CHIP8_RECORD_H
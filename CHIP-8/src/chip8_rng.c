@@ -0,0 +1,191 @@
+#include <string.h>
+#include <time.h>
+#include <SDL2/SDL.h>
+#include "chip8_rng.h"
+
+#if defined(__SSE2__)
+#define RNG_SSE2 1
+#include <emmintrin.h>
+#endif
+
+// Philox4x32 常数 (Salmon et al., "Parallel Random Numbers: As Easy as 1, 2, 3")
+#define PHILOX_M0 0xD2511F53u
+#define PHILOX_M1 0xCD9E8D57u
+#define PHILOX_W0 0x9E3779B9u
+#define PHILOX_W1 0xBB67AE85u
+#define PHILOX_ROUNDS 10
+
+#define PREFETCH_CHUNK 64              // 预取时每次收集的实例数
+
+static const char* RNG_NAMES[CHIP8_RNG_COUNT] = { "philox", "lcg" };
+
+const char* chip8_rng_name(Chip8RngKind kind) {
+    if ((int)kind < 0 || kind >= CHIP8_RNG_COUNT) return "?";
+    return RNG_NAMES[kind];
+}
+
+int chip8_rng_from_name(const char* name) {
+    for (int i = 0; i < CHIP8_RNG_COUNT; i++) {
+        if (strcasecmp(name, RNG_NAMES[i]) == 0) return i;
+    }
+    return -1;
+}
+
+void chip8_rng_init(Chip8Rng* rng, Chip8RngKind kind, uint32_t seed, uint32_t instance) {
+    memset(rng, 0, sizeof(*rng));
+    rng->kind = kind;
+    rng->seed = seed;
+    rng->instance = instance;
+    rng->lcg = seed;
+    rng->block_index = UINT64_MAX;
+}
+
+// ============ Philox4x32-10 ============
+
+void chip8_philox4x32(const uint32_t counter[4], const uint32_t key[2], uint32_t out[4]) {
+    uint32_t c0 = counter[0], c1 = counter[1], c2 = counter[2], c3 = counter[3];
+    uint32_t k0 = key[0], k1 = key[1];
+    
+    for (int round = 0; round < PHILOX_ROUNDS; round++) {
+        uint64_t p0 = (uint64_t)PHILOX_M0 * c0;
+        uint64_t p1 = (uint64_t)PHILOX_M1 * c2;
+        uint32_t n0 = (uint32_t)(p1 >> 32) ^ c1 ^ k0;
+        uint32_t n2 = (uint32_t)(p0 >> 32) ^ c3 ^ k1;
+        c1 = (uint32_t)p1;
+        c3 = (uint32_t)p0;
+        c0 = n0;
+        c2 = n2;
+        k0 += PHILOX_W0;
+        k1 += PHILOX_W1;
+    }
+    
+    out[0] = c0;
+    out[1] = c1;
+    out[2] = c2;
+    out[3] = c3;
+}
+
+#ifdef RNG_SSE2
+// 4个通道的32x32→64位乘法，分别返回高32位和低32位
+static inline void mulhilo_sse2(__m128i a, __m128i m, __m128i* hi, __m128i* lo) {
+    __m128i even = _mm_mul_epu32(a, m);                     // 通道0、2
+    __m128i odd = _mm_mul_epu32(_mm_srli_epi64(a, 32), m);  // 通道1、3
+    *lo = _mm_unpacklo_epi32(_mm_shuffle_epi32(even, _MM_SHUFFLE(0, 0, 2, 0)),
+                             _mm_shuffle_epi32(odd, _MM_SHUFFLE(0, 0, 2, 0)));
+    *hi = _mm_unpacklo_epi32(_mm_shuffle_epi32(even, _MM_SHUFFLE(0, 0, 3, 1)),
+                             _mm_shuffle_epi32(odd, _MM_SHUFFLE(0, 0, 3, 1)));
+}
+
+// 4个实例一组：每个寄存器存放4个实例的同一个字
+static void philox_batch4_sse2(const uint32_t* key0, const uint32_t* key1, const uint64_t* block,
+                               uint32_t* out, int count) {
+    const __m128i m0 = _mm_set1_epi32((int)PHILOX_M0);
+    const __m128i m1 = _mm_set1_epi32((int)PHILOX_M1);
+    const __m128i w0 = _mm_set1_epi32((int)PHILOX_W0);
+    const __m128i w1 = _mm_set1_epi32((int)PHILOX_W1);
+    
+    __m128i c0 = _mm_setr_epi32((int)(uint32_t)block[0], (int)(uint32_t)block[1],
+                                (int)(uint32_t)block[2], (int)(uint32_t)block[3]);
+    __m128i c1 = _mm_setr_epi32((int)(uint32_t)(block[0] >> 32), (int)(uint32_t)(block[1] >> 32),
+                                (int)(uint32_t)(block[2] >> 32), (int)(uint32_t)(block[3] >> 32));
+    __m128i c2 = _mm_setzero_si128();
+    __m128i c3 = _mm_setzero_si128();
+    __m128i k0 = _mm_loadu_si128((const __m128i*)key0);
+    __m128i k1 = _mm_loadu_si128((const __m128i*)key1);
+    
+    for (int round = 0; round < PHILOX_ROUNDS; round++) {
+        __m128i hi0, lo0, hi1, lo1;
+        mulhilo_sse2(c0, m0, &hi0, &lo0);
+        mulhilo_sse2(c2, m1, &hi1, &lo1);
+        c0 = _mm_xor_si128(_mm_xor_si128(hi1, c1), k0);
+        c2 = _mm_xor_si128(_mm_xor_si128(hi0, c3), k1);
+        c1 = lo1;
+        c3 = lo0;
+        k0 = _mm_add_epi32(k0, w0);
+        k1 = _mm_add_epi32(k1, w1);
+    }
+    
+    _mm_storeu_si128((__m128i*)(out + 0 * count), c0);
+    _mm_storeu_si128((__m128i*)(out + 1 * count), c1);
+    _mm_storeu_si128((__m128i*)(out + 2 * count), c2);
+    _mm_storeu_si128((__m128i*)(out + 3 * count), c3);
+}
+#endif
+
+void chip8_philox4x32_batch(const uint32_t* key0, const uint32_t* key1, const uint64_t* block,
+                            uint32_t* out, int count) {
+    int i = 0;
+#ifdef RNG_SSE2
+    for (; i + 4 <= count; i += 4) {
+        philox_batch4_sse2(key0 + i, key1 + i, block + i, out + i, count);
+    }
+#endif
+    for (; i < count; i++) {
+        uint32_t counter[4] = { (uint32_t)block[i], (uint32_t)(block[i] >> 32), 0, 0 };
+        uint32_t key[2] = { key0[i], key1[i] };
+        uint32_t words[4];
+        chip8_philox4x32(counter, key, words);
+        for (int k = 0; k < 4; k++) out[k * count + i] = words[k];
+    }
+}
+
+// ============ 取数 ============
+
+uint32_t chip8_rng_next(Chip8Rng* rng) {
+    if (rng->kind == CHIP8_RNG_LCG) {
+        rng->lcg = (rng->lcg * 1103515245 + 12345) % 0x7FFFFFFF;
+        rng->counter++;
+        return rng->lcg;
+    }
+    
+    uint64_t index = rng->counter >> 2;
+    if (rng->block_index != index) {
+        uint32_t counter[4] = { (uint32_t)index, (uint32_t)(index >> 32), 0, 0 };
+        uint32_t key[2] = { rng->seed, rng->instance };
+        chip8_philox4x32(counter, key, rng->block);
+        rng->block_index = index;
+    }
+    return rng->block[rng->counter++ & 3];
+}
+
+void chip8_rng_prefetch(Chip8Rng* first, size_t stride, int count) {
+    uint32_t key0[PREFETCH_CHUNK], key1[PREFETCH_CHUNK];
+    uint64_t block[PREFETCH_CHUNK];
+    uint32_t out[4 * PREFETCH_CHUNK];
+    Chip8Rng* pending[PREFETCH_CHUNK];
+    int n = 0;
+    
+    for (int i = 0; i <= count; i++) {
+        // 收集下一个分组尚未缓存的Philox生成器，攒满一批 (或到末尾) 时一起计算
+        if (i < count) {
+            Chip8Rng* rng = (Chip8Rng*)((uint8_t*)first + (size_t)i * stride);
+            if (rng->kind != CHIP8_RNG_PHILOX || rng->block_index == rng->counter >> 2) continue;
+            pending[n] = rng;
+            key0[n] = rng->seed;
+            key1[n] = rng->instance;
+            block[n] = rng->counter >> 2;
+            n++;
+            if (n < PREFETCH_CHUNK) continue;
+        }
+        if (n == 0) continue;
+        
+        chip8_philox4x32_batch(key0, key1, block, out, n);
+        for (int j = 0; j < n; j++) {
+            for (int k = 0; k < 4; k++) pending[j]->block[k] = out[k * n + j];
+            pending[j]->block_index = block[j];
+        }
+        n = 0;
+    }
+}
+
+// SplitMix64 的最终混合步骤
+static uint64_t mix64(uint64_t z) {
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    return z ^ (z >> 31);
+}
+
+uint32_t chip8_rng_entropy(void) {
+    uint64_t z = mix64((uint64_t)time(NULL) ^ (SDL_GetPerformanceCounter() << 1));
+    return (uint32_t)(z ^ (z >> 32));
+}
@@ -0,0 +1,54 @@
+#ifndef CHIP8_RNG_H
+#define CHIP8_RNG_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+// CXNN的随机数生成器。默认使用基于计数器的 Philox4x32-10：
+// 第 n 个随机数只由 (运行种子, 实例号, n) 决定，没有共享状态，
+// 同一运行种子下不同实例号的序列相互独立，大量并行实例的结果可以复现。
+// 每个分组 (128位计数器) 产生4个32位随机数，批量实例可以按SIMD通道一起计算。
+// 旧的线性同余生成器保留为 "lcg"，用于复现以前的运行结果
+
+typedef enum {
+    CHIP8_RNG_PHILOX = 0,
+    CHIP8_RNG_LCG,
+    CHIP8_RNG_COUNT
+} Chip8RngKind;
+
+// 生成器状态 (属于机器状态)
+typedef struct {
+    uint32_t kind;             // Chip8RngKind
+    uint32_t seed;             // 运行种子 (Philox密钥的低32位)
+    uint32_t instance;         // 实例号 (Philox密钥的高32位)
+    uint32_t lcg;              // LCG状态
+    uint64_t counter;          // 已取出的随机数个数
+    uint64_t block_index;      // block 缓存的分组号 (UINT64_MAX=无效)
+    uint32_t block[4];         // 分组 counter/4 的Philox输出
+} Chip8Rng;
+
+const char* chip8_rng_name(Chip8RngKind kind);
+int chip8_rng_from_name(const char* name);  // 未知名称返回-1
+
+// 按 (种子, 实例号) 从头开始一个序列
+void chip8_rng_init(Chip8Rng* rng, Chip8RngKind kind, uint32_t seed, uint32_t instance);
+
+// 取出下一个32位随机数 (LCG只有低31位)
+uint32_t chip8_rng_next(Chip8Rng* rng);
+
+// 未指定种子时使用：混合当前时间和高精度计数器，同一秒内启动的进程也会得到不同的种子
+uint32_t chip8_rng_entropy(void);
+
+// Philox4x32-10：counter 为128位计数器 (4个32位字)，key 为64位密钥，out 为4个32位输出
+void chip8_philox4x32(const uint32_t counter[4], const uint32_t key[2], uint32_t out[4]);
+
+// 批量计算 count 个 (密钥, 分组号) 的Philox输出，结构数组布局：
+// out[k * count + i] 为第 i 个实例的第 k 个字。x86上每次按4个SSE2通道计算
+void chip8_philox4x32_batch(const uint32_t* key0, const uint32_t* key1, const uint64_t* block,
+                            uint32_t* out, int count);
+
+// 批量实例：为 count 个生成器预先算好下一个分组 (rng 之间相隔 stride 字节，
+// 例如 &cores[0].rng 和 sizeof(Chip8))，之后的CXNN直接使用缓存
+void chip8_rng_prefetch(Chip8Rng* first, size_t stride, int count);
+
+#endif // CHIP8_RNG_H
@@ -0,0 +1,689 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <time.h>
+#include <SDL2/SDL.h>
+#include "chip8_romlib.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <dirent.h>
+#include <sys/stat.h>
+#endif
+
+#define SCAN_MAX_DEPTH 16
+#define SCAN_MAX_THREADS 16
+
+static const char* PLATFORM_NAMES[ROM_PLATFORM_COUNT] = { "chip8", "schip", "xochip" };
+
+// 各平台推荐的兼容性配置
+static const uint8_t PLATFORM_QUIRKS[ROM_PLATFORM_COUNT] = {
+    QUIRK_VF_RESET | QUIRK_MEMORY_INC_I | QUIRK_DISPLAY_WAIT | QUIRK_CLIPPING,
+    QUIRK_CLIPPING | QUIRK_SHIFT_VX | QUIRK_JUMP_VX,
+    QUIRK_MEMORY_INC_I
+};
+
+// 扫描过程中的一个文件
+typedef struct {
+    char* path;
+    uint64_t size;
+    int64_t mtime;
+    RomEntry entry;
+    int ok;
+} ScanItem;
+
+typedef struct {
+    ScanItem* items;
+    int count;
+    int capacity;
+} ScanList;
+
+// 并行哈希的任务队列
+typedef struct {
+    ScanItem** jobs;
+    int job_count;
+    SDL_atomic_t next;
+} ScanJobs;
+
+const char* chip8_romlib_platform_name(int platform) {
+    if (platform < 0 || platform >= ROM_PLATFORM_COUNT) return "unknown";
+    return PLATFORM_NAMES[platform];
+}
+
+int chip8_romlib_platform_from_name(const char* name) {
+    for (int i = 0; i < ROM_PLATFORM_COUNT; i++) {
+        if (strcmp(name, PLATFORM_NAMES[i]) == 0) return i;
+    }
+    return -1;
+}
+
+uint8_t chip8_romlib_platform_quirks(int platform) {
+    if (platform < 0 || platform >= ROM_PLATFORM_COUNT) return CHIP8_QUIRKS_DEFAULT;
+    return PLATFORM_QUIRKS[platform];
+}
+
+// 取路径中的文件名部分
+static const char* path_basename(const char* path) {
+    const char* base = path;
+    for (const char* p = path; *p; p++) {
+        if (*p == '/' || *p == '\\') base = p + 1;
+    }
+    return base;
+}
+
+// 是否为支持的ROM扩展名 (.ch8/.sc8/.xo8，不区分大小写)
+static int is_rom_file(const char* name) {
+    const char* dot = strrchr(name, '.');
+    if (!dot || dot == name) return 0;
+    return strcasecmp(dot, ".ch8") == 0 || strcasecmp(dot, ".sc8") == 0 || strcasecmp(dot, ".xo8") == 0;
+}
+
+// ---------------------------------------------------------------
+// 静态分析：从0x200开始沿控制流遍历可达指令，
+// 只根据可达代码判断平台，避免把精灵数据误认为扩展指令
+// ---------------------------------------------------------------
+
+void chip8_romlib_analyze(const uint8_t* rom, size_t size, RomEntry* entry) {
+    uint32_t end = PROGRAM_START + (uint32_t)(size < 0x10000 - PROGRAM_START ? size : 0x10000 - PROGRAM_START);
+    uint8_t* visited = (uint8_t*)calloc(0x10000 / 8, 1);
+    uint16_t* stack = (uint16_t*)malloc(0x10000 * sizeof(uint16_t));
+    int schip_ops = 0, xo_ops = 0;
+    uint32_t instructions = 0, sprites = 0;
+    uint8_t flags = 0;
+    int top = 0;
+    
+    if (!visited || !stack) {
+        free(visited);
+        free(stack);
+        return;
+    }
+
+#define PUSH(a) do { \
+        uint32_t a_ = (a); \
+        if (a_ >= PROGRAM_START && a_ + 1 < end && !(visited[a_ >> 3] & (1 << (a_ & 7)))) { \
+            visited[a_ >> 3] |= (uint8_t)(1 << (a_ & 7)); \
+            stack[top++] = (uint16_t)a_; \
+        } \
+    } while (0)
+    
+    PUSH(PROGRAM_START);
+    while (top > 0) {
+        uint32_t addr = stack[--top];
+        const uint8_t* p = &rom[addr - PROGRAM_START];
+        uint16_t opcode = (uint16_t)((p[0] << 8) | p[1]);
+        uint16_t nnn = opcode & 0x0FFF;
+        uint8_t nn = opcode & 0x00FF;
+        uint32_t next = addr + 2;
+        instructions++;
+        
+        // 跳过指令时，XO-CHIP的 F000 NNNN 占4字节
+        uint32_t skip = next + 2;
+        if (next + 1 < end && rom[next - PROGRAM_START] == 0xF0 && rom[next + 1 - PROGRAM_START] == 0x00) {
+            skip = next + 4;
+        }
+        
+        switch (opcode & 0xF000) {
+            case 0x0000:
+                if (opcode == 0x00EE) continue;                    // 返回
+                if (opcode == 0x00FD) { schip_ops++; continue; }   // 退出
+                if ((opcode & 0xFFF0) == 0x00C0 || opcode == 0x00FB || opcode == 0x00FC ||
+                    opcode == 0x00FE || opcode == 0x00FF) {
+                    schip_ops++;
+                } else if ((opcode & 0xFFF0) == 0x00D0) {
+                    xo_ops++;
+                }
+                PUSH(next);
+                break;
+            case 0x1000:
+                if (nnn != addr) PUSH(nnn);                        // 自跳转为空闲循环
+                break;
+            case 0x2000:
+                PUSH(nnn);
+                PUSH(next);
+                break;
+            case 0x3000:
+            case 0x4000:
+            case 0x9000:
+                PUSH(next);
+                PUSH(skip);
+                break;
+            case 0x5000:
+                if ((opcode & 0xF) == 2 || (opcode & 0xF) == 3) {
+                    xo_ops++;
+                    PUSH(next);
+                } else {
+                    PUSH(next);
+                    PUSH(skip);
+                }
+                break;
+            case 0xB000:
+                flags |= ROM_INDIRECT_JUMP;                        // 目标取决于运行时寄存器
+                break;
+            case 0xC000:
+                flags |= ROM_USES_RANDOM;
+                PUSH(next);
+                break;
+            case 0xD000:
+                sprites++;
+                if ((opcode & 0xF) == 0) schip_ops++;
+                PUSH(next);
+                break;
+            case 0xE000:
+                if (nn == 0x9E || nn == 0xA1) flags |= ROM_USES_KEYS;
+                PUSH(next);
+                PUSH(skip);
+                break;
+            case 0xF000:
+                if (opcode == 0xF000) {                            // I = NNNN (4字节)
+                    xo_ops++;
+                    PUSH(addr + 4);
+                    break;
+                }
+                if (opcode == 0xF002 || nn == 0x01 || nn == 0x3A) xo_ops++;
+                if (nn == 0x30 || nn == 0x75 || nn == 0x85) schip_ops++;
+                if (nn == 0x0A) flags |= ROM_WAITS_KEY;
+                if (nn == 0x18) flags |= ROM_USES_SOUND;
+                PUSH(next);
+                break;
+            default:
+                PUSH(next);
+                break;
+        }
+    }
+#undef PUSH
+    
+    free(visited);
+    free(stack);
+    
+    int platform = ROM_PLATFORM_CHIP8;
+    if (xo_ops > 0 || size > MEMORY_SIZE - PROGRAM_START) {
+        platform = ROM_PLATFORM_XOCHIP;
+    } else if (schip_ops > 0) {
+        platform = ROM_PLATFORM_SCHIP;
+    }
+    
+    entry->platform = (uint8_t)platform;
+    entry->quirks = PLATFORM_QUIRKS[platform];
+    entry->flags = flags;
+    entry->instructions = (uint16_t)(instructions > 0xFFFF ? 0xFFFF : instructions);
+    entry->sprites = (uint16_t)(sprites > 0xFFFF ? 0xFFFF : sprites);
+}
+
+// ---------------------------------------------------------------
+// 目录遍历
+// ---------------------------------------------------------------
+
+static int compare_items(const void* a, const void* b);
+
+static int scan_list_add(ScanList* list, const char* path, uint64_t size, int64_t mtime) {
+    if (list->count == list->capacity) {
+        int capacity = list->capacity ? list->capacity * 2 : 256;
+        ScanItem* items = (ScanItem*)realloc(list->items, capacity * sizeof(ScanItem));
+        if (!items) return 0;
+        list->items = items;
+        list->capacity = capacity;
+    }
+    
+    ScanItem* item = &list->items[list->count];
+    memset(item, 0, sizeof(*item));
+    item->path = strdup(path);
+    if (!item->path) return 0;
+    item->size = size;
+    item->mtime = mtime;
+    list->count++;
+    return 1;
+}
+
+#ifdef _WIN32
+
+static void walk_dir(const char* dir, ScanList* list, int depth) {
+    char pattern[1024];
+    snprintf(pattern, sizeof(pattern), "%s\\*", dir);
+    
+    WIN32_FIND_DATAA fd;
+    HANDLE find = FindFirstFileA(pattern, &fd);
+    if (find == INVALID_HANDLE_VALUE) {
+        if (depth == 0) fprintf(stderr, "警告: 无法打开目录: %s\n", dir);
+        return;
+    }
+    
+    do {
+        if (strcmp(fd.cFileName, ".") == 0 || strcmp(fd.cFileName, "..") == 0) continue;
+        
+        char path[1024];
+        snprintf(path, sizeof(path), "%s\\%s", dir, fd.cFileName);
+        
+        if (fd.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY) {
+            if (depth < SCAN_MAX_DEPTH) walk_dir(path, list, depth + 1);
+        } else if (is_rom_file(fd.cFileName)) {
+            uint64_t size = ((uint64_t)fd.nFileSizeHigh << 32) | fd.nFileSizeLow;
+            int64_t mtime = (int64_t)(((uint64_t)fd.ftLastWriteTime.dwHighDateTime << 32) |
+                                      fd.ftLastWriteTime.dwLowDateTime);
+            scan_list_add(list, path, size, mtime);
+        }
+    } while (FindNextFileA(find, &fd));
+    
+    FindClose(find);
+}
+
+#else
+
+static void walk_dir(const char* dir, ScanList* list, int depth) {
+    DIR* d = opendir(dir);
+    if (!d) {
+        if (depth == 0) fprintf(stderr, "警告: 无法打开目录: %s\n", dir);
+        return;
+    }
+    
+    struct dirent* ent;
+    while ((ent = readdir(d)) != NULL) {
+        if (strcmp(ent->d_name, ".") == 0 || strcmp(ent->d_name, "..") == 0) continue;
+        
+        char path[1024];
+        snprintf(path, sizeof(path), "%s/%s", dir, ent->d_name);
+        
+        struct stat st;
+        if (stat(path, &st) != 0) continue;
+        
+        if (S_ISDIR(st.st_mode)) {
+            if (depth < SCAN_MAX_DEPTH) walk_dir(path, list, depth + 1);
+        } else if (S_ISREG(st.st_mode) && is_rom_file(ent->d_name)) {
+            scan_list_add(list, path, (uint64_t)st.st_size, (int64_t)st.st_mtime);
+        }
+    }
+    
+    closedir(d);
+}
+
+#endif
+
+// 目录或直接给出的ROM文件 (大小和修改时间与 walk_dir 的取法一致，增量扫描才能沿用旧条目)
+static void walk_root(const char* path, ScanList* list) {
+#ifdef _WIN32
+    WIN32_FILE_ATTRIBUTE_DATA data;
+    if (GetFileAttributesExA(path, GetFileExInfoStandard, &data) &&
+        !(data.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY)) {
+        uint64_t size = ((uint64_t)data.nFileSizeHigh << 32) | data.nFileSizeLow;
+        int64_t mtime = (int64_t)(((uint64_t)data.ftLastWriteTime.dwHighDateTime << 32) |
+                                  data.ftLastWriteTime.dwLowDateTime);
+        scan_list_add(list, path, size, mtime);
+        return;
+    }
+#else
+    struct stat st;
+    if (stat(path, &st) == 0 && S_ISREG(st.st_mode)) {
+        scan_list_add(list, path, (uint64_t)st.st_size, (int64_t)st.st_mtime);
+        return;
+    }
+#endif
+    walk_dir(path, list, 0);
+}
+
+int chip8_romlib_find_files(const char* const* dirs, int dir_count, char*** paths) {
+    *paths = NULL;
+    
+    ScanList list = { NULL, 0, 0 };
+    for (int i = 0; i < dir_count; i++) {
+        walk_root(dirs[i], &list);
+    }
+    if (list.count == 0) {
+        free(list.items);
+        return 0;
+    }
+    qsort(list.items, list.count, sizeof(ScanItem), compare_items);
+    
+    char** result = (char**)malloc(list.count * sizeof(char*));
+    if (!result) {
+        for (int i = 0; i < list.count; i++) free(list.items[i].path);
+        free(list.items);
+        return 0;
+    }
+    for (int i = 0; i < list.count; i++) {
+        result[i] = list.items[i].path;
+    }
+    
+    int count = list.count;
+    free(list.items);
+    *paths = result;
+    return count;
+}
+
+void chip8_romlib_free_files(char** paths, int count) {
+    if (!paths) return;
+    for (int i = 0; i < count; i++) free(paths[i]);
+    free(paths);
+}
+
+// ---------------------------------------------------------------
+// 并行哈希
+// ---------------------------------------------------------------
+
+static void hash_item(ScanItem* item) {
+    Chip8MappedFile map;
+    if (!chip8_mmap_open(&map, item->path, 0, 0)) {
+        fprintf(stderr, "警告: 无法读取ROM文件: %s\n", item->path);
+        return;
+    }
+    
+    RomEntry* e = &item->entry;
+    memset(e, 0, sizeof(*e));
+    e->size = map.size;
+    e->mtime = item->mtime;
+    e->xxh64 = chip8_xxh64(map.data, map.size, 0);
+    chip8_sha1(map.data, map.size, e->sha1);
+    chip8_romlib_analyze(map.data, map.size, e);
+    
+    chip8_mmap_close(&map);
+    item->ok = 1;
+}
+
+static int hash_worker(void* data) {
+    ScanJobs* jobs = (ScanJobs*)data;
+    int index;
+    while ((index = SDL_AtomicAdd(&jobs->next, 1)) < jobs->job_count) {
+        hash_item(jobs->jobs[index]);
+    }
+    return 0;
+}
+
+static void hash_parallel(ScanItem** job_list, int job_count) {
+    ScanJobs jobs;
+    jobs.jobs = job_list;
+    jobs.job_count = job_count;
+    SDL_AtomicSet(&jobs.next, 0);
+    
+    int thread_count = SDL_GetCPUCount();
+    if (thread_count > SCAN_MAX_THREADS) thread_count = SCAN_MAX_THREADS;
+    if (thread_count > job_count) thread_count = job_count;
+    
+    // 当前线程也参与，额外启动 thread_count-1 个工作线程
+    SDL_Thread* threads[SCAN_MAX_THREADS];
+    int started = 0;
+    for (int i = 1; i < thread_count; i++) {
+        threads[started] = SDL_CreateThread(hash_worker, "chip8_romscan", &jobs);
+        if (threads[started]) started++;
+    }
+    
+    hash_worker(&jobs);
+    
+    for (int i = 0; i < started; i++) {
+        SDL_WaitThread(threads[i], NULL);
+    }
+}
+
+// ---------------------------------------------------------------
+// 索引读写
+// ---------------------------------------------------------------
+
+static int compare_items(const void* a, const void* b) {
+    return strcmp(((const ScanItem*)a)->path, ((const ScanItem*)b)->path);
+}
+
+static int find_entry_index(const Chip8RomLibrary* lib, const char* path) {
+    int lo = 0, hi = (int)lib->count - 1;
+    while (lo <= hi) {
+        int mid = (lo + hi) / 2;
+        int cmp = strcmp(chip8_romlib_path(lib, &lib->entries[mid]), path);
+        if (cmp == 0) return mid;
+        if (cmp < 0) lo = mid + 1;
+        else hi = mid - 1;
+    }
+    return -1;
+}
+
+// 写入临时文件后替换，避免中断时留下损坏的索引
+static int write_index(const char* index_path, ScanItem* items, int count) {
+    char tmp_path[1024];
+    snprintf(tmp_path, sizeof(tmp_path), "%s.tmp", index_path);
+    
+    FILE* file = fopen(tmp_path, "wb");
+    if (!file) {
+        fprintf(stderr, "错误: 无法写入索引文件: %s\n", tmp_path);
+        return 0;
+    }
+    
+    RomIndexHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, ROMLIB_MAGIC, 4);
+    header.version = ROMLIB_VERSION;
+    header.created = (int64_t)time(NULL);
+    
+    uint32_t strings_size = 0;
+    for (int i = 0; i < count; i++) {
+        if (!items[i].ok) continue;
+        items[i].entry.path_offset = strings_size;
+        strings_size += (uint32_t)strlen(items[i].path) + 1;
+        header.count++;
+    }
+    header.strings_size = strings_size;
+    
+    int ok = fwrite(&header, sizeof(header), 1, file) == 1;
+    for (int i = 0; ok && i < count; i++) {
+        if (items[i].ok) ok = fwrite(&items[i].entry, sizeof(RomEntry), 1, file) == 1;
+    }
+    for (int i = 0; ok && i < count; i++) {
+        if (items[i].ok) ok = fwrite(items[i].path, strlen(items[i].path) + 1, 1, file) == 1;
+    }
+    
+    if (fclose(file) != 0) ok = 0;
+    if (!ok) {
+        fprintf(stderr, "错误: 写入索引文件失败: %s\n", tmp_path);
+        remove(tmp_path);
+        return 0;
+    }
+
+#ifdef _WIN32
+    remove(index_path);  // Windows上rename不能覆盖已有文件
+#endif
+    if (rename(tmp_path, index_path) != 0) {
+        fprintf(stderr, "错误: 无法替换索引文件: %s\n", index_path);
+        remove(tmp_path);
+        return 0;
+    }
+    return 1;
+}
+
+int chip8_romlib_scan(const char* index_path, const char* const* dirs, int dir_count, RomScanStats* stats) {
+    RomScanStats local;
+    if (!stats) stats = &local;
+    memset(stats, 0, sizeof(*stats));
+    Uint32 start = SDL_GetTicks();
+    
+    ScanList list = { NULL, 0, 0 };
+    for (int i = 0; i < dir_count; i++) {
+        walk_root(dirs[i], &list);
+    }
+    qsort(list.items, list.count, sizeof(ScanItem), compare_items);
+    stats->files = (uint32_t)list.count;
+    
+    // 对照旧索引：大小和修改时间都未变的文件直接沿用
+    Chip8RomLibrary old;
+    int have_old = chip8_romlib_open(&old, index_path);
+    uint32_t matched = 0;
+    
+    ScanItem** jobs = (ScanItem**)malloc((list.count ? list.count : 1) * sizeof(ScanItem*));
+    int job_count = 0;
+    if (!jobs) {
+        if (have_old) chip8_romlib_close(&old);
+        free(list.items);
+        return 0;
+    }
+    
+    for (int i = 0; i < list.count; i++) {
+        ScanItem* item = &list.items[i];
+        int index = have_old ? find_entry_index(&old, item->path) : -1;
+        if (index >= 0) {
+            matched++;
+            const RomEntry* e = &old.entries[index];
+            if (e->size == item->size && e->mtime == item->mtime) {
+                item->entry = *e;
+                item->ok = 1;
+                stats->reused++;
+                continue;
+            }
+        }
+        jobs[job_count++] = item;
+    }
+    if (have_old) {
+        stats->removed = old.count - matched;
+        chip8_romlib_close(&old);  // Windows上替换文件前必须解除映射
+    }
+    
+    if (job_count > 0) {
+        hash_parallel(jobs, job_count);
+    }
+    for (int i = 0; i < job_count; i++) {
+        if (jobs[i]->ok) stats->hashed++;
+        else stats->failed++;
+    }
+    free(jobs);
+    
+    int ok = write_index(index_path, list.items, list.count);
+    
+    for (int i = 0; i < list.count; i++) {
+        free(list.items[i].path);
+    }
+    free(list.items);
+    
+    stats->elapsed_ms = SDL_GetTicks() - start;
+    return ok;
+}
+
+int chip8_romlib_open(Chip8RomLibrary* lib, const char* index_path) {
+    memset(lib, 0, sizeof(*lib));
+    
+    if (!chip8_mmap_open(&lib->map, index_path, 0, 0)) {
+        return 0;
+    }
+    
+    const RomIndexHeader* header = (const RomIndexHeader*)lib->map.data;
+    size_t size = lib->map.size;
+    if (size < sizeof(RomIndexHeader) || memcmp(header->magic, ROMLIB_MAGIC, 4) != 0 ||
+        header->version != ROMLIB_VERSION) {
+        fprintf(stderr, "警告: 索引文件格式无效，将重新生成: %s\n", index_path);
+        chip8_mmap_close(&lib->map);
+        return 0;
+    }
+    
+    size_t expected = sizeof(RomIndexHeader) + (size_t)header->count * sizeof(RomEntry) + header->strings_size;
+    if (size != expected || (header->strings_size > 0 && lib->map.data[size - 1] != '\0')) {
+        fprintf(stderr, "警告: 索引文件已损坏，将重新生成: %s\n", index_path);
+        chip8_mmap_close(&lib->map);
+        return 0;
+    }
+    
+    lib->count = header->count;
+    lib->entries = (const RomEntry*)(lib->map.data + sizeof(RomIndexHeader));
+    lib->strings = (const char*)(lib->entries + lib->count);
+    
+    for (uint32_t i = 0; i < lib->count; i++) {
+        if (lib->entries[i].path_offset >= header->strings_size) {
+            fprintf(stderr, "警告: 索引文件已损坏，将重新生成: %s\n", index_path);
+            chip8_romlib_close(lib);
+            return 0;
+        }
+    }
+    return 1;
+}
+
+void chip8_romlib_close(Chip8RomLibrary* lib) {
+    chip8_mmap_close(&lib->map);
+    lib->entries = NULL;
+    lib->strings = NULL;
+    lib->count = 0;
+}
+
+const char* chip8_romlib_path(const Chip8RomLibrary* lib, const RomEntry* entry) {
+    return lib->strings + entry->path_offset;
+}
+
+// 十六进制哈希前缀匹配 (至少6位)
+static int hash_prefix_matches(const RomEntry* e, const char* query, size_t len) {
+    char hex[SHA1_DIGEST_SIZE * 2 + 1];
+    chip8_hash_hex(e->sha1, SHA1_DIGEST_SIZE, hex);
+    if (len <= SHA1_DIGEST_SIZE * 2 && strncasecmp(hex, query, len) == 0) return 1;
+    
+    char xxh[17];
+    snprintf(xxh, sizeof(xxh), "%016llx", (unsigned long long)e->xxh64);
+    return len <= 16 && strncasecmp(xxh, query, len) == 0;
+}
+
+// 文件名比较，query 可省略扩展名
+static int name_matches(const char* path, const char* query) {
+    const char* base = path_basename(path);
+    if (strcasecmp(base, query) == 0) return 1;
+    
+    const char* dot = strrchr(base, '.');
+    size_t len = dot ? (size_t)(dot - base) : strlen(base);
+    return strlen(query) == len && strncasecmp(base, query, len) == 0;
+}
+
+const RomEntry* chip8_romlib_find(const Chip8RomLibrary* lib, const char* query) {
+    if (!lib || !query || lib->count == 0) return NULL;
+    
+    int index = find_entry_index(lib, query);
+    if (index >= 0) return &lib->entries[index];
+    
+    size_t len = strlen(query);
+    int is_hex = len >= 6;
+    for (size_t i = 0; i < len && is_hex; i++) {
+        is_hex = isxdigit((unsigned char)query[i]);
+    }
+    
+    const RomEntry* found = NULL;
+    int matches = 0;
+    for (uint32_t i = 0; i < lib->count; i++) {
+        const RomEntry* e = &lib->entries[i];
+        if ((is_hex && hash_prefix_matches(e, query, len)) ||
+            name_matches(chip8_romlib_path(lib, e), query)) {
+            if (!found) found = e;
+            matches++;
+        }
+    }
+    
+    if (matches > 1) {
+        fprintf(stderr, "警告: '%s' 匹配到 %d 个ROM，使用 %s\n", query, matches, chip8_romlib_path(lib, found));
+    }
+    return found;
+}
+
+int chip8_romlib_load(const Chip8RomLibrary* lib, const RomEntry* entry, Chip8* chip8) {
+    const char* path = chip8_romlib_path(lib, entry);
+    
+    Chip8MappedFile map;
+    if (!chip8_mmap_open(&map, path, 0, 0)) {
+        fprintf(stderr, "错误: 无法打开ROM文件: %s\n", path);
+        return 0;
+    }
+    
+    if (map.size != entry->size || chip8_xxh64(map.data, map.size, 0) != entry->xxh64) {
+        fprintf(stderr, "警告: ROM文件在扫描后已修改，建议重新扫描ROM库: %s\n", path);
+    }
+    
+    int ok = chip8_load_rom_data(chip8, map.data, map.size);
+    chip8_mmap_close(&map);
+    
+    if (ok) {
+        char hex[SHA1_DIGEST_SIZE * 2 + 1];
+        chip8_hash_hex(entry->sha1, SHA1_DIGEST_SIZE, hex);
+        printf("成功加载ROM: %s\n", path);
+        printf("平台: %s, SHA-1: %s, 大小: %llu字节\n",
+               chip8_romlib_platform_name(entry->platform), hex, (unsigned long long)entry->size);
+    }
+    return ok;
+}
+
+void chip8_romlib_list(const Chip8RomLibrary* lib, FILE* out) {
+    fprintf(out, "%-10s %-7s %6s %6s %-6s %s\n", "SHA-1", "平台", "大小", "指令", "quirks", "路径");
+    for (uint32_t i = 0; i < lib->count; i++) {
+        const RomEntry* e = &lib->entries[i];
+        char hex[SHA1_DIGEST_SIZE * 2 + 1];
+        chip8_hash_hex(e->sha1, SHA1_DIGEST_SIZE, hex);
+        hex[10] = '\0';
+        fprintf(out, "%-10s %-7s %6llu %6u 0x%02X   %s\n", hex, chip8_romlib_platform_name(e->platform),
+                (unsigned long long)e->size, e->instructions, e->quirks, chip8_romlib_path(lib, e));
+    }
+    fprintf(out, "共 %u 个ROM\n", lib->count);
+}
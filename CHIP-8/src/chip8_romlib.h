@@ -0,0 +1,102 @@
+#ifndef CHIP8_ROMLIB_H
+#define CHIP8_ROMLIB_H
+
+#include <stdio.h>
+#include "chip8.h"
+#include "chip8_hash.h"
+#include "chip8_mmap.h"
+
+// ROM库：并行扫描目录，为每个ROM计算哈希与静态分析结果，
+// 保存为紧凑的索引文件。启动时直接映射索引，按名称或哈希查找
+
+#define ROMLIB_MAGIC "C8LB"
+#define ROMLIB_VERSION 1
+#define ROMLIB_DEFAULT_INDEX "chip8_library.idx"
+#define ROMLIB_MAX_DIRS 8
+
+// 目标平台
+typedef enum {
+    ROM_PLATFORM_CHIP8 = 0,    // 原版 COSMAC VIP CHIP-8
+    ROM_PLATFORM_SCHIP,        // SUPER-CHIP
+    ROM_PLATFORM_XOCHIP,       // XO-CHIP
+    ROM_PLATFORM_COUNT
+} RomPlatform;
+
+// 静态分析标志
+#define ROM_USES_SOUND      0x01   // FX18
+#define ROM_USES_KEYS       0x02   // EX9E/EXA1
+#define ROM_WAITS_KEY       0x04   // FX0A
+#define ROM_USES_RANDOM     0x08   // CXNN
+#define ROM_INDIRECT_JUMP   0x10   // BNNN (分析可能不完整)
+
+// 索引文件头
+typedef struct {
+    char magic[4];             // "C8LB"
+    uint32_t version;
+    uint32_t count;            // 条目数
+    uint32_t strings_size;     // 路径字符串表字节数
+    int64_t created;           // 生成时间 (time_t)
+    uint64_t reserved;
+} RomIndexHeader;
+
+// 索引条目 (按路径排序，定长56字节)
+typedef struct {
+    uint64_t size;             // 文件大小
+    int64_t mtime;             // 修改时间
+    uint64_t xxh64;            // XXH64 (种子0)
+    uint8_t sha1[SHA1_DIGEST_SIZE];
+    uint8_t platform;          // RomPlatform
+    uint8_t quirks;            // QUIRK_* 推荐配置
+    uint8_t flags;             // ROM_* 分析标志
+    uint8_t reserved;
+    uint16_t instructions;     // 从0x200可达的指令数
+    uint16_t sprites;          // 可达的DXYN指令数
+    uint32_t path_offset;      // 在字符串表中的偏移
+} RomEntry;
+
+// 已打开的ROM库 (索引文件只读映射)
+typedef struct {
+    Chip8MappedFile map;
+    const RomEntry* entries;
+    const char* strings;
+    uint32_t count;
+} Chip8RomLibrary;
+
+// 扫描统计
+typedef struct {
+    uint32_t files;            // 找到的ROM文件
+    uint32_t reused;           // 大小和修改时间未变，沿用旧条目
+    uint32_t hashed;           // 新增或已修改，重新哈希
+    uint32_t removed;          // 旧索引中已不存在的文件
+    uint32_t failed;           // 无法读取的文件
+    uint32_t elapsed_ms;
+} RomScanStats;
+
+// 增量扫描 dirs 并重写索引文件
+int chip8_romlib_scan(const char* index_path, const char* const* dirs, int dir_count, RomScanStats* stats);
+
+// 递归列出 dirs 中的ROM文件 (也可以直接给出ROM文件路径)，按路径排序。
+// 返回文件数，*paths 用 chip8_romlib_free_files 释放
+int chip8_romlib_find_files(const char* const* dirs, int dir_count, char*** paths);
+void chip8_romlib_free_files(char** paths, int count);
+
+int chip8_romlib_open(Chip8RomLibrary* lib, const char* index_path);
+void chip8_romlib_close(Chip8RomLibrary* lib);
+
+// 按完整路径、哈希前缀 (SHA-1或XXH64十六进制) 或文件名查找
+const RomEntry* chip8_romlib_find(const Chip8RomLibrary* lib, const char* query);
+const char* chip8_romlib_path(const Chip8RomLibrary* lib, const RomEntry* entry);
+
+// 加载ROM到内存 (校验哈希，文件已修改时给出警告)
+int chip8_romlib_load(const Chip8RomLibrary* lib, const RomEntry* entry, Chip8* chip8);
+
+void chip8_romlib_list(const Chip8RomLibrary* lib, FILE* out);
+
+// 对ROM数据做静态分析，填写 platform/quirks/flags/instructions/sprites
+void chip8_romlib_analyze(const uint8_t* rom, size_t size, RomEntry* entry);
+
+const char* chip8_romlib_platform_name(int platform);
+int chip8_romlib_platform_from_name(const char* name);  // 未知名称返回-1
+uint8_t chip8_romlib_platform_quirks(int platform);     // 平台推荐的 QUIRK_* 配置
+
+#endif // CHIP8_ROMLIB_H
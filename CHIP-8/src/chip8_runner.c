@@ -0,0 +1,386 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <SDL2/SDL.h>
+#include "chip8_runner.h"
+#include "chip8_timing.h"
+#include "chip8_input.h"
+
+// 线程池任务
+typedef struct {
+    void (*fn)(int index, void* ctx);
+    void* ctx;
+    int count;
+    SDL_atomic_t next;
+} ParallelJobs;
+
+void chip8_runner_default_config(Chip8RunConfig* config) {
+    memset(config, 0, sizeof(*config));
+    config->frames = RUNNER_DEFAULT_FRAMES;
+    config->interval = RUNNER_DEFAULT_INTERVAL;
+    config->timing_model = TIMING_MODEL_SPEED;
+    config->cycles_per_frame = CPU_DEFAULT_SPEED / 60;
+    config->seed = 1;
+    config->rng = CHIP8_RNG_PHILOX;
+    config->script = NULL;
+}
+
+void chip8_runner_describe(const Chip8RunConfig* config, char* buf, size_t size) {
+    int len = snprintf(buf, size, "frames=%d interval=%d timing=%s cycles=%d seed=%u",
+                       config->frames, config->interval, chip8_timing_name(config->timing_model),
+                       config->timing_model == TIMING_MODEL_VIP ? 0 : config->cycles_per_frame, config->seed);
+    // 旧的LCG不写入，以前生成的基准文件用 --rng lcg 仍然可以比较
+    if (config->rng != CHIP8_RNG_LCG && len > 0 && (size_t)len < size) {
+        snprintf(buf + len, size - (size_t)len, " rng=%s", chip8_rng_name((Chip8RngKind)config->rng));
+    }
+}
+
+// ---------------------------------------------------------------
+// 输入脚本
+// ---------------------------------------------------------------
+
+int chip8_script_load(Chip8InputScript* script, const char* path) {
+    script->events = NULL;
+    script->count = 0;
+    
+    FILE* f = fopen(path, "r");
+    if (!f) {
+        fprintf(stderr, "错误: 无法打开输入脚本: %s\n", path);
+        return 0;
+    }
+    
+    int capacity = 0;
+    char line[256];
+    int line_no = 0;
+    while (fgets(line, sizeof(line), f)) {
+        line_no++;
+        char* p = line;
+        while (isspace((unsigned char)*p)) p++;
+        if (*p == '\0' || *p == '#') continue;
+        
+        unsigned long frame;
+        unsigned int key;
+        char action[16];
+        if (sscanf(p, "%lu %x %15s", &frame, &key, action) != 3 || key > 0xF ||
+            (strcmp(action, "down") != 0 && strcmp(action, "up") != 0)) {
+            fprintf(stderr, "错误: 输入脚本格式错误 (%s 第%d行)\n", path, line_no);
+            fclose(f);
+            chip8_script_free(script);
+            return 0;
+        }
+        
+        if (script->count == capacity) {
+            capacity = capacity ? capacity * 2 : 64;
+            RunnerInputEvent* events = (RunnerInputEvent*)realloc(script->events, capacity * sizeof(RunnerInputEvent));
+            if (!events) {
+                fclose(f);
+                chip8_script_free(script);
+                return 0;
+            }
+            script->events = events;
+        }
+        
+        RunnerInputEvent* ev = &script->events[script->count++];
+        ev->frame = (uint32_t)frame;
+        ev->key = (uint8_t)key;
+        ev->pressed = strcmp(action, "down") == 0;
+    }
+    fclose(f);
+    
+    // 按帧号排序 (插入排序，同一帧的事件保持脚本中的顺序)
+    for (int i = 1; i < script->count; i++) {
+        RunnerInputEvent ev = script->events[i];
+        int j = i;
+        while (j > 0 && script->events[j - 1].frame > ev.frame) {
+            script->events[j] = script->events[j - 1];
+            j--;
+        }
+        script->events[j] = ev;
+    }
+    return 1;
+}
+
+void chip8_script_free(Chip8InputScript* script) {
+    free(script->events);
+    script->events = NULL;
+    script->count = 0;
+}
+
+// ---------------------------------------------------------------
+// 运行
+// ---------------------------------------------------------------
+
+static uint32_t total_faults(const Chip8* chip8) {
+    uint32_t total = 0;
+    for (int i = CHIP8_FAULT_NONE + 1; i < CHIP8_FAULT_COUNT; i++) {
+        total += chip8->fault_count[i];
+    }
+    return total;
+}
+
+int chip8_run_rom(const uint8_t* rom, size_t size, const Chip8RunConfig* config, Chip8RunResult* result) {
+    memset(result, 0, sizeof(*result));
+    result->first_fault_frame = -1;
+    
+    // Chip8 结构较大，放在堆上以免占用工作线程的栈
+    Chip8* chip8 = (Chip8*)calloc(1, sizeof(Chip8));
+    if (!chip8) return 0;
+    
+    chip8->quiet = 1;
+    chip8_reset(chip8, config->seed);
+    chip8_rng_init(&chip8->rng, (Chip8RngKind)config->rng, config->seed, 0);
+    if (!chip8_load_rom_data(chip8, rom, size)) {
+        free(chip8);
+        return 0;
+    }
+    
+    // 脚本事件与窗口模式一样经过输入队列，快速按下+松开的处理一致
+    const Chip8InputScript* script = config->script;
+    Chip8InputQueue* input = (Chip8InputQueue*)malloc(sizeof(Chip8InputQueue));
+    if (!input) {
+        free(chip8);
+        return 0;
+    }
+    chip8_input_init(input);
+    int next_event = 0;
+    int interval = config->interval > 0 ? config->interval : RUNNER_DEFAULT_INTERVAL;
+    uint8_t packed[DISPLAY_PACKED_SIZE];
+    uint64_t hash = 0;
+    
+    for (int frame = 0; frame < config->frames; frame++) {
+        while (script && next_event < script->count && script->events[next_event].frame <= (uint32_t)frame) {
+            const RunnerInputEvent* ev = &script->events[next_event];
+            if (!chip8_input_push(input, 0, ev->key, ev->pressed)) break;  // 队列满：留到下一帧
+            next_event++;
+        }
+        
+        if (config->timing_model == TIMING_MODEL_VIP) {
+            chip8_input_apply(input, chip8, UINT64_MAX);
+            result->instructions += (uint64_t)chip8_run_frame(chip8, (chip8->quirks & QUIRK_DISPLAY_WAIT) != 0);
+        } else {
+            for (int i = 0; i < config->cycles_per_frame; i++) {
+                chip8_input_apply(input, chip8, UINT64_MAX);
+                chip8_cycle(chip8);
+            }
+            result->instructions += (uint64_t)config->cycles_per_frame;
+        }
+        chip8_update_timers(chip8);
+        
+        // 链式哈希：每帧的哈希以上一帧的结果为种子
+        chip8_pack_display(chip8, packed);
+        hash = chip8_xxh64(packed, sizeof(packed), hash);
+        
+        if (result->first_fault_frame < 0 && total_faults(chip8) > 0) {
+            result->first_fault_frame = frame;
+        }
+        if ((frame + 1) % interval == 0 && result->checkpoint_count < RUNNER_MAX_CHECKPOINTS) {
+            result->checkpoints[result->checkpoint_count++] = hash;
+        }
+    }
+    
+    result->hash = hash;
+    result->frames = config->frames;
+    memcpy(result->faults, chip8->fault_count, sizeof(result->faults));
+    result->ok = 1;
+    
+    free(input);
+    free(chip8);
+    return 1;
+}
+
+// ---------------------------------------------------------------
+// 线程池
+// ---------------------------------------------------------------
+
+static int parallel_worker(void* data) {
+    ParallelJobs* jobs = (ParallelJobs*)data;
+    int index;
+    while ((index = SDL_AtomicAdd(&jobs->next, 1)) < jobs->count) {
+        jobs->fn(index, jobs->ctx);
+    }
+    return 0;
+}
+
+void chip8_parallel_for(int count, int threads, void (*fn)(int index, void* ctx), void* ctx) {
+    ParallelJobs jobs;
+    jobs.fn = fn;
+    jobs.ctx = ctx;
+    jobs.count = count;
+    SDL_AtomicSet(&jobs.next, 0);
+    
+    if (threads <= 0) threads = SDL_GetCPUCount();
+    if (threads > RUNNER_MAX_THREADS) threads = RUNNER_MAX_THREADS;
+    if (threads > count) threads = count;
+    
+    // 当前线程也参与，额外启动 threads-1 个工作线程
+    SDL_Thread* workers[RUNNER_MAX_THREADS];
+    int started = 0;
+    for (int i = 1; i < threads; i++) {
+        workers[started] = SDL_CreateThread(parallel_worker, "chip8_runner", &jobs);
+        if (workers[started]) started++;
+    }
+    
+    parallel_worker(&jobs);
+    
+    for (int i = 0; i < started; i++) {
+        SDL_WaitThread(workers[i], NULL);
+    }
+}
+
+// ---------------------------------------------------------------
+// 基准哈希文件
+// ---------------------------------------------------------------
+
+static int parse_sha1(const char* hex, uint8_t* out) {
+    for (int i = 0; i < SHA1_DIGEST_SIZE; i++) {
+        unsigned int byte;
+        if (sscanf(hex + i * 2, "%2x", &byte) != 1) return 0;
+        out[i] = (uint8_t)byte;
+    }
+    return 1;
+}
+
+int chip8_golden_load(Chip8GoldenSet* set, const char* path) {
+    memset(set, 0, sizeof(*set));
+    
+    FILE* f = fopen(path, "r");
+    if (!f) return 1;  // 还没有基准文件
+    
+    char line[RUNNER_MAX_CHECKPOINTS * 17 + 512];
+    int line_no = 0;
+    while (fgets(line, sizeof(line), f)) {
+        line_no++;
+        if (line[0] == '#' || line[0] == '\n') continue;
+        if (line[0] == '@') {
+            const char* p = line + 1;
+            while (*p == ' ') p++;
+            size_t len = strcspn(p, "\r\n");
+            if (len >= sizeof(set->config)) len = sizeof(set->config) - 1;
+            memcpy(set->config, p, len);
+            set->config[len] = '\0';
+            continue;
+        }
+        
+        char sha1_hex[64], hash_hex[32];
+        int list_pos = 0;
+        uint8_t sha1[SHA1_DIGEST_SIZE];
+        if (sscanf(line, "%63s %31s %n", sha1_hex, hash_hex, &list_pos) < 2 || list_pos == 0 ||
+            strlen(sha1_hex) != SHA1_DIGEST_SIZE * 2 || !parse_sha1(sha1_hex, sha1)) {
+            fprintf(stderr, "警告: 基准文件格式错误 (%s 第%d行)\n", path, line_no);
+            continue;
+        }
+        
+        GoldenEntry* e = chip8_golden_put(set, sha1);
+        if (!e) {
+            fclose(f);
+            return 0;
+        }
+        e->hash = strtoull(hash_hex, NULL, 16);
+        e->checkpoint_count = 0;
+        
+        // 检查点列表 ("-" 表示没有)，之后是文件名
+        char* p = line + list_pos;
+        if (*p == '-') {
+            p++;
+        } else {
+            while (isxdigit((unsigned char)*p) && e->checkpoint_count < RUNNER_MAX_CHECKPOINTS) {
+                e->checkpoints[e->checkpoint_count++] = strtoull(p, &p, 16);
+                if (*p != ',') break;
+                p++;
+            }
+        }
+        while (*p == ' ') p++;
+        
+        const char* name = p;
+        size_t len = strcspn(name, "\r\n");
+        if (len >= sizeof(e->name)) len = sizeof(e->name) - 1;
+        memcpy(e->name, name, len);
+        e->name[len] = '\0';
+    }
+    
+    fclose(f);
+    return 1;
+}
+
+static int compare_golden(const void* a, const void* b) {
+    return memcmp(((const GoldenEntry*)a)->sha1, ((const GoldenEntry*)b)->sha1, SHA1_DIGEST_SIZE);
+}
+
+int chip8_golden_save(const Chip8GoldenSet* set, const char* path) {
+    // 按SHA-1排序写出，便于版本控制中比较差异
+    GoldenEntry* sorted = NULL;
+    if (set->count > 0) {
+        sorted = (GoldenEntry*)malloc(set->count * sizeof(GoldenEntry));
+        if (!sorted) return 0;
+        memcpy(sorted, set->entries, set->count * sizeof(GoldenEntry));
+        qsort(sorted, set->count, sizeof(GoldenEntry), compare_golden);
+    }
+    
+    FILE* f = fopen(path, "w");
+    if (!f) {
+        fprintf(stderr, "错误: 无法写入基准文件: %s\n", path);
+        free(sorted);
+        return 0;
+    }
+    
+    fprintf(f, "# CHIP-8 基准帧哈希: <ROM SHA-1> <最终哈希> <检查点哈希> <文件名>\n");
+    fprintf(f, "@ %s\n", set->config);
+    for (int i = 0; i < set->count; i++) {
+        const GoldenEntry* e = &sorted[i];
+        char hex[SHA1_DIGEST_SIZE * 2 + 1];
+        chip8_hash_hex(e->sha1, SHA1_DIGEST_SIZE, hex);
+        fprintf(f, "%s %016llx ", hex, (unsigned long long)e->hash);
+        if (e->checkpoint_count == 0) fputc('-', f);
+        for (int j = 0; j < e->checkpoint_count; j++) {
+            fprintf(f, "%s%016llx", j ? "," : "", (unsigned long long)e->checkpoints[j]);
+        }
+        fprintf(f, " %s\n", e->name);
+    }
+    
+    free(sorted);
+    if (fclose(f) != 0) {
+        fprintf(stderr, "错误: 写入基准文件失败: %s\n", path);
+        return 0;
+    }
+    return 1;
+}
+
+GoldenEntry* chip8_golden_find(Chip8GoldenSet* set, const uint8_t* sha1) {
+    for (int i = 0; i < set->count; i++) {
+        if (memcmp(set->entries[i].sha1, sha1, SHA1_DIGEST_SIZE) == 0) return &set->entries[i];
+    }
+    return NULL;
+}
+
+GoldenEntry* chip8_golden_put(Chip8GoldenSet* set, const uint8_t* sha1) {
+    GoldenEntry* e = chip8_golden_find(set, sha1);
+    if (e) return e;
+    
+    if (set->count == set->capacity) {
+        int capacity = set->capacity ? set->capacity * 2 : 64;
+        GoldenEntry* entries = (GoldenEntry*)realloc(set->entries, capacity * sizeof(GoldenEntry));
+        if (!entries) return NULL;
+        set->entries = entries;
+        set->capacity = capacity;
+    }
+    
+    e = &set->entries[set->count++];
+    memset(e, 0, sizeof(*e));
+    memcpy(e->sha1, sha1, SHA1_DIGEST_SIZE);
+    return e;
+}
+
+void chip8_golden_free(Chip8GoldenSet* set) {
+    free(set->entries);
+    memset(set, 0, sizeof(*set));
+}
+
+int chip8_golden_compare(const GoldenEntry* golden, const Chip8RunResult* result) {
+    int count = golden->checkpoint_count < result->checkpoint_count ? golden->checkpoint_count : result->checkpoint_count;
+    for (int i = 0; i < count; i++) {
+        if (golden->checkpoints[i] != result->checkpoints[i]) return i;
+    }
+    if (golden->checkpoint_count != result->checkpoint_count || golden->hash != result->hash) return count;
+    return -1;
+}
@@ -0,0 +1,94 @@
+#ifndef CHIP8_RUNNER_H
+#define CHIP8_RUNNER_H
+
+#include <stdio.h>
+#include "chip8.h"
+#include "chip8_hash.h"
+
+// 无窗口批量运行：按输入脚本运行ROM固定帧数，逐帧对显示做链式哈希，
+// 与保存的基准 (golden) 哈希比较，用于检查核心修改是否改变了行为。
+// 每个ROM使用独立的 Chip8 实例，可以在线程池中并行运行
+
+#define RUNNER_MAX_CHECKPOINTS 64      // 每个ROM最多保存的检查点哈希
+#define RUNNER_DEFAULT_FRAMES 600      // 默认运行帧数 (10秒)
+#define RUNNER_DEFAULT_INTERVAL 60     // 默认检查点间隔 (帧)
+#define RUNNER_MAX_THREADS 64
+
+// 输入脚本事件：在第 frame 帧开始时按下/松开按键
+typedef struct {
+    uint32_t frame;
+    uint8_t key;
+    uint8_t pressed;
+} RunnerInputEvent;
+
+// 输入脚本 (按帧号排序)
+typedef struct {
+    RunnerInputEvent* events;
+    int count;
+} Chip8InputScript;
+
+// 运行配置
+typedef struct {
+    int frames;                // 运行帧数
+    int interval;              // 检查点间隔 (帧)
+    int timing_model;          // Chip8TimingModel
+    int cycles_per_frame;      // TIMING_MODEL_SPEED 时每帧执行的指令数
+    unsigned int seed;         // 随机数种子 (固定种子才能得到可重复的结果)
+    int rng;                   // Chip8RngKind
+    const Chip8InputScript* script;  // 输入脚本 (可为NULL)
+} Chip8RunConfig;
+
+// 单个ROM的运行结果
+typedef struct {
+    uint64_t hash;             // 最终的链式帧哈希
+    uint64_t checkpoints[RUNNER_MAX_CHECKPOINTS];
+    int checkpoint_count;
+    uint32_t faults[CHIP8_FAULT_COUNT];
+    int first_fault_frame;     // 第一次出现故障的帧 (-1=无)
+    uint64_t instructions;     // 执行的指令总数
+    int frames;                // 实际运行的帧数
+    int ok;                    // 0=ROM无法加载
+} Chip8RunResult;
+
+void chip8_runner_default_config(Chip8RunConfig* config);
+
+// 影响运行结果的配置 (写入基准文件，配置不同的基准不能比较)
+void chip8_runner_describe(const Chip8RunConfig* config, char* buf, size_t size);
+
+// 输入脚本：每行 "<帧号> <按键0-F> <down|up>"，# 开头为注释
+int chip8_script_load(Chip8InputScript* script, const char* path);
+void chip8_script_free(Chip8InputScript* script);
+
+// 运行一个ROM，结果写入 result
+int chip8_run_rom(const uint8_t* rom, size_t size, const Chip8RunConfig* config, Chip8RunResult* result);
+
+// 在线程池中对 0..count-1 调用 fn，threads<=0 时使用CPU核心数
+void chip8_parallel_for(int count, int threads, void (*fn)(int index, void* ctx), void* ctx);
+
+// 基准哈希文件：第一行 "@ <运行配置>"，之后每行
+// "<ROM SHA-1> <最终哈希> <检查点哈希,...> <文件名>"，按ROM内容索引，文件改名或移动后仍能匹配
+typedef struct {
+    uint8_t sha1[SHA1_DIGEST_SIZE];
+    uint64_t hash;
+    uint64_t checkpoints[RUNNER_MAX_CHECKPOINTS];
+    int checkpoint_count;
+    char name[128];
+} GoldenEntry;
+
+typedef struct {
+    GoldenEntry* entries;
+    int count;
+    int capacity;
+    char config[128];          // 生成基准时的运行配置 (见 chip8_runner_describe)
+} Chip8GoldenSet;
+
+int chip8_golden_load(Chip8GoldenSet* set, const char* path);  // 文件不存在时返回空集合
+int chip8_golden_save(const Chip8GoldenSet* set, const char* path);
+GoldenEntry* chip8_golden_find(Chip8GoldenSet* set, const uint8_t* sha1);
+GoldenEntry* chip8_golden_put(Chip8GoldenSet* set, const uint8_t* sha1);  // 查找或新增
+void chip8_golden_free(Chip8GoldenSet* set);
+
+// 第一个与基准不一致的检查点 (-1=一致)
+int chip8_golden_compare(const GoldenEntry* golden, const Chip8RunResult* result);
+
+#endif // CHIP8_RUNNER_H
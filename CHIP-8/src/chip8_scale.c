@@ -0,0 +1,392 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "chip8_scale.h"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define SCALE_X86 1
+#include <immintrin.h>
+#endif
+
+#define COLOR_ON 0xFFFFFFFFu           // 白色像素
+#define COLOR_OFF 0xFF000000u          // 黑色背景
+
+static const char* FILTER_NAMES[SCALE_FILTER_COUNT] = {
+    "nearest", "scale2x", "scale3x", "scale4x", "epx", "crt"
+};
+
+const char* chip8_scale_filter_name(ScaleFilter filter) {
+    if (filter < 0 || filter >= SCALE_FILTER_COUNT) return "?";
+    return FILTER_NAMES[filter];
+}
+
+int chip8_scale_filter_from_name(const char* name) {
+    for (int i = 0; i < SCALE_FILTER_COUNT; i++) {
+        if (strcasecmp(name, FILTER_NAMES[i]) == 0) return i;
+    }
+    return -1;
+}
+
+// ============ 位运算工具 ============
+
+// 左邻像素视图 (整行右移1位，最左像素复制边缘)
+static inline uint64_t left_of(const uint64_t* row, int w) {
+    uint64_t carry = (w == 0) ? (row[0] & 0x8000000000000000ull) : (row[w - 1] << 63);
+    return (row[w] >> 1) | carry;
+}
+
+// 右邻像素视图 (整行左移1位，最右像素复制边缘)
+static inline uint64_t right_of(const uint64_t* row, int w, int words) {
+    uint64_t carry = (w == words - 1) ? (row[w] & 1) : (row[w + 1] >> 63);
+    return (row[w] << 1) | carry;
+}
+
+// 按位选择：cond为1的位取a，否则取b
+static inline uint64_t select_bits(uint64_t cond, uint64_t a, uint64_t b) {
+    return (cond & a) | (~cond & b);
+}
+
+// 把32位的每一位间隔展开到64位的偶数位
+static inline uint64_t spread32(uint32_t value) {
+    uint64_t x = value;
+    x = (x | (x << 16)) & 0x0000FFFF0000FFFFull;
+    x = (x | (x << 8)) & 0x00FF00FF00FF00FFull;
+    x = (x | (x << 4)) & 0x0F0F0F0F0F0F0F0Full;
+    x = (x | (x << 2)) & 0x3333333333333333ull;
+    x = (x | (x << 1)) & 0x5555555555555555ull;
+    return x;
+}
+
+// 交织两行：输出像素 2x 取 a[x]，2x+1 取 b[x]
+static void interleave2(const uint64_t* a, const uint64_t* b, int words, uint64_t* out) {
+    for (int w = 0; w < words; w++) {
+        out[2 * w] = (spread32((uint32_t)(a[w] >> 32)) << 1) | spread32((uint32_t)(b[w] >> 32));
+        out[2 * w + 1] = (spread32((uint32_t)a[w]) << 1) | spread32((uint32_t)b[w]);
+    }
+}
+
+// 字节内每一位间隔3位展开 (第j位 -> 第3j位)
+static uint32_t spread3_table[256];
+
+static void init_spread3_table(void) {
+    if (spread3_table[255]) return;
+    for (int v = 0; v < 256; v++) {
+        uint32_t x = 0;
+        for (int j = 0; j < 8; j++) {
+            if (v & (1 << j)) x |= 1u << (3 * j);
+        }
+        spread3_table[v] = x;
+    }
+}
+
+// 交织三行 (64像素 -> 192像素)：像素 3x,3x+1,3x+2 分别取 a,b,c
+static void interleave3(uint64_t a, uint64_t b, uint64_t c, uint64_t* out) {
+    uint8_t bytes[24];
+    
+    for (int k = 0; k < 8; k++) {
+        int shift = 56 - 8 * k;
+        uint32_t chunk = (spread3_table[(a >> shift) & 0xFF] << 2) |
+                         (spread3_table[(b >> shift) & 0xFF] << 1) |
+                          spread3_table[(c >> shift) & 0xFF];
+        bytes[3 * k] = (uint8_t)(chunk >> 16);
+        bytes[3 * k + 1] = (uint8_t)(chunk >> 8);
+        bytes[3 * k + 2] = (uint8_t)chunk;
+    }
+    
+    for (int w = 0; w < 3; w++) {
+        uint64_t x = 0;
+        for (int i = 0; i < 8; i++) {
+            x = (x << 8) | bytes[8 * w + i];
+        }
+        out[w] = x;
+    }
+}
+
+// ============ 放大算法 (每次处理64个像素) ============
+
+// 最近邻放大2倍
+static void nearest2x(const ScaleBitmap* src, ScaleBitmap* dst) {
+    dst->width = src->width * 2;
+    dst->height = src->height * 2;
+    dst->words = src->words * 2;
+    
+    for (int y = 0; y < src->height; y++) {
+        interleave2(src->rows[y], src->rows[y], src->words, dst->rows[2 * y]);
+        memcpy(dst->rows[2 * y + 1], dst->rows[2 * y], dst->words * sizeof(uint64_t));
+    }
+}
+
+// Scale2x / EPX
+static void scale2x(const ScaleBitmap* src, ScaleBitmap* dst, int epx) {
+    dst->width = src->width * 2;
+    dst->height = src->height * 2;
+    dst->words = src->words * 2;
+    
+    for (int y = 0; y < src->height; y++) {
+        const uint64_t* row = src->rows[y];
+        const uint64_t* up = src->rows[y > 0 ? y - 1 : y];
+        const uint64_t* down = src->rows[y < src->height - 1 ? y + 1 : y];
+        uint64_t e0[SCALE_ROW_WORDS], e1[SCALE_ROW_WORDS], e2[SCALE_ROW_WORDS], e3[SCALE_ROW_WORDS];
+        
+        for (int w = 0; w < src->words; w++) {
+            uint64_t E = row[w], B = up[w], H = down[w];
+            uint64_t D = left_of(row, w), F = right_of(row, w, src->words);
+            
+            if (!epx) {
+                // Scale2x: E0 = D==B && B!=F && D!=H ? D : E，其余三个方向对称
+                uint64_t db = ~(D ^ B), bf = ~(B ^ F), dh = ~(D ^ H), hf = ~(H ^ F);
+                e0[w] = select_bits(db & ~bf & ~dh, D, E);
+                e1[w] = select_bits(bf & ~db & ~hf, F, E);
+                e2[w] = select_bits(dh & ~db & ~hf, D, E);
+                e3[w] = select_bits(hf & ~dh & ~bf, F, E);
+            } else {
+                // EPX: 1=C==A?A:P, 2=A==B?B:P, 3=D==C?C:P, 4=B==D?D:P；
+                // 若A/B/C/D中有三个或以上相同，则全部取P (二值图像中即“不是恰好两亮两暗”)
+                uint64_t A = B, Bn = F, C = D, Dn = H;
+                uint64_t parity = A ^ Bn ^ C ^ Dn;
+                uint64_t all_same = (A & Bn & C & Dn) | ~(A | Bn | C | Dn);
+                uint64_t keep = parity | all_same;
+                e0[w] = select_bits(~(C ^ A) & ~keep, A, E);
+                e1[w] = select_bits(~(A ^ Bn) & ~keep, Bn, E);
+                e2[w] = select_bits(~(Dn ^ C) & ~keep, C, E);
+                e3[w] = select_bits(~(Bn ^ Dn) & ~keep, Dn, E);
+            }
+        }
+        
+        interleave2(e0, e1, src->words, dst->rows[2 * y]);
+        interleave2(e2, e3, src->words, dst->rows[2 * y + 1]);
+    }
+}
+
+// Scale3x (输入固定为64像素宽，每行一个字)
+static void scale3x(const ScaleBitmap* src, ScaleBitmap* dst) {
+    dst->width = src->width * 3;
+    dst->height = src->height * 3;
+    dst->words = 3;
+    
+    for (int y = 0; y < src->height; y++) {
+        const uint64_t* row = src->rows[y];
+        const uint64_t* up = src->rows[y > 0 ? y - 1 : y];
+        const uint64_t* down = src->rows[y < src->height - 1 ? y + 1 : y];
+        
+        // A B C
+        // D E F
+        // G H I
+        uint64_t E = row[0], B = up[0], H = down[0];
+        uint64_t D = left_of(row, 0), F = right_of(row, 0, 1);
+        uint64_t A = left_of(up, 0), C = right_of(up, 0, 1);
+        uint64_t G = left_of(down, 0), I = right_of(down, 0, 1);
+        
+        uint64_t db = ~(D ^ B), bf = ~(B ^ F), dh = ~(D ^ H), hf = ~(H ^ F);
+        uint64_t corner0 = db & ~dh & ~bf;     // 左上
+        uint64_t corner2 = bf & ~db & ~hf;     // 右上
+        uint64_t corner6 = dh & ~db & ~hf;     // 左下
+        uint64_t corner8 = hf & ~dh & ~bf;     // 右下
+        
+        uint64_t e0 = select_bits(corner0, D, E);
+        uint64_t e1 = select_bits((corner0 & (E ^ C)) | (corner2 & (E ^ A)), B, E);
+        uint64_t e2 = select_bits(corner2, F, E);
+        uint64_t e3 = select_bits((corner0 & (E ^ G)) | (corner6 & (E ^ A)), D, E);
+        uint64_t e5 = select_bits((corner2 & (E ^ I)) | (corner8 & (E ^ C)), F, E);
+        uint64_t e6 = select_bits(corner6, D, E);
+        uint64_t e7 = select_bits((corner6 & (E ^ I)) | (corner8 & (E ^ G)), H, E);
+        uint64_t e8 = select_bits(corner8, F, E);
+        
+        interleave3(e0, e1, e2, dst->rows[3 * y]);
+        interleave3(e3, E, e5, dst->rows[3 * y + 1]);
+        interleave3(e6, e7, e8, dst->rows[3 * y + 2]);
+    }
+}
+
+// ============ 像素展开内核 (1位 -> ARGB8888) ============
+
+// 标量版本
+static void expand_row_scalar(const uint64_t* bits, int width, const uint32_t* on,
+                              const uint32_t* off, uint32_t* out) {
+    for (int x = 0; x < width; x++) {
+        out[x] = ((bits[x >> 6] >> (63 - (x & 63))) & 1) ? on[x] : off[x];
+    }
+}
+
+#ifdef SCALE_X86
+// SSE2版本：每次把一个字节的8个像素展开为两组4个ARGB
+static void expand_row_sse2(const uint64_t* bits, int width, const uint32_t* on,
+                            const uint32_t* off, uint32_t* out) {
+    const __m128i mask_lo = _mm_set_epi32(0x10, 0x20, 0x40, 0x80);
+    const __m128i mask_hi = _mm_set_epi32(0x01, 0x02, 0x04, 0x08);
+    
+    for (int x = 0; x < width; x += 8) {
+        __m128i v = _mm_set1_epi32((int)((bits[x >> 6] >> (56 - (x & 63))) & 0xFF));
+        __m128i m0 = _mm_cmpeq_epi32(_mm_and_si128(v, mask_lo), mask_lo);
+        __m128i m1 = _mm_cmpeq_epi32(_mm_and_si128(v, mask_hi), mask_hi);
+        
+        __m128i p0 = _mm_or_si128(_mm_and_si128(m0, _mm_loadu_si128((const __m128i*)(on + x))),
+                                  _mm_andnot_si128(m0, _mm_loadu_si128((const __m128i*)(off + x))));
+        __m128i p1 = _mm_or_si128(_mm_and_si128(m1, _mm_loadu_si128((const __m128i*)(on + x + 4))),
+                                  _mm_andnot_si128(m1, _mm_loadu_si128((const __m128i*)(off + x + 4))));
+        _mm_storeu_si128((__m128i*)(out + x), p0);
+        _mm_storeu_si128((__m128i*)(out + x + 4), p1);
+    }
+}
+
+// AVX2版本：每次把一个字节的8个像素展开为8个ARGB
+__attribute__((target("avx2")))
+static void expand_row_avx2(const uint64_t* bits, int width, const uint32_t* on,
+                            const uint32_t* off, uint32_t* out) {
+    const __m256i mask = _mm256_set_epi32(0x01, 0x02, 0x04, 0x08, 0x10, 0x20, 0x40, 0x80);
+    
+    for (int x = 0; x < width; x += 8) {
+        __m256i v = _mm256_set1_epi32((int)((bits[x >> 6] >> (56 - (x & 63))) & 0xFF));
+        __m256i m = _mm256_cmpeq_epi32(_mm256_and_si256(v, mask), mask);
+        __m256i p = _mm256_blendv_epi8(_mm256_loadu_si256((const __m256i*)(off + x)),
+                                       _mm256_loadu_si256((const __m256i*)(on + x)), m);
+        _mm256_storeu_si256((__m256i*)(out + x), p);
+    }
+}
+#endif
+
+typedef void (*ExpandRowFn)(const uint64_t*, int, const uint32_t*, const uint32_t*, uint32_t*);
+
+// 根据CPU特性选择展开内核
+static ExpandRowFn select_expand_kernel(void) {
+#ifdef SCALE_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) return expand_row_avx2;
+    if (__builtin_cpu_supports("sse2")) return expand_row_sse2;
+#endif
+    return expand_row_scalar;
+}
+
+static ExpandRowFn expand_row = NULL;
+
+// ============ 放大器 ============
+
+// 填充颜色表 (CRT滤镜使用荫罩与扫描线)
+static void init_colors(Chip8Scaler* scaler) {
+    // 荫罩：相邻三列分别偏红/绿/蓝
+    static const uint32_t APERTURE[3] = { 0xFFFFD8D8u, 0xFFD8FFD8u, 0xFFD8D8FFu };
+    
+    for (int x = 0; x < scaler->width; x++) {
+        if (scaler->filter == SCALE_FILTER_CRT) {
+            scaler->on_color[0][x] = APERTURE[x % 3];
+            scaler->on_color[1][x] = 0xFF383838u;  // 扫描线：亮像素压暗
+        } else {
+            scaler->on_color[0][x] = COLOR_ON;
+            scaler->on_color[1][x] = COLOR_ON;
+        }
+        scaler->off_color[0][x] = COLOR_OFF;
+        scaler->off_color[1][x] = COLOR_OFF;
+    }
+}
+
+// 初始化放大器
+int chip8_scaler_init(Chip8Scaler* scaler, ScaleFilter filter) {
+    if (!scaler || filter < 0 || filter >= SCALE_FILTER_COUNT) return 0;
+    
+    uint32_t* pixels = scaler->pixels;
+    memset(scaler, 0, sizeof(*scaler));
+    
+    static const int FACTORS[SCALE_FILTER_COUNT] = { 1, 2, 3, 4, 2, 4 };
+    scaler->filter = filter;
+    scaler->factor = FACTORS[filter];
+    scaler->width = SCALE_SRC_WIDTH * scaler->factor;
+    scaler->height = SCALE_SRC_HEIGHT * scaler->factor;
+    scaler->force_full = 1;
+    
+    // 像素缓冲区按最大尺寸分配，切换滤镜时复用
+    scaler->pixels = pixels ? pixels : (uint32_t*)malloc(SCALE_MAX_WIDTH * SCALE_MAX_HEIGHT * sizeof(uint32_t));
+    if (!scaler->pixels) {
+        fprintf(stderr, "错误: 放大缓冲区分配失败\n");
+        return 0;
+    }
+    
+    if (!expand_row) {
+        expand_row = select_expand_kernel();
+    }
+    init_spread3_table();
+    init_colors(scaler);
+    return 1;
+}
+
+// 释放放大器
+void chip8_scaler_cleanup(Chip8Scaler* scaler) {
+    if (!scaler) return;
+    free(scaler->pixels);
+    scaler->pixels = NULL;
+}
+
+// 按当前滤镜生成输出位图
+static void run_filter(Chip8Scaler* scaler, const ScaleBitmap* src) {
+    static ScaleBitmap temp;  // 只在渲染线程中使用
+    
+    switch (scaler->filter) {
+        case SCALE_FILTER_NEAREST:
+            scaler->output = *src;
+            break;
+        case SCALE_FILTER_SCALE2X:
+            scale2x(src, &scaler->output, 0);
+            break;
+        case SCALE_FILTER_SCALE3X:
+            scale3x(src, &scaler->output);
+            break;
+        case SCALE_FILTER_SCALE4X:
+            scale2x(src, &temp, 0);
+            scale2x(&temp, &scaler->output, 0);
+            break;
+        case SCALE_FILTER_EPX:
+            scale2x(src, &scaler->output, 1);
+            break;
+        case SCALE_FILTER_CRT:
+            nearest2x(src, &temp);
+            nearest2x(&temp, &scaler->output);
+            break;
+        default:
+            break;
+    }
+}
+
+// 更新一帧：返回脏行数，脏行已展开到 pixels 中
+int chip8_scaler_update(Chip8Scaler* scaler, const uint64_t* rows) {
+    if (!scaler || !scaler->pixels) return 0;
+    
+    // 输入完全没变化时跳过全部工作
+    if (!scaler->force_full && memcmp(rows, scaler->last_input, sizeof(scaler->last_input)) == 0) {
+        return 0;
+    }
+    memcpy(scaler->last_input, rows, sizeof(scaler->last_input));
+    
+    ScaleBitmap src;
+    src.width = SCALE_SRC_WIDTH;
+    src.height = SCALE_SRC_HEIGHT;
+    src.words = 1;
+    for (int y = 0; y < SCALE_SRC_HEIGHT; y++) {
+        src.rows[y][0] = rows[y];
+    }
+    
+    run_filter(scaler, &src);
+    
+    // 只展开与上一帧不同的输出行
+    const ScaleBitmap* out = &scaler->output;
+    const size_t row_bytes = out->words * sizeof(uint64_t);
+    int dirty = 0;
+    scaler->dirty_first = -1;
+    scaler->dirty_last = -1;
+    
+    for (int y = 0; y < out->height; y++) {
+        if (!scaler->force_full && memcmp(out->rows[y], scaler->previous.rows[y], row_bytes) == 0) {
+            continue;
+        }
+        
+        int kind = (y % scaler->factor == scaler->factor - 1) ? 1 : 0;
+        expand_row(out->rows[y], out->width, scaler->on_color[kind], scaler->off_color[kind],
+                   scaler->pixels + (size_t)y * out->width);
+        memcpy(scaler->previous.rows[y], out->rows[y], row_bytes);
+        
+        if (scaler->dirty_first < 0) scaler->dirty_first = y;
+        scaler->dirty_last = y;
+        dirty++;
+    }
+    
+    scaler->force_full = 0;
+    return dirty;
+}
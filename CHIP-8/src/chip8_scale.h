@@ -0,0 +1,62 @@
+#ifndef CHIP8_SCALE_H
+#define CHIP8_SCALE_H
+
+#include <stdint.h>
+
+// 像素艺术放大滤镜：直接在1位/像素的打包帧上按位运算 (一次处理64个像素)，
+// 只把发生变化的输出行展开为ARGB像素 (SSE2/AVX2)，再上传到流式纹理。
+// 本头文件不依赖SDL。
+
+#define SCALE_SRC_WIDTH 64             // 输入宽度 (CHIP-8显示)
+#define SCALE_SRC_HEIGHT 32            // 输入高度
+#define SCALE_MAX_FACTOR 4             // 最大放大倍数
+#define SCALE_MAX_WIDTH (SCALE_SRC_WIDTH * SCALE_MAX_FACTOR)
+#define SCALE_MAX_HEIGHT (SCALE_SRC_HEIGHT * SCALE_MAX_FACTOR)
+#define SCALE_ROW_WORDS (SCALE_MAX_WIDTH / 64)
+
+// 滤镜类型
+typedef enum {
+    SCALE_FILTER_NEAREST = 0,          // 最近邻 (由GPU放大)
+    SCALE_FILTER_SCALE2X,              // Scale2x (AdvMAME2x)
+    SCALE_FILTER_SCALE3X,              // Scale3x (AdvMAME3x)
+    SCALE_FILTER_SCALE4X,              // Scale4x (两次Scale2x)
+    SCALE_FILTER_EPX,                  // EPX (Eric's Pixel Expansion，原始规则)
+    SCALE_FILTER_CRT,                  // 4倍放大 + 扫描线/荫罩
+    SCALE_FILTER_COUNT
+} ScaleFilter;
+
+// 1位/像素位图，每行若干64位字 (字内最高位为最左像素)
+typedef struct {
+    int width;
+    int height;
+    int words;                         // 每行字数
+    uint64_t rows[SCALE_MAX_HEIGHT][SCALE_ROW_WORDS];
+} ScaleBitmap;
+
+// 放大器状态
+typedef struct Chip8Scaler {
+    ScaleFilter filter;
+    int factor;                        // 输出相对64x32的倍数
+    int width, height;                 // 输出尺寸
+    
+    uint64_t last_input[SCALE_SRC_HEIGHT];  // 上一帧输入 (全部未变化时直接跳过)
+    ScaleBitmap output;                // 本帧输出位图
+    ScaleBitmap previous;              // 上一帧输出位图 (用于计算脏行)
+    int force_full;                    // 下一帧强制全部重绘
+    
+    uint32_t* pixels;                  // ARGB8888输出 (width*height)
+    uint32_t on_color[2][SCALE_MAX_WIDTH];   // 亮像素颜色 [0=普通行, 1=扫描线行]
+    uint32_t off_color[2][SCALE_MAX_WIDTH];  // 暗像素颜色
+    
+    int dirty_first, dirty_last;       // 本帧脏行范围 (输出行，闭区间)
+} Chip8Scaler;
+
+int chip8_scaler_init(Chip8Scaler* scaler, ScaleFilter filter);
+void chip8_scaler_cleanup(Chip8Scaler* scaler);
+// rows: 每行一个64位字 (最高位为x=0)，返回脏行数 (0=无需上传)
+int chip8_scaler_update(Chip8Scaler* scaler, const uint64_t* rows);
+
+const char* chip8_scale_filter_name(ScaleFilter filter);
+int chip8_scale_filter_from_name(const char* name);  // 未知名称返回-1
+
+#endif // CHIP8_SCALE_H
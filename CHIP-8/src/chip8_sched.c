@@ -0,0 +1,378 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "chip8_sched.h"
+#include "chip8_romlib.h"
+
+// 工作线程参数
+typedef struct {
+    Chip8Scheduler* sched;
+    int index;
+} SchedWorker;
+
+static SchedWorker worker_args[SCHED_MAX_WORKERS];
+
+// ---------------------------------------------------------------
+// 运行队列
+// ---------------------------------------------------------------
+
+static void queue_push(Chip8Scheduler* sched, int index, Chip8Session* session) {
+    SchedQueue* q = &sched->queues[index];
+    SDL_LockMutex(q->lock);
+    q->items[(q->head + q->count) % SCHED_MAX_SESSIONS] = session;
+    q->count++;
+    SDL_UnlockMutex(q->lock);
+    
+    // 在 wake_lock 内增加计数并通知，等待中的工作线程不会错过
+    SDL_LockMutex(sched->wake_lock);
+    SDL_AtomicAdd(&sched->pending, 1);
+    SDL_CondSignal(sched->wake);
+    SDL_UnlockMutex(sched->wake_lock);
+}
+
+// 所有者从头部取
+static Chip8Session* queue_pop(SchedQueue* q) {
+    Chip8Session* session = NULL;
+    SDL_LockMutex(q->lock);
+    if (q->count > 0) {
+        session = q->items[q->head];
+        q->head = (q->head + 1) % SCHED_MAX_SESSIONS;
+        q->count--;
+    }
+    SDL_UnlockMutex(q->lock);
+    return session;
+}
+
+// 窃取者从尾部取
+static Chip8Session* queue_steal(SchedQueue* q) {
+    Chip8Session* session = NULL;
+    SDL_LockMutex(q->lock);
+    if (q->count > 0) {
+        q->count--;
+        session = q->items[(q->head + q->count) % SCHED_MAX_SESSIONS];
+    }
+    SDL_UnlockMutex(q->lock);
+    return session;
+}
+
+static Chip8Session* next_session(Chip8Scheduler* sched, int index) {
+    Chip8Session* session = queue_pop(&sched->queues[index]);
+    if (session) return session;
+    
+    for (int i = 1; i < sched->worker_count; i++) {
+        session = queue_steal(&sched->queues[(index + i) % sched->worker_count]);
+        if (session) {
+            SDL_AtomicAdd(&sched->steals, 1);
+            return session;
+        }
+    }
+    return NULL;
+}
+
+// ---------------------------------------------------------------
+// 时间片
+// ---------------------------------------------------------------
+
+// 以 jump_pc 处的向后跳转结束的循环是否在等待DT归零 (FX07 后接 SE VX,0 或 SNE VX,0)
+static int waits_for_dt_zero(const Chip8* chip8, uint16_t jump_pc) {
+    uint16_t jump = chip8_read_opcode(chip8, jump_pc);
+    if ((jump & 0xF000) != 0x1000) return 0;
+    
+    for (uint16_t addr = jump & 0x0FFF; addr + 2 < jump_pc; addr += 2) {
+        uint16_t a = chip8_read_opcode(chip8, addr);
+        uint16_t b = chip8_read_opcode(chip8, addr + 2);
+        if ((a & 0xF0FF) == 0xF007 && (b & 0xFF) == 0x00 &&
+            ((b & 0xF000) == 0x3000 || (b & 0xF000) == 0x4000) && (a & 0x0F00) == (b & 0x0F00)) {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+static int input_pending(Chip8InputQueue* queue) {
+    return SDL_AtomicGet(&queue->head) != SDL_AtomicGet(&queue->tail);
+}
+
+// 运行一帧，返回会话的下一个状态
+static int run_slice(Chip8Scheduler* sched, Chip8Session* s) {
+    Chip8* chip8 = &s->core;
+    
+    // 补上挂起期间的帧：这些帧一直在执行同一个纯循环 (只读按键和非零的DT)，
+    // 累计效果只是循环内的位置前进了 (帧数*每帧指令数) mod 循环长度 条指令。
+    // 没有挂起只是迟到的会话不补帧 (节拍线程已计入 late)
+    if (s->parked && s->last_tick && s->run_tick > s->last_tick + 1) {
+        uint64_t skipped = s->run_tick - s->last_tick - 1;
+        if (s->loop_length > 1) {
+            uint64_t advance = skipped * (uint64_t)s->governor.effective_ipf % (uint64_t)s->loop_length;
+            for (uint64_t i = 0; i < advance; i++) {
+                chip8_cycle(chip8);
+            }
+        }
+        chip8->delay_timer = skipped < chip8->delay_timer ? (uint8_t)(chip8->delay_timer - skipped) : 0;
+        chip8->sound_timer = skipped < chip8->sound_timer ? (uint8_t)(chip8->sound_timer - skipped) : 0;
+        s->frame += skipped;
+        SDL_AtomicAdd(&sched->skipped_frames, (int)skipped);
+    }
+    
+    chip8_input_apply(&s->input, chip8, UINT64_MAX);
+    
+    int budget = chip8_governor_begin(&s->governor);
+    int executed = 0;
+    int idle = 0;
+    while (executed < budget) {
+        uint16_t pc = chip8->pc;
+        uint16_t opcode = chip8_read_opcode(chip8, pc);
+        chip8_cycle(chip8);
+        executed++;
+        if (chip8_governor_spinning(&s->governor, chip8, pc, opcode)) {
+            idle = 1;
+            break;
+        }
+    }
+    chip8_governor_end(&s->governor, executed, 0.0, idle);
+    
+    // 本帧剩余的指令只是在循环里打转，执行不足一周的部分使循环位置与逐条执行一致
+    if (idle) {
+        s->loop_length = s->governor.loop_length > 0 ? s->governor.loop_length : 1;
+        for (int i = (budget - executed) % s->loop_length; i > 0; i--) {
+            chip8_cycle(chip8);
+        }
+    } else {
+        s->loop_length = 0;
+    }
+    
+    chip8_update_timers(chip8);
+    s->frame++;
+    s->last_tick = s->run_tick;
+    s->parked = 0;
+    
+    if (chip8->draw_flag) {
+        chip8->draw_flag = 0;
+        if (sched->on_frame) {
+            uint8_t packed[DISPLAY_PACKED_SIZE];
+            chip8_pack_display(chip8, packed);
+            sched->on_frame(s, packed, s->frame);
+        }
+    }
+    
+    if (!idle || input_pending(&s->input)) return SESSION_IDLE;
+    
+    // 等待按键：只由输入唤醒；等待DT归零：在DT归零后的第一帧唤醒；
+    // 其他忙等循环 (例如比较DT与非零值) 无法确定退出时间，下一个节拍照常运行
+    if (chip8->key_wait) {
+        s->wake_tick = SCHED_NEVER;
+    } else if (chip8->delay_timer == 0) {
+        s->wake_tick = SCHED_NEVER;
+    } else if (waits_for_dt_zero(chip8, s->governor.loop_pc)) {
+        s->wake_tick = s->run_tick + chip8->delay_timer + 1;
+    } else {
+        return SESSION_IDLE;
+    }
+    s->parked = 1;
+    return SESSION_PARKED;
+}
+
+static int worker_thread(void* data) {
+    SchedWorker* worker = (SchedWorker*)data;
+    Chip8Scheduler* sched = worker->sched;
+    
+    while (SDL_AtomicGet(&sched->running)) {
+        Chip8Session* s = next_session(sched, worker->index);
+        if (!s) {
+            SDL_LockMutex(sched->wake_lock);
+            if (SDL_AtomicGet(&sched->pending) == 0 && SDL_AtomicGet(&sched->running)) {
+                SDL_CondWaitTimeout(sched->wake, sched->wake_lock, 100);
+            }
+            SDL_UnlockMutex(sched->wake_lock);
+            continue;
+        }
+        SDL_AtomicAdd(&sched->pending, -1);
+        SDL_AtomicIncRef(&s->busy);
+        
+        SDL_AtomicSet(&s->state, SESSION_RUNNING);
+        int next = SDL_AtomicGet(&s->closing) ? SESSION_CLOSED : run_slice(sched, s);
+        SDL_AtomicAdd(&sched->slices, 1);
+        
+        if (SDL_AtomicGet(&s->closing)) next = SESSION_CLOSED;
+        // 发布后节拍线程可能立即重新入队、另一个工作线程接手；
+        // busy 仍计着本线程，节拍线程不会在下面的检查期间释放会话
+        SDL_AtomicSet(&s->state, next);
+        
+        // 挂起的同时收到输入：改为下一个节拍运行
+        if (next == SESSION_PARKED && input_pending(&s->input)) {
+            SDL_AtomicCAS(&s->state, SESSION_PARKED, SESSION_IDLE);
+        }
+        SDL_AtomicAdd(&s->busy, -1);  // 之后不再访问该会话 (其他工作线程可能已经持有)
+    }
+    return 0;
+}
+
+// ---------------------------------------------------------------
+// 接口
+// ---------------------------------------------------------------
+
+int chip8_sched_start(Chip8Scheduler* sched, int workers, SchedFrameCallback on_frame, SchedCloseCallback on_close) {
+    memset(sched, 0, sizeof(*sched));
+    if (workers <= 0) workers = SDL_GetCPUCount();
+    if (workers > SCHED_MAX_WORKERS) workers = SCHED_MAX_WORKERS;
+    
+    sched->on_frame = on_frame;
+    sched->on_close = on_close;
+    sched->worker_count = workers;
+    sched->lock = SDL_CreateMutex();
+    sched->wake_lock = SDL_CreateMutex();
+    sched->wake = SDL_CreateCond();
+    if (!sched->lock || !sched->wake_lock || !sched->wake) {
+        fprintf(stderr, "错误: 无法创建调度器同步对象: %s\n", SDL_GetError());
+        return 0;
+    }
+    for (int i = 0; i < workers; i++) {
+        sched->queues[i].lock = SDL_CreateMutex();
+        if (!sched->queues[i].lock) return 0;
+    }
+    
+    SDL_AtomicSet(&sched->running, 1);
+    for (int i = 0; i < workers; i++) {
+        worker_args[i].sched = sched;
+        worker_args[i].index = i;
+        sched->threads[i] = SDL_CreateThread(worker_thread, "chip8_sched", &worker_args[i]);
+        if (!sched->threads[i]) {
+            fprintf(stderr, "错误: 无法创建工作线程: %s\n", SDL_GetError());
+            sched->worker_count = i;
+            chip8_sched_stop(sched);
+            return 0;
+        }
+    }
+    return 1;
+}
+
+void chip8_sched_stop(Chip8Scheduler* sched) {
+    SDL_AtomicSet(&sched->running, 0);
+    SDL_LockMutex(sched->wake_lock);
+    SDL_CondBroadcast(sched->wake);
+    SDL_UnlockMutex(sched->wake_lock);
+    
+    for (int i = 0; i < sched->worker_count; i++) {
+        if (sched->threads[i]) SDL_WaitThread(sched->threads[i], NULL);
+        sched->threads[i] = NULL;
+    }
+    
+    for (int i = 0; i < sched->session_count; i++) {
+        if (sched->on_close) sched->on_close(sched->sessions[i]);
+        free(sched->sessions[i]);
+    }
+    sched->session_count = 0;
+    
+    for (int i = 0; i < SCHED_MAX_WORKERS; i++) {
+        if (sched->queues[i].lock) SDL_DestroyMutex(sched->queues[i].lock);
+        sched->queues[i].lock = NULL;
+    }
+    if (sched->wake) SDL_DestroyCond(sched->wake);
+    if (sched->wake_lock) SDL_DestroyMutex(sched->wake_lock);
+    if (sched->lock) SDL_DestroyMutex(sched->lock);
+    sched->wake = NULL;
+    sched->wake_lock = NULL;
+    sched->lock = NULL;
+}
+
+Chip8Session* chip8_sched_open(Chip8Scheduler* sched, const uint8_t* rom, size_t size,
+                               unsigned int seed, int ipf, void* user) {
+    Chip8Session* s = (Chip8Session*)calloc(1, sizeof(Chip8Session));
+    if (!s) return NULL;
+    
+    s->core.quiet = 1;
+    chip8_reset(&s->core, seed);
+    if (!chip8_load_rom_data(&s->core, rom, size)) {
+        free(s);
+        return NULL;
+    }
+    
+    if (ipf <= 0) {
+        RomEntry entry;
+        chip8_romlib_analyze(rom, size, &entry);
+        ipf = chip8_governor_profile_ipf(&entry);
+    }
+    chip8_governor_init(&s->governor, ipf, 1.0);
+    chip8_input_init(&s->input);
+    SDL_AtomicSet(&s->state, SESSION_IDLE);
+    SDL_AtomicSet(&s->closing, 0);
+    s->user = user;
+    
+    SDL_LockMutex(sched->lock);
+    if (sched->session_count >= SCHED_MAX_SESSIONS) {
+        SDL_UnlockMutex(sched->lock);
+        fprintf(stderr, "警告: 会话数已达上限 (%d)\n", SCHED_MAX_SESSIONS);
+        free(s);
+        return NULL;
+    }
+    s->id = ++sched->next_id;
+    s->home = s->id % sched->worker_count;
+    chip8_rng_init(&s->core.rng, CHIP8_RNG_PHILOX, seed, (uint32_t)s->id);  // 同一种子下各会话的序列相互独立
+    sched->sessions[sched->session_count++] = s;
+    SDL_UnlockMutex(sched->lock);
+    return s;
+}
+
+void chip8_sched_close(Chip8Scheduler* sched, Chip8Session* session) {
+    (void)sched;
+    SDL_AtomicSet(&session->closing, 1);
+    // 不在运行队列中的会话直接标记为已关闭，正在运行的由工作线程标记
+    if (!SDL_AtomicCAS(&session->state, SESSION_IDLE, SESSION_CLOSED)) {
+        SDL_AtomicCAS(&session->state, SESSION_PARKED, SESSION_CLOSED);
+    }
+}
+
+void chip8_sched_input(Chip8Scheduler* sched, Chip8Session* session, uint8_t key, int pressed) {
+    (void)sched;
+    chip8_input_push(&session->input, SDL_GetPerformanceCounter(), key, pressed);
+    SDL_AtomicCAS(&session->state, SESSION_PARKED, SESSION_IDLE);
+}
+
+void chip8_sched_tick(Chip8Scheduler* sched) {
+    SDL_LockMutex(sched->lock);
+    uint64_t tick = ++sched->tick;
+    
+    int i = 0;
+    while (i < sched->session_count) {
+        Chip8Session* s = sched->sessions[i];
+        int state = SDL_AtomicGet(&s->state);
+        
+        if (state == SESSION_CLOSED) {
+            if (SDL_AtomicGet(&s->busy)) {
+                i++;  // 工作线程还在收尾，下一个节拍再释放
+                continue;
+            }
+            if (sched->on_close) sched->on_close(s);
+            free(s);
+            sched->sessions[i] = sched->sessions[--sched->session_count];
+            continue;
+        }
+        
+        if (state == SESSION_IDLE || (state == SESSION_PARKED && s->wake_tick <= tick)) {
+            // 只有CAS成功的一方可以放入队列 (与输入唤醒、关闭竞争)
+            if (SDL_AtomicCAS(&s->state, state, SESSION_QUEUED)) {
+                s->run_tick = tick;
+                queue_push(sched, s->home, s);
+            }
+        } else if (state == SESSION_QUEUED || state == SESSION_RUNNING) {
+            sched->late++;  // 上一帧还没运行完，本节拍跳过
+        }
+        i++;
+    }
+    SDL_UnlockMutex(sched->lock);
+}
+
+void chip8_sched_stats(Chip8Scheduler* sched, SchedStats* stats) {
+    memset(stats, 0, sizeof(*stats));
+    SDL_LockMutex(sched->lock);
+    stats->sessions = sched->session_count;
+    for (int i = 0; i < sched->session_count; i++) {
+        if (SDL_AtomicGet(&sched->sessions[i]->state) == SESSION_PARKED) stats->parked++;
+    }
+    stats->late = sched->late;
+    SDL_UnlockMutex(sched->lock);
+    
+    stats->slices = (uint32_t)SDL_AtomicGet(&sched->slices);
+    stats->steals = (uint32_t)SDL_AtomicGet(&sched->steals);
+    stats->skipped_frames = (uint32_t)SDL_AtomicGet(&sched->skipped_frames);
+}
@@ -0,0 +1,116 @@
+#ifndef CHIP8_SCHED_H
+#define CHIP8_SCHED_H
+
+#include <SDL2/SDL.h>
+#include "chip8.h"
+#include "chip8_input.h"
+#include "chip8_governor.h"
+
+// 会话调度器：少量工作线程协作运行大量CHIP-8会话。
+// 每个会话每次运行一个模拟帧 (一个时间片，不会被抢占)，由调用者以60Hz调用
+// chip8_sched_tick 把到期的会话放入所属工作线程的运行队列，空闲的工作线程从其他队列尾部窃取。
+// 程序在 FX0A 或忙等循环中空转时会话挂起：等待按键的会话直到收到输入才恢复，
+// 等待DT归零的循环 (FX07 后接 3X00/4X00) 在DT归零的那一帧恢复，
+// 挂起期间的定时器递减和循环的执行位置在恢复时一次补上，结果与逐帧运行相同。
+// 输入唤醒的会话在下一个节拍运行，每个节拍每个会话最多运行一帧
+
+#define SCHED_MAX_SESSIONS 1024
+#define SCHED_MAX_WORKERS 64
+#define SCHED_NEVER UINT64_MAX     // 只由输入唤醒
+
+// 会话状态
+typedef enum {
+    SESSION_IDLE = 0,          // 等待下一个节拍
+    SESSION_QUEUED,            // 已放入运行队列
+    SESSION_RUNNING,           // 工作线程正在运行
+    SESSION_PARKED,            // 挂起，等待输入或定时器
+    SESSION_CLOSED             // 已关闭，等待释放
+} SessionState;
+
+struct Chip8Scheduler;
+
+typedef struct Chip8Session {
+    int id;
+    Chip8 core;
+    Chip8Governor governor;    // 每帧指令数与空转检测
+    Chip8InputQueue input;     // 输入事件 (调用者线程 -> 工作线程)
+    SDL_atomic_t state;        // SessionState
+    SDL_atomic_t closing;      // 已请求关闭
+    SDL_atomic_t busy;         // 持有该会话的工作线程数 (为0之前不能释放)。
+                               // 发布新状态后会话可能立即被另一个工作线程取走，所以用计数而不是标志
+    int home;                  // 所属工作线程
+    uint64_t frame;            // 已模拟的帧数 (含挂起期间补上的帧)
+    uint64_t run_tick;         // 本次运行对应的调度器节拍 (放入队列时设置)
+    uint64_t last_tick;        // 上次运行时的调度器节拍
+    uint64_t wake_tick;        // 挂起的会话在该节拍恢复 (SCHED_NEVER=只由输入唤醒)
+    int loop_length;           // 空转循环一周的指令数 (0=上一帧没有空转)
+    int parked;                // 上一帧结束时挂起 (只有挂起期间的帧需要补上)
+    void* user;                // 调用者数据 (如客户端连接)
+} Chip8Session;
+
+// 每个工作线程的运行队列 (环形，所有者从头部取，窃取者从尾部取)
+typedef struct {
+    Chip8Session* items[SCHED_MAX_SESSIONS];
+    int head;
+    int count;
+    SDL_mutex* lock;
+} SchedQueue;
+
+// 运行统计
+typedef struct {
+    int sessions;
+    int parked;
+    uint64_t slices;           // 已运行的时间片
+    uint64_t steals;           // 窃取到的时间片
+    uint64_t late;             // 节拍到来时上一帧还没运行完的次数
+    uint64_t skipped_frames;   // 挂起期间跳过的帧
+} SchedStats;
+
+// 帧输出回调 (在工作线程上调用，只在显示变化时调用)
+typedef void (*SchedFrameCallback)(Chip8Session* session, const uint8_t* packed, uint64_t frame);
+// 会话释放前的回调 (在调用 chip8_sched_tick 的线程上调用)
+typedef void (*SchedCloseCallback)(Chip8Session* session);
+
+typedef struct Chip8Scheduler {
+    SchedQueue queues[SCHED_MAX_WORKERS];
+    SDL_Thread* threads[SCHED_MAX_WORKERS];
+    int worker_count;
+    SDL_atomic_t running;
+    SDL_mutex* wake_lock;
+    SDL_cond* wake;            // 有新的时间片时唤醒工作线程
+    SDL_atomic_t pending;      // 所有队列中的时间片总数
+    
+    SDL_mutex* lock;           // 保护会话表
+    Chip8Session* sessions[SCHED_MAX_SESSIONS];
+    int session_count;
+    int next_id;
+    uint64_t tick;             // 调度器节拍 (60Hz)
+    
+    SchedFrameCallback on_frame;
+    SchedCloseCallback on_close;
+    
+    // 统计 (工作线程更新的计数用原子变量)
+    SDL_atomic_t slices;
+    SDL_atomic_t steals;
+    SDL_atomic_t skipped_frames;
+    uint64_t late;
+} Chip8Scheduler;
+
+int chip8_sched_start(Chip8Scheduler* sched, int workers, SchedFrameCallback on_frame, SchedCloseCallback on_close);
+void chip8_sched_stop(Chip8Scheduler* sched);
+
+// 新建会话 (ipf<=0 时按ROM平台选择每帧指令数)，随机数按 (seed, 会话编号) 生成，返回NULL表示失败
+Chip8Session* chip8_sched_open(Chip8Scheduler* sched, const uint8_t* rom, size_t size,
+                               unsigned int seed, int ipf, void* user);
+// 请求关闭，会话在下一个节拍释放，之后不能再使用该指针
+void chip8_sched_close(Chip8Scheduler* sched, Chip8Session* session);
+
+// 输入事件，挂起的会话在下一个节拍恢复运行
+void chip8_sched_input(Chip8Scheduler* sched, Chip8Session* session, uint8_t key, int pressed);
+
+// 60Hz节拍：释放已关闭的会话，把到期的会话放入运行队列
+void chip8_sched_tick(Chip8Scheduler* sched);
+
+void chip8_sched_stats(Chip8Scheduler* sched, SchedStats* stats);
+
+#endif // CHIP8_SCHED_H
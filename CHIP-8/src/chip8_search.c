@@ -0,0 +1,301 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "chip8_search.h"
+
+#if defined(__SSE2__)
+#define SEARCH_SSE2 1
+#include <emmintrin.h>
+#endif
+
+#define SEARCH_LANES 16                // 每次比较的地址数
+
+static const char* OP_NAMES[SEARCH_OP_COUNT] = {
+    "eq", "ne", "lt", "gt", "ch", "un", "inc", "dec", "delta", "reg"
+};
+
+const char* chip8_search_op_name(Chip8SearchOp op) {
+    if ((int)op < 0 || op >= SEARCH_OP_COUNT) return "?";
+    return OP_NAMES[op];
+}
+
+int chip8_search_op_from_name(const char* name) {
+    for (int i = 0; i < SEARCH_OP_COUNT; i++) {
+        if (strcmp(name, OP_NAMES[i]) == 0) return i;
+    }
+    return -1;
+}
+
+int chip8_search_init(Chip8Search* search, int instances, int capacity) {
+    memset(search, 0, sizeof(*search));
+    search->instances = instances > 0 ? instances : 1;
+    search->capacity = capacity > 1 ? capacity : SEARCH_DEFAULT_SNAPSHOTS;
+    
+    size_t frame = (size_t)search->instances * MEMORY_SIZE;
+    search->candidates = (uint8_t*)malloc(frame);
+    search->snapshots = (uint8_t*)malloc(frame * search->capacity);
+    search->registers = (uint8_t*)malloc((size_t)search->instances * 16 * search->capacity);
+    if (!search->candidates || !search->snapshots || !search->registers) {
+        fprintf(stderr, "错误: 内存搜索缓冲区分配失败 (%d个实例, %d个快照)\n", search->instances, search->capacity);
+        chip8_search_cleanup(search);
+        return 0;
+    }
+    
+    chip8_search_reset(search);
+    return 1;
+}
+
+void chip8_search_cleanup(Chip8Search* search) {
+    free(search->candidates);
+    free(search->snapshots);
+    free(search->registers);
+    search->candidates = NULL;
+    search->snapshots = NULL;
+    search->registers = NULL;
+}
+
+void chip8_search_reset(Chip8Search* search) {
+    memset(search->candidates, 0xFF, (size_t)search->instances * MEMORY_SIZE);
+    search->taken = 0;
+    search->filtered = 0;
+}
+
+// 第 index 个快照中实例 instance 的内存和寄存器
+static const uint8_t* snapshot_memory(const Chip8Search* search, uint64_t index, int instance) {
+    size_t slot = (size_t)(index % (uint64_t)search->capacity);
+    return search->snapshots + (slot * search->instances + instance) * MEMORY_SIZE;
+}
+
+static const uint8_t* snapshot_registers(const Chip8Search* search, uint64_t index, int instance) {
+    size_t slot = (size_t)(index % (uint64_t)search->capacity);
+    return search->registers + (slot * search->instances + instance) * 16;
+}
+
+void chip8_search_snapshot(Chip8Search* search, const Chip8* first, size_t stride) {
+    size_t slot = (size_t)(search->taken % (uint64_t)search->capacity);
+    for (int i = 0; i < search->instances; i++) {
+        const Chip8* chip8 = (const Chip8*)((const uint8_t*)first + (size_t)i * stride);
+        memcpy(search->snapshots + (slot * search->instances + i) * MEMORY_SIZE, chip8->memory, MEMORY_SIZE);
+        memcpy(search->registers + (slot * search->instances + i) * 16, chip8->V, 16);
+    }
+    search->taken++;
+}
+
+static int compares_previous(Chip8SearchOp op) {
+    return op == SEARCH_CHANGED || op == SEARCH_UNCHANGED || op == SEARCH_INCREASED ||
+           op == SEARCH_DECREASED || op == SEARCH_DELTA;
+}
+
+// ============ 比较核心 ============
+
+// 快照 k 上的一遍筛选：只处理 live 中列出的16字节组 (组内还有候选)，
+// 返回本遍之后仍有候选的组数 (live 原地压缩)。按快照顺序流式读取，
+// 已经全部排除的组不再读取之后的快照
+
+#ifndef SEARCH_SSE2
+static int filter_pass_scalar(const Chip8Search* search, const Chip8SearchFilter* filter, int instance,
+                              uint64_t k, uint8_t* candidates, uint16_t* live, int live_count) {
+    const uint8_t* cur_base = snapshot_memory(search, k, instance);
+    const uint8_t* prev_base = compares_previous(filter->op) ? snapshot_memory(search, k - 1, instance) : cur_base;
+    uint8_t value = (uint8_t)filter->value;
+    if (filter->op == SEARCH_REGISTER) {
+        value = (uint8_t)(snapshot_registers(search, k, instance)[filter->reg] + filter->value);
+    }
+    
+    int kept = 0;
+    for (int n = 0; n < live_count; n++) {
+        const uint8_t* cur = cur_base + live[n];
+        const uint8_t* prev = prev_base + live[n];
+        uint8_t* mask = candidates + live[n];
+        int alive = 0;
+        for (int j = 0; j < SEARCH_LANES; j++) {
+            int keep;
+            switch (filter->op) {
+                case SEARCH_EQ:        keep = cur[j] == value; break;
+                case SEARCH_NE:        keep = cur[j] != value; break;
+                case SEARCH_LT:        keep = cur[j] < value; break;
+                case SEARCH_GT:        keep = cur[j] > value; break;
+                case SEARCH_CHANGED:   keep = cur[j] != prev[j]; break;
+                case SEARCH_UNCHANGED: keep = cur[j] == prev[j]; break;
+                case SEARCH_INCREASED: keep = cur[j] > prev[j]; break;
+                case SEARCH_DECREASED: keep = cur[j] < prev[j]; break;
+                case SEARCH_DELTA:     keep = cur[j] == (uint8_t)(prev[j] + value); break;
+                default:               keep = cur[j] == value; break;  // SEARCH_REGISTER
+            }
+            if (!keep) mask[j] = 0;
+            alive |= mask[j];
+        }
+        if (alive) live[kept++] = live[n];
+    }
+    return kept;
+}
+#else
+// SSE2 没有无符号字节比较：两边都翻转最高位后用有符号比较
+static inline __m128i gt_epu8(__m128i a, __m128i b) {
+    const __m128i bias = _mm_set1_epi8((char)0x80);
+    return _mm_cmpgt_epi8(_mm_xor_si128(a, bias), _mm_xor_si128(b, bias));
+}
+
+static int filter_pass_sse2(const Chip8Search* search, const Chip8SearchFilter* filter, int instance,
+                            uint64_t k, uint8_t* candidates, uint16_t* live, int live_count) {
+    const uint8_t* cur_base = snapshot_memory(search, k, instance);
+    const uint8_t* prev_base = compares_previous(filter->op) ? snapshot_memory(search, k - 1, instance) : cur_base;
+    int value = filter->value;
+    if (filter->op == SEARCH_REGISTER) {
+        value += snapshot_registers(search, k, instance)[filter->reg];
+    }
+    const __m128i values = _mm_set1_epi8((char)value);
+    const __m128i ones = _mm_set1_epi8((char)0xFF);
+    
+    int kept = 0;
+    for (int n = 0; n < live_count; n++) {
+        __m128i cur = _mm_loadu_si128((const __m128i*)(cur_base + live[n]));
+        __m128i prev = _mm_loadu_si128((const __m128i*)(prev_base + live[n]));
+        __m128i keep;
+        switch (filter->op) {
+            case SEARCH_EQ:        keep = _mm_cmpeq_epi8(cur, values); break;
+            case SEARCH_NE:        keep = _mm_xor_si128(_mm_cmpeq_epi8(cur, values), ones); break;
+            case SEARCH_LT:        keep = gt_epu8(values, cur); break;
+            case SEARCH_GT:        keep = gt_epu8(cur, values); break;
+            case SEARCH_CHANGED:   keep = _mm_xor_si128(_mm_cmpeq_epi8(cur, prev), ones); break;
+            case SEARCH_UNCHANGED: keep = _mm_cmpeq_epi8(cur, prev); break;
+            case SEARCH_INCREASED: keep = gt_epu8(cur, prev); break;
+            case SEARCH_DECREASED: keep = gt_epu8(prev, cur); break;
+            case SEARCH_DELTA:     keep = _mm_cmpeq_epi8(cur, _mm_add_epi8(prev, values)); break;
+            default:               keep = _mm_cmpeq_epi8(cur, values); break;  // SEARCH_REGISTER
+        }
+        
+        __m128i* mask_ptr = (__m128i*)(candidates + live[n]);
+        __m128i mask = _mm_and_si128(_mm_loadu_si128(mask_ptr), keep);
+        _mm_storeu_si128(mask_ptr, mask);
+        if (_mm_movemask_epi8(mask)) live[kept++] = live[n];
+    }
+    return kept;
+}
+#endif
+
+int chip8_search_filter(Chip8Search* search, const Chip8SearchFilter* filter) {
+    if ((int)filter->op < 0 || filter->op >= SEARCH_OP_COUNT || filter->reg < 0 || filter->reg > 15) return 0;
+    
+    // 参与比较的快照范围 [first, last]：比较前一个快照时 first-1 也必须还在缓冲区中
+    const int previous = compares_previous(filter->op);
+    uint64_t oldest = search->taken > (uint64_t)search->capacity ? search->taken - search->capacity : 0;
+    if (search->taken < (uint64_t)(previous ? 2 : 1)) return 0;
+    uint64_t last = search->taken - 1;
+    uint64_t first = last;
+    if (filter->all && search->filtered < search->taken) {
+        first = search->filtered;
+        if (first < oldest + (uint64_t)previous) first = oldest + (uint64_t)previous;
+        if (first > last) first = last;
+    }
+    
+    uint16_t live[MEMORY_SIZE / SEARCH_LANES];
+    for (int i = 0; i < search->instances; i++) {
+        uint8_t* candidates = search->candidates + (size_t)i * MEMORY_SIZE;
+        
+        // 还有候选的组
+        int live_count = 0;
+        for (int offset = 0; offset < MEMORY_SIZE; offset += SEARCH_LANES) {
+            uint64_t lo, hi;
+            memcpy(&lo, candidates + offset, sizeof(lo));
+            memcpy(&hi, candidates + offset + 8, sizeof(hi));
+            if (lo | hi) live[live_count++] = (uint16_t)offset;
+        }
+        
+        for (uint64_t k = first; k <= last && live_count > 0; k++) {
+#ifdef SEARCH_SSE2
+            live_count = filter_pass_sse2(search, filter, i, k, candidates, live, live_count);
+#else
+            live_count = filter_pass_scalar(search, filter, i, k, candidates, live, live_count);
+#endif
+        }
+    }
+    
+    search->filtered = search->taken;
+    return 1;
+}
+
+uint64_t chip8_search_count(const Chip8Search* search) {
+    const uint8_t* candidates = search->candidates;
+    size_t size = (size_t)search->instances * MEMORY_SIZE;
+    uint64_t count = 0;
+    size_t i = 0;
+#ifdef SEARCH_SSE2
+    for (; i + SEARCH_LANES <= size; i += SEARCH_LANES) {
+        count += (uint64_t)__builtin_popcount((unsigned)_mm_movemask_epi8(_mm_loadu_si128((const __m128i*)(candidates + i))));
+    }
+#endif
+    for (; i < size; i++) {
+        count += candidates[i] != 0;
+    }
+    return count;
+}
+
+int chip8_search_list(const Chip8Search* search, Chip8SearchHit* hits, int max) {
+    int count = 0;
+    for (int i = 0; i < search->instances && count < max; i++) {
+        const uint8_t* candidates = search->candidates + (size_t)i * MEMORY_SIZE;
+        for (int addr = 0; addr < MEMORY_SIZE && count < max; addr++) {
+            if (candidates[addr]) {
+                hits[count].instance = i;
+                hits[count].addr = (uint16_t)addr;
+                count++;
+            }
+        }
+    }
+    return count;
+}
+
+uint8_t chip8_search_value(const Chip8Search* search, int instance, uint16_t addr) {
+    if (search->taken == 0) return 0;
+    return snapshot_memory(search, search->taken - 1, instance)[addr & MEMORY_MASK];
+}
+
+// ============ 冻结 ============
+
+int chip8_search_freeze(Chip8Search* search, int instance, uint16_t addr, uint8_t value) {
+    addr &= MEMORY_MASK;
+    for (int i = 0; i < search->freeze_count; i++) {
+        if (search->freezes[i].instance == instance && search->freezes[i].addr == addr) {
+            search->freezes[i].value = value;
+            return 1;
+        }
+    }
+    if (search->freeze_count >= SEARCH_MAX_FREEZES) return 0;
+    
+    Chip8Freeze* freeze = &search->freezes[search->freeze_count++];
+    freeze->instance = instance;
+    freeze->addr = addr;
+    freeze->value = value;
+    return 1;
+}
+
+void chip8_search_unfreeze(Chip8Search* search, int instance, uint16_t addr) {
+    addr &= MEMORY_MASK;
+    for (int i = 0; i < search->freeze_count; i++) {
+        if (search->freezes[i].instance == instance && search->freezes[i].addr == addr) {
+            search->freezes[i] = search->freezes[--search->freeze_count];
+            return;
+        }
+    }
+}
+
+static void write_frozen(Chip8* chip8, uint16_t addr, uint8_t value) {
+    chip8->memory[addr] = value;
+    chip8_memory_sync(chip8, addr, 1);
+}
+
+void chip8_search_apply_freezes(const Chip8Search* search, Chip8* first, size_t stride) {
+    for (int f = 0; f < search->freeze_count; f++) {
+        const Chip8Freeze* freeze = &search->freezes[f];
+        if (freeze->instance >= 0) {
+            if (freeze->instance < search->instances) {
+                write_frozen((Chip8*)((uint8_t*)first + (size_t)freeze->instance * stride), freeze->addr, freeze->value);
+            }
+            continue;
+        }
+        for (int i = 0; i < search->instances; i++) {
+            write_frozen((Chip8*)((uint8_t*)first + (size_t)i * stride), freeze->addr, freeze->value);
+        }
+    }
+}
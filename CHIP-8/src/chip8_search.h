@@ -0,0 +1,88 @@
+#ifndef CHIP8_SEARCH_H
+#define CHIP8_SEARCH_H
+
+#include "chip8.h"
+
+// 内存搜索 (找分数、生命数、关卡等所在的字节)：
+// 逐帧保存 4KB 内存的快照，用条件逐步排除候选地址。每个实例的每个地址有一个候选掩码字节，
+// 筛选按快照顺序流式读取，每16字节一组用SIMD比较，同一组候选全部排除后不再读取该组
+// 后面的快照，在几千个快照上筛选也只需几十毫秒。一次搜索可以覆盖多个并行实例 (例如 chip8_env 的 cores)。
+// 冻结的地址在每批 chip8_cycle 之前写回固定值
+
+#define SEARCH_DEFAULT_SNAPSHOTS 4096  // 默认保留的快照数 (环形，超出后覆盖最早的)
+#define SEARCH_MAX_FREEZES 32
+
+typedef enum {
+    SEARCH_EQ = 0,             // 当前值 == value
+    SEARCH_NE,                 // 当前值 != value
+    SEARCH_LT,                 // 当前值 < value (无符号)
+    SEARCH_GT,                 // 当前值 > value
+    SEARCH_CHANGED,            // 与前一个快照不同
+    SEARCH_UNCHANGED,          // 与前一个快照相同
+    SEARCH_INCREASED,          // 比前一个快照大
+    SEARCH_DECREASED,          // 比前一个快照小
+    SEARCH_DELTA,              // 当前值 == 前一个快照 + value (模256，减少N用 -N)
+    SEARCH_REGISTER,           // 当前值 == 拍快照时的 V[reg] + value
+    SEARCH_OP_COUNT
+} Chip8SearchOp;
+
+typedef struct {
+    Chip8SearchOp op;
+    int value;
+    int reg;                   // SEARCH_REGISTER 使用的寄存器 (0-15)
+    int all;                   // 0=只看最新的快照 (和前一个)；1=上次筛选以来的每个快照都要满足
+} Chip8SearchFilter;
+
+typedef struct {
+    int instance;              // -1=所有实例
+    uint16_t addr;
+    uint8_t value;
+} Chip8Freeze;
+
+typedef struct {
+    int instance;
+    uint16_t addr;
+} Chip8SearchHit;
+
+typedef struct {
+    int instances;
+    int capacity;              // 快照环形缓冲区容量
+    uint8_t* candidates;       // [instances][MEMORY_SIZE]，0xFF=仍是候选
+    uint8_t* snapshots;        // [capacity][instances][MEMORY_SIZE]
+    uint8_t* registers;        // [capacity][instances][16]，拍快照时的 V0-VF
+    uint64_t taken;            // 已拍的快照总数
+    uint64_t filtered;         // 上次筛选时的 taken (之后的快照参与下一次 all 筛选)
+    
+    Chip8Freeze freezes[SEARCH_MAX_FREEZES];
+    int freeze_count;
+} Chip8Search;
+
+int chip8_search_init(Chip8Search* search, int instances, int capacity);
+void chip8_search_cleanup(Chip8Search* search);
+
+// 重新开始：所有地址都是候选，清空快照 (冻结保留)
+void chip8_search_reset(Chip8Search* search);
+
+// 给 instances 个实例拍快照 (实例之间相隔 stride 字节，单个实例时 stride 不使用)
+void chip8_search_snapshot(Chip8Search* search, const Chip8* first, size_t stride);
+
+// 按条件排除候选，快照不够 (比较前一个快照至少需要两个) 时返回0
+int chip8_search_filter(Chip8Search* search, const Chip8SearchFilter* filter);
+
+uint64_t chip8_search_count(const Chip8Search* search);
+
+// 按实例、地址顺序列出最多 max 个候选，返回实际个数
+int chip8_search_list(const Chip8Search* search, Chip8SearchHit* hits, int max);
+
+// 最新快照中的值
+uint8_t chip8_search_value(const Chip8Search* search, int instance, uint16_t addr);
+
+// 冻结：instance=-1 时作用于所有实例；同一地址再次冻结时替换数值。表已满时返回0
+int chip8_search_freeze(Chip8Search* search, int instance, uint16_t addr, uint8_t value);
+void chip8_search_unfreeze(Chip8Search* search, int instance, uint16_t addr);
+void chip8_search_apply_freezes(const Chip8Search* search, Chip8* first, size_t stride);
+
+const char* chip8_search_op_name(Chip8SearchOp op);
+int chip8_search_op_from_name(const char* name);  // 未知名称返回-1
+
+#endif // CHIP8_SEARCH_H
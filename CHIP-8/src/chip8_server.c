@@ -0,0 +1,468 @@
+// chip8_server.c - 多会话服务：少量工作线程运行大量CHIP-8会话，
+// 客户端通过本地套接字打开ROM、发送按键并接收帧
+//
+// 协议 (客户端 -> 服务，每行一条命令):
+//   OPEN <ROM路径>        打开会话，回复 "OK <会话号>" 或 "ERR <原因>"
+//   K <按键0-F> <0|1>     按键松开/按下
+//   QUIT                  关闭会话并断开
+// 服务 -> 客户端: 显示变化时发送 "F <帧号>\n" 后接 DISPLAY_PACKED_SIZE 字节打包帧
+// (客户端读取跟不上时跳过中间的帧，只发送最新的一帧)
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <SDL2/SDL.h>
+#include "chip8_sched.h"
+#include "chip8_mmap.h"
+
+#define SERVER_DEFAULT_SOCKET "chip8_server.sock"
+#define SERVER_MAX_CLIENTS SCHED_MAX_SESSIONS
+#define SERVER_LINE_SIZE 512
+#define SERVER_REPLY_SIZE 1024         // 每个连接排队中的应答上限 (字节)
+#define SERVER_STATS_INTERVAL 5000     // 统计输出间隔 (毫秒)
+
+static void print_usage(const char* prog) {
+    printf("用法: %s [选项]\n", prog);
+    printf("  --socket <路径>     监听的UNIX域套接字 (默认%s)\n", SERVER_DEFAULT_SOCKET);
+    printf("  --workers <数量>    工作线程数 (默认CPU核心数)\n");
+    printf("  --ipf <指令数>      每帧指令数 (默认按ROM平台选择)\n");
+    printf("  --seed <种子>       会话的随机数种子 (默认1)\n");
+    printf("  --bench <ROM> <数量> 不监听套接字，运行指定数量的会话测试调度器负载\n");
+    printf("  --seconds <秒数>    --bench 的运行时间 (默认10)\n");
+}
+
+static void print_stats(Chip8Scheduler* sched) {
+    SchedStats stats;
+    chip8_sched_stats(sched, &stats);
+    printf("会话 %d (挂起 %d)  时间片 %llu  窃取 %llu  迟到 %llu  挂起跳过的帧 %llu\n",
+           stats.sessions, stats.parked, (unsigned long long)stats.slices, (unsigned long long)stats.steals,
+           (unsigned long long)stats.late, (unsigned long long)stats.skipped_frames);
+    fflush(stdout);
+}
+
+// 按60Hz调用 chip8_sched_tick，返回本次调用的节拍数 (落后太多时不补)
+static int due_ticks(uint64_t* next_tick, uint64_t freq) {
+    uint64_t now = SDL_GetPerformanceCounter();
+    uint64_t period = freq / 60;
+    int count = 0;
+    while (now >= *next_tick && count < 4) {
+        *next_tick += period;
+        count++;
+    }
+    if (now >= *next_tick) *next_tick = now + period;
+    return count;
+}
+
+// ---------------------------------------------------------------
+// 负载测试
+// ---------------------------------------------------------------
+
+static int run_bench(const char* rom_path, int count, int seconds, int workers, int ipf, unsigned int seed) {
+    Chip8MappedFile map;
+    if (!chip8_mmap_open(&map, rom_path, 0, 0)) {
+        fprintf(stderr, "错误: 无法读取ROM文件: %s\n", rom_path);
+        return 1;
+    }
+    
+    Chip8Scheduler* sched = (Chip8Scheduler*)calloc(1, sizeof(Chip8Scheduler));
+    if (!sched || !chip8_sched_start(sched, workers, NULL, NULL)) {
+        free(sched);
+        chip8_mmap_close(&map);
+        return 1;
+    }
+    for (int i = 0; i < count; i++) {
+        if (!chip8_sched_open(sched, map.data, map.size, seed, ipf, NULL)) break;
+    }
+    printf("负载测试: %s x %d，%d 个工作线程，%d 秒\n", rom_path, count, sched->worker_count, seconds);
+    
+    uint64_t freq = SDL_GetPerformanceFrequency();
+    uint64_t next_tick = SDL_GetPerformanceCounter();
+    uint64_t end = next_tick + freq * (uint64_t)seconds;
+    uint32_t last_stats = SDL_GetTicks();
+    while (SDL_GetPerformanceCounter() < end) {
+        for (int n = due_ticks(&next_tick, freq); n > 0; n--) {
+            chip8_sched_tick(sched);
+        }
+        if (SDL_GetTicks() - last_stats >= SERVER_STATS_INTERVAL) {
+            print_stats(sched);
+            last_stats = SDL_GetTicks();
+        }
+        SDL_Delay(1);
+    }
+    print_stats(sched);
+    
+    chip8_sched_stop(sched);
+    free(sched);
+    chip8_mmap_close(&map);
+    return 0;
+}
+
+#ifndef _WIN32
+
+#include <errno.h>
+#include <signal.h>
+#include <poll.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+// 客户端连接 (由主线程管理；工作线程只写入 frame 邮箱)
+typedef struct {
+    int fd;
+    Chip8Session* session;
+    int closing;                       // 已请求关闭会话，等待 on_close 释放
+    char line[SERVER_LINE_SIZE];
+    size_t line_len;
+    
+    // 最新帧邮箱 (工作线程写，主线程读)
+    SDL_mutex* lock;
+    uint8_t frame[DISPLAY_PACKED_SIZE];
+    uint64_t frame_number;
+    int frame_ready;
+    
+    // 等待发送的应答 (排在下一帧之前)
+    char reply[SERVER_REPLY_SIZE];
+    size_t reply_len;
+    
+    // 未发送完的输出
+    uint8_t out[SERVER_REPLY_SIZE + 64 + DISPLAY_PACKED_SIZE];
+    size_t out_len;
+    size_t out_pos;
+} Client;
+
+static Client* clients[SERVER_MAX_CLIENTS];
+static int client_count = 0;
+static volatile sig_atomic_t stop_requested = 0;
+
+static void on_signal(int sig) {
+    (void)sig;
+    stop_requested = 1;
+}
+
+// 工作线程：只保留最新的一帧
+static void on_frame(Chip8Session* session, const uint8_t* packed, uint64_t frame) {
+    Client* client = (Client*)session->user;
+    if (!client) return;
+    SDL_LockMutex(client->lock);
+    memcpy(client->frame, packed, DISPLAY_PACKED_SIZE);
+    client->frame_number = frame;
+    client->frame_ready = 1;
+    SDL_UnlockMutex(client->lock);
+}
+
+static void free_client(Client* client) {
+    close(client->fd);
+    if (client->lock) SDL_DestroyMutex(client->lock);
+    free(client);
+}
+
+// 会话释放 (chip8_sched_tick 内，主线程)
+static void on_close(Chip8Session* session) {
+    Client* client = (Client*)session->user;
+    if (!client) return;
+    for (int i = 0; i < client_count; i++) {
+        if (clients[i] == client) {
+            clients[i] = clients[--client_count];
+            break;
+        }
+    }
+    free_client(client);
+}
+
+// 断开连接：有会话时等调度器释放会话 (on_close) 后再关闭套接字，
+// 没有会话的连接在本轮轮询结束后释放
+static void drop_client(Chip8Scheduler* sched, Client* client) {
+    if (client->closing) return;
+    client->closing = 1;
+    if (client->session) chip8_sched_close(sched, client->session);
+}
+
+static void reap_clients(void) {
+    int i = 0;
+    while (i < client_count) {
+        if (clients[i]->closing && !clients[i]->session) {
+            free_client(clients[i]);
+            clients[i] = clients[--client_count];
+        } else {
+            i++;
+        }
+    }
+}
+
+// 应答先排队，由 flush_client 在当前帧发完后发送，不会插进半帧数据中间
+static void reply(Chip8Scheduler* sched, Client* client, const char* text) {
+    size_t len = strlen(text);
+    if (client->reply_len + len > sizeof(client->reply)) {
+        drop_client(sched, client);  // 只发命令不读应答的客户端
+        return;
+    }
+    memcpy(client->reply + client->reply_len, text, len);
+    client->reply_len += len;
+}
+
+static void handle_open(Chip8Scheduler* sched, Client* client, const char* path, int ipf, unsigned int seed) {
+    char text[64];
+    if (client->session) {
+        reply(sched, client, "ERR 会话已打开\n");
+        return;
+    }
+    
+    Chip8MappedFile map;
+    if (!chip8_mmap_open(&map, path, 0, 0)) {
+        reply(sched, client, "ERR 无法读取ROM文件\n");
+        return;
+    }
+    client->session = chip8_sched_open(sched, map.data, map.size, seed, ipf, client);
+    chip8_mmap_close(&map);
+    
+    if (!client->session) {
+        reply(sched, client, "ERR 无法创建会话\n");
+        return;
+    }
+    snprintf(text, sizeof(text), "OK %d\n", client->session->id);
+    reply(sched, client, text);
+}
+
+// 处理一行命令，返回0表示断开连接
+static int handle_line(Chip8Scheduler* sched, Client* client, char* line, int ipf, unsigned int seed) {
+    if (strncmp(line, "OPEN ", 5) == 0) {
+        handle_open(sched, client, line + 5, ipf, seed);
+    } else if (line[0] == 'K' && line[1] == ' ') {
+        unsigned int key, pressed;
+        if (sscanf(line + 2, "%x %u", &key, &pressed) != 2 || key > 0xF) {
+            reply(sched, client, "ERR 无效的按键\n");
+        } else if (client->session) {
+            chip8_sched_input(sched, client->session, (uint8_t)key, pressed != 0);
+        }
+    } else if (strcmp(line, "QUIT") == 0) {
+        return 0;
+    } else if (line[0] != '\0') {
+        reply(sched, client, "ERR 未知命令\n");
+    }
+    return 1;
+}
+
+static void read_client(Chip8Scheduler* sched, Client* client, int ipf, unsigned int seed) {
+    char buf[1024];
+    ssize_t n = recv(client->fd, buf, sizeof(buf), MSG_DONTWAIT);
+    if (n == 0 || (n < 0 && errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR)) {
+        drop_client(sched, client);
+        return;
+    }
+    
+    for (ssize_t i = 0; i < n; i++) {
+        if (buf[i] == '\n') {
+            client->line[client->line_len] = '\0';
+            if (client->line_len > 0 && client->line[client->line_len - 1] == '\r') {
+                client->line[client->line_len - 1] = '\0';
+            }
+            client->line_len = 0;
+            if (!handle_line(sched, client, client->line, ipf, seed)) {
+                drop_client(sched, client);
+                return;
+            }
+            if (client->closing) return;  // 应答队列溢出
+        } else if (client->line_len + 1 < sizeof(client->line)) {
+            client->line[client->line_len++] = buf[i];
+        }
+    }
+}
+
+// 发送待发的数据；上一次的输出发完后再取排队的应答和邮箱中的最新帧
+static void flush_client(Chip8Scheduler* sched, Client* client) {
+    if (client->out_pos == client->out_len) {
+        client->out_len = 0;
+        client->out_pos = 0;
+        if (client->reply_len > 0) {
+            memcpy(client->out, client->reply, client->reply_len);
+            client->out_len = client->reply_len;
+            client->reply_len = 0;
+        }
+        
+        SDL_LockMutex(client->lock);
+        if (client->frame_ready) {
+            uint8_t* dst = client->out + client->out_len;
+            int header = snprintf((char*)dst, 64, "F %llu\n", (unsigned long long)client->frame_number);
+            memcpy(dst + header, client->frame, DISPLAY_PACKED_SIZE);
+            client->out_len += (size_t)header + DISPLAY_PACKED_SIZE;
+            client->frame_ready = 0;
+        }
+        SDL_UnlockMutex(client->lock);
+    }
+    
+    while (client->out_pos < client->out_len) {
+        ssize_t n = send(client->fd, client->out + client->out_pos, client->out_len - client->out_pos,
+                         MSG_DONTWAIT | MSG_NOSIGNAL);
+        if (n < 0) {
+            if (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR) drop_client(sched, client);
+            return;
+        }
+        client->out_pos += (size_t)n;
+    }
+}
+
+static int open_listener(const char* path) {
+    struct sockaddr_un addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    if (strlen(path) >= sizeof(addr.sun_path)) {
+        fprintf(stderr, "错误: 套接字路径太长: %s\n", path);
+        return -1;
+    }
+    strcpy(addr.sun_path, path);
+    
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0) {
+        perror("socket");
+        return -1;
+    }
+    unlink(path);  // 清理上次异常退出留下的套接字文件
+    if (bind(fd, (struct sockaddr*)&addr, sizeof(addr)) != 0 || listen(fd, 64) != 0) {
+        perror("bind/listen");
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+static void accept_client(int listen_fd) {
+    int fd = accept(listen_fd, NULL, NULL);
+    if (fd < 0) return;
+    if (client_count >= SERVER_MAX_CLIENTS) {
+        close(fd);
+        return;
+    }
+    
+    Client* client = (Client*)calloc(1, sizeof(Client));
+    if (!client || !(client->lock = SDL_CreateMutex())) {
+        free(client);
+        close(fd);
+        return;
+    }
+    client->fd = fd;
+    clients[client_count++] = client;
+}
+
+static int run_server(const char* socket_path, int workers, int ipf, unsigned int seed) {
+    int listen_fd = open_listener(socket_path);
+    if (listen_fd < 0) return 1;
+    
+    Chip8Scheduler* sched = (Chip8Scheduler*)calloc(1, sizeof(Chip8Scheduler));
+    if (!sched || !chip8_sched_start(sched, workers, on_frame, on_close)) {
+        free(sched);
+        close(listen_fd);
+        unlink(socket_path);
+        return 1;
+    }
+    printf("会话服务已启动: %s (%d 个工作线程)\n", socket_path, sched->worker_count);
+    fflush(stdout);
+    
+    signal(SIGINT, on_signal);
+    signal(SIGTERM, on_signal);
+    
+    static struct pollfd fds[SERVER_MAX_CLIENTS + 1];
+    static Client* polled[SERVER_MAX_CLIENTS];
+    uint64_t freq = SDL_GetPerformanceFrequency();
+    uint64_t next_tick = SDL_GetPerformanceCounter();
+    uint32_t last_stats = SDL_GetTicks();
+    
+    while (!stop_requested) {
+        // 轮询到下一个节拍为止
+        uint64_t now = SDL_GetPerformanceCounter();
+        int timeout = now >= next_tick ? 0 : (int)((next_tick - now) * 1000 / freq) + 1;
+        
+        int count = 0;
+        fds[count].fd = listen_fd;
+        fds[count].events = POLLIN;
+        fds[count].revents = 0;
+        count++;
+        for (int i = 0; i < client_count; i++) {
+            if (clients[i]->closing) continue;
+            polled[count - 1] = clients[i];
+            fds[count].fd = clients[i]->fd;
+            fds[count].events = POLLIN | (clients[i]->out_pos < clients[i]->out_len ? POLLOUT : 0);
+            fds[count].revents = 0;
+            count++;
+        }
+        
+        if (poll(fds, (nfds_t)count, timeout) > 0) {
+            for (int i = 1; i < count; i++) {
+                Client* client = polled[i - 1];
+                if (fds[i].revents & (POLLIN | POLLHUP | POLLERR)) read_client(sched, client, ipf, seed);
+                if (!client->closing && (fds[i].revents & POLLOUT)) flush_client(sched, client);
+            }
+            if (fds[0].revents & POLLIN) accept_client(listen_fd);
+        }
+        
+        for (int n = due_ticks(&next_tick, freq); n > 0; n--) {
+            chip8_sched_tick(sched);
+        }
+        for (int i = 0; i < client_count; i++) {
+            if (!clients[i]->closing) flush_client(sched, clients[i]);
+        }
+        reap_clients();
+        
+        if (SDL_GetTicks() - last_stats >= SERVER_STATS_INTERVAL) {
+            print_stats(sched);
+            last_stats = SDL_GetTicks();
+        }
+    }
+    
+    printf("\n正在停止会话服务...\n");
+    chip8_sched_stop(sched);  // 对所有会话调用 on_close
+    while (client_count > 0) {
+        free_client(clients[--client_count]);
+    }
+    free(sched);
+    close(listen_fd);
+    unlink(socket_path);
+    return 0;
+}
+
+#else
+
+static int run_server(const char* socket_path, int workers, int ipf, unsigned int seed) {
+    (void)socket_path;
+    (void)workers;
+    (void)ipf;
+    (void)seed;
+    fprintf(stderr, "警告: 当前平台不支持UNIX域套接字会话服务，只能使用 --bench\n");
+    return 1;
+}
+
+#endif
+
+int main(int argc, char* argv[]) {
+    const char* socket_path = SERVER_DEFAULT_SOCKET;
+    const char* bench_rom = NULL;
+    int workers = 0, ipf = 0, seconds = 10, count = 0;
+    unsigned int seed = 1;
+    
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--socket") == 0 && i + 1 < argc) {
+            socket_path = argv[++i];
+        } else if (strcmp(argv[i], "--workers") == 0 && i + 1 < argc) {
+            workers = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--ipf") == 0 && i + 1 < argc) {
+            ipf = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--seed") == 0 && i + 1 < argc) {
+            seed = (unsigned int)strtoul(argv[++i], NULL, 0);
+        } else if (strcmp(argv[i], "--bench") == 0 && i + 2 < argc) {
+            bench_rom = argv[++i];
+            count = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--seconds") == 0 && i + 1 < argc) {
+            seconds = atoi(argv[++i]);
+        } else {
+            print_usage(argv[0]);
+            return 1;
+        }
+    }
+    
+    if (SDL_Init(0) != 0) {
+        fprintf(stderr, "错误: SDL初始化失败: %s\n", SDL_GetError());
+        return 1;
+    }
+    int result = bench_rom ? run_bench(bench_rom, count, seconds, workers, ipf, seed)
+                           : run_server(socket_path, workers, ipf, seed);
+    SDL_Quit();
+    return result;
+}
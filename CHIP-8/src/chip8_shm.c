@@ -0,0 +1,209 @@
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <time.h>
+#include "chip8_shm.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#endif
+
+// 单调时钟 (纳秒)
+static uint64_t monotonic_ns(void) {
+#ifdef _WIN32
+    LARGE_INTEGER freq, counter;
+    QueryPerformanceFrequency(&freq);
+    QueryPerformanceCounter(&counter);
+    return (uint64_t)((double)counter.QuadPart * 1e9 / (double)freq.QuadPart);
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+#endif
+}
+
+// Unix时间 (纳秒)
+static uint64_t wallclock_ns(void) {
+#ifdef _WIN32
+    FILETIME ft;
+    GetSystemTimeAsFileTime(&ft);
+    uint64_t t = ((uint64_t)ft.dwHighDateTime << 32) | ft.dwLowDateTime;
+    return (t - 116444736000000000ull) * 100;  // 1601年起的100ns -> 1970年起的ns
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_REALTIME, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+#endif
+}
+
+// 映射共享内存对象，create=1时创建 (同名对象已存在时失败，force=1时先删除旧对象)
+static int map_shared(Chip8Shm* shm, const char* name, int create, int force) {
+    memset(shm, 0, sizeof(*shm));
+    
+    // POSIX共享内存名称必须以'/'开头
+    snprintf(shm->name, sizeof(shm->name), "%s%s", name[0] == '/' ? "" : "/", name);
+    size_t size = sizeof(Chip8ShmLayout);
+    
+#ifdef _WIN32
+    HANDLE mapping;
+    if (create) {
+        mapping = CreateFileMappingA(INVALID_HANDLE_VALUE, NULL, PAGE_READWRITE, 0, (DWORD)size, shm->name + 1);
+    } else {
+        mapping = OpenFileMappingA(FILE_MAP_READ, FALSE, shm->name + 1);
+    }
+    if (!mapping) {
+        fprintf(stderr, "错误: 无法%s共享内存 '%s' (错误码 %lu)\n", create ? "创建" : "打开",
+                shm->name + 1, (unsigned long)GetLastError());
+        return 0;
+    }
+    // Windows的映射对象在最后一个句柄关闭时才消失，无法删除正在使用的对象，--shm-force 也不能接管
+    if (create && GetLastError() == ERROR_ALREADY_EXISTS) {
+        fprintf(stderr, "错误: 共享内存 '%s' 已被另一个进程使用\n", shm->name + 1);
+        CloseHandle(mapping);
+        return 0;
+    }
+    (void)force;
+    
+    void* view = MapViewOfFile(mapping, create ? FILE_MAP_ALL_ACCESS : FILE_MAP_READ, 0, 0, size);
+    if (!view) {
+        fprintf(stderr, "错误: 无法映射共享内存 '%s'\n", shm->name + 1);
+        CloseHandle(mapping);
+        return 0;
+    }
+    shm->handle = mapping;
+#else
+    // 写入端独占创建：两个写入者共用同一个对象会破坏seqlock
+    int fd = shm_open(shm->name, create ? (O_CREAT | O_EXCL | O_RDWR) : O_RDONLY, 0644);
+    if (fd < 0 && create && errno == EEXIST && force) {
+        fprintf(stderr, "警告: 删除已存在的共享内存 '%s'\n", shm->name);
+        shm_unlink(shm->name);
+        fd = shm_open(shm->name, O_CREAT | O_EXCL | O_RDWR, 0644);
+    }
+    if (fd < 0 && create && errno == EEXIST) {
+        fprintf(stderr, "错误: 共享内存 '%s' 已存在 (另一个模拟器正在使用，或上次未正常退出；确认无人使用后可加 --shm-force)\n",
+                shm->name);
+        return 0;
+    }
+    if (fd < 0) {
+        perror("shm_open");
+        fprintf(stderr, "错误: 无法%s共享内存 '%s'\n", create ? "创建" : "打开", shm->name);
+        return 0;
+    }
+    
+    if (create && ftruncate(fd, (off_t)size) != 0) {
+        perror("ftruncate");
+        close(fd);
+        shm_unlink(shm->name);
+        return 0;
+    }
+    
+    void* view = mmap(NULL, size, create ? (PROT_READ | PROT_WRITE) : PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (view == MAP_FAILED) {
+        perror("mmap");
+        if (create) shm_unlink(shm->name);
+        return 0;
+    }
+#endif
+    
+    shm->layout = (Chip8ShmLayout*)view;
+    shm->is_writer = create;
+    return 1;
+}
+
+// 创建共享内存 (写入端)
+int chip8_shm_create(Chip8Shm* shm, const char* name, int force) {
+    if (!shm || !name || !name[0]) return 0;
+    if (!map_shared(shm, name, 1, force)) return 0;
+    
+    Chip8ShmLayout* layout = shm->layout;
+    memset(layout, 0, sizeof(*layout));
+    layout->version = CHIP8_SHM_VERSION;
+    layout->width = CHIP8_SHM_WIDTH;
+    layout->height = CHIP8_SHM_HEIGHT;
+    layout->slot_count = CHIP8_SHM_SLOTS;
+    layout->slot_size = sizeof(Chip8ShmSlot);
+    // magic最后写入，读者看到magic即表示头部有效
+    __atomic_store_n(&layout->magic, CHIP8_SHM_MAGIC, __ATOMIC_RELEASE);
+    
+    printf("共享内存帧导出已启用: %s (%d帧环形缓冲区)\n", shm->name, CHIP8_SHM_SLOTS);
+    return 1;
+}
+
+// 发布一帧：seqlock写入，不等待任何读者
+void chip8_shm_publish(Chip8Shm* shm, const uint8_t* packed, uint64_t frame) {
+    if (!shm || !shm->layout || !shm->is_writer) return;
+    
+    Chip8ShmLayout* layout = shm->layout;
+    uint64_t index = layout->published;
+    Chip8ShmSlot* slot = &layout->slots[index % CHIP8_SHM_SLOTS];
+    
+    uint32_t seq = slot->seq;
+    __atomic_store_n(&slot->seq, seq + 1, __ATOMIC_RELAXED);  // 奇数：写入中
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+    
+    slot->frame = frame;
+    slot->timestamp_ns = monotonic_ns();
+    slot->wallclock_ns = wallclock_ns();
+    memcpy(slot->display, packed, CHIP8_SHM_FRAME_BYTES);
+    
+    __atomic_store_n(&slot->seq, seq + 2, __ATOMIC_RELEASE);  // 偶数：写入完成
+    __atomic_store_n(&layout->published, index + 1, __ATOMIC_RELEASE);
+}
+
+// 打开共享内存 (读取端)
+int chip8_shm_open(Chip8Shm* shm, const char* name) {
+    if (!shm || !name || !name[0]) return 0;
+    if (!map_shared(shm, name, 0, 0)) return 0;
+    
+    Chip8ShmLayout* layout = shm->layout;
+    if (__atomic_load_n(&layout->magic, __ATOMIC_ACQUIRE) != CHIP8_SHM_MAGIC ||
+        layout->version != CHIP8_SHM_VERSION || layout->slot_size != sizeof(Chip8ShmSlot)) {
+        fprintf(stderr, "错误: 共享内存 '%s' 格式不匹配\n", shm->name);
+        chip8_shm_close(shm);
+        return 0;
+    }
+    return 1;
+}
+
+// 已发布帧数
+uint64_t chip8_shm_published(const Chip8Shm* shm) {
+    return __atomic_load_n(&shm->layout->published, __ATOMIC_ACQUIRE);
+}
+
+// 读取一帧：写入过程中或读取期间被覆盖则返回0，由调用者决定是否重试
+int chip8_shm_read(const Chip8Shm* shm, uint64_t index, Chip8ShmSlot* out) {
+    const Chip8ShmSlot* slot = &shm->layout->slots[index % CHIP8_SHM_SLOTS];
+    
+    uint32_t seq1 = __atomic_load_n(&slot->seq, __ATOMIC_ACQUIRE);
+    if (seq1 & 1) return 0;
+    
+    memcpy(out, slot, sizeof(*out));
+    __atomic_thread_fence(__ATOMIC_ACQUIRE);
+    
+    uint32_t seq2 = __atomic_load_n(&slot->seq, __ATOMIC_RELAXED);
+    if (seq1 != seq2) return 0;
+    
+    // 槽位已被更新的帧覆盖
+    return chip8_shm_published(shm) - index <= CHIP8_SHM_SLOTS;
+}
+
+// 关闭共享内存，写入端同时删除对象
+void chip8_shm_close(Chip8Shm* shm) {
+    if (!shm || !shm->layout) return;
+    
+#ifdef _WIN32
+    UnmapViewOfFile(shm->layout);
+    CloseHandle((HANDLE)shm->handle);
+#else
+    munmap(shm->layout, sizeof(Chip8ShmLayout));
+    if (shm->is_writer) {
+        shm_unlink(shm->name);
+    }
+#endif
+    shm->layout = NULL;
+}
@@ -0,0 +1,59 @@
+#ifndef CHIP8_SHM_H
+#define CHIP8_SHM_H
+
+#include <stdint.h>
+
+// 共享内存帧导出：模拟器把每个完成的帧发布到共享内存环形缓冲区，
+// 外部查看/录制工具按seqlock协议读取，读者永远不会阻塞模拟器。
+// 本头文件不依赖SDL，读取工具可以单独编译。
+
+#define CHIP8_SHM_MAGIC 0x4D485338u    // "8SHM"
+#define CHIP8_SHM_VERSION 1
+#define CHIP8_SHM_SLOTS 16             // 环形缓冲区帧数
+#define CHIP8_SHM_WIDTH 64             // 帧宽度 (像素)
+#define CHIP8_SHM_HEIGHT 32            // 帧高度 (像素)
+#define CHIP8_SHM_FRAME_BYTES (CHIP8_SHM_WIDTH * CHIP8_SHM_HEIGHT / 8)  // 打包帧大小
+
+// 单帧槽位
+typedef struct {
+    uint32_t seq;                  // seqlock序号 (奇数=正在写入)
+    uint32_t reserved;
+    uint64_t frame;                // 帧计数
+    uint64_t timestamp_ns;         // 发布时刻 (单调时钟，纳秒)
+    uint64_t wallclock_ns;         // 发布时刻 (Unix时间，纳秒)
+    uint8_t display[CHIP8_SHM_FRAME_BYTES];  // 打包显示 (每行8字节，高位在左)
+} Chip8ShmSlot;
+
+// 共享内存布局
+typedef struct {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t width;
+    uint32_t height;
+    uint32_t slot_count;
+    uint32_t slot_size;
+    uint64_t published;            // 已发布帧数 (最新帧位于 (published-1) % slot_count)
+    Chip8ShmSlot slots[CHIP8_SHM_SLOTS];
+} Chip8ShmLayout;
+
+// 共享内存句柄
+typedef struct {
+    Chip8ShmLayout* layout;
+    void* handle;                  // 平台相关句柄 (Windows映射对象)
+    char name[128];
+    int is_writer;
+} Chip8Shm;
+
+// 写入端 (模拟器)：同名共享内存已存在时失败，force=1 时删除后重新创建 (仅POSIX)
+int chip8_shm_create(Chip8Shm* shm, const char* name, int force);
+void chip8_shm_publish(Chip8Shm* shm, const uint8_t* packed, uint64_t frame);
+
+// 读取端 (外部工具)
+int chip8_shm_open(Chip8Shm* shm, const char* name);
+uint64_t chip8_shm_published(const Chip8Shm* shm);
+// 读取第 index 次发布的帧 (从0开始)，帧已被覆盖或正在写入时返回0
+int chip8_shm_read(const Chip8Shm* shm, uint64_t index, Chip8ShmSlot* out);
+
+void chip8_shm_close(Chip8Shm* shm);
+
+#endif // CHIP8_SHM_H
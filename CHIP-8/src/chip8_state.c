@@ -0,0 +1,107 @@
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include "chip8_state.h"
+#include "chip8_hash.h"
+
+#define STATE_FILE_SIZE (sizeof(Chip8StateHeader) + sizeof(Chip8))
+
+static uint64_t machine_checksum(const Chip8* chip8) {
+    return chip8_xxh64(chip8, STATE_MACHINE_SIZE, 0);
+}
+
+// 检查头部与机器状态是否可以恢复
+static int state_is_valid(const Chip8StateHeader* header, const Chip8* chip8, const char* path) {
+    if (memcmp(header->magic, STATE_MAGIC, 4) != 0) {
+        return 0;  // 新文件或其他格式
+    }
+    if (header->version != STATE_VERSION || header->machine_size != STATE_MACHINE_SIZE ||
+        header->total_size != sizeof(Chip8)) {
+        fprintf(stderr, "警告: 状态文件版本或结构不匹配，重新开始: %s\n", path);
+        return 0;
+    }
+    
+    if (header->running) {
+        // 上次未正常退出：检查点之后的修改是预期的，只做基本合法性检查。
+        // pc 和 I 不检查范围：取指和访存都按4KB回绕 (MEMORY_MASK)，任何16位值都能继续运行
+        if (chip8->sp > 16) {
+            fprintf(stderr, "警告: 状态文件中的机器状态无效，重新开始: %s\n", path);
+            return 0;
+        }
+        printf("检测到上次未正常退出，从最新状态恢复\n");
+    } else if (header->checksum != machine_checksum(chip8)) {
+        fprintf(stderr, "警告: 状态文件校验和错误，重新开始: %s\n", path);
+        return 0;
+    }
+    
+    return header->rom_hash != 0;
+}
+
+// 清除上次进程留下的主机相关字段 (指针、设备ID已失效)
+static void reset_host_fields(Chip8* chip8) {
+    memset((uint8_t*)chip8 + STATE_MACHINE_SIZE, 0, sizeof(Chip8) - STATE_MACHINE_SIZE);
+    memset(chip8->key, 0, sizeof(chip8->key));  // 恢复时没有按住的键
+    chip8->draw_flag = 1;
+}
+
+int chip8_state_open(Chip8StateFile* state, const char* path, const Chip8* initial) {
+    memset(state, 0, sizeof(*state));
+    
+    // 独占打开：两个进程映射同一个状态文件会互相覆盖对方的机器状态
+    if (!chip8_mmap_open(&state->map, path, MMAP_EXCLUSIVE, STATE_FILE_SIZE)) {
+        fprintf(stderr, "错误: 无法映射状态文件: %s\n", path);
+        return 0;
+    }
+    
+    state->header = (Chip8StateHeader*)state->map.data;
+    state->chip8 = (Chip8*)(state->map.data + sizeof(Chip8StateHeader));
+    
+    if (state_is_valid(state->header, state->chip8, path)) {
+        reset_host_fields(state->chip8);
+        state->resumed = 1;
+    } else {
+        chip8_state_restart(state, initial);
+    }
+    
+    state->header->running = 1;
+    return 1;
+}
+
+void chip8_state_restart(Chip8StateFile* state, const Chip8* initial) {
+    Chip8StateHeader* header = state->header;
+    
+    memset(header, 0, sizeof(*header));
+    memcpy(header->magic, STATE_MAGIC, 4);
+    header->version = STATE_VERSION;
+    header->machine_size = STATE_MACHINE_SIZE;
+    header->total_size = sizeof(Chip8);
+    header->running = 1;
+    
+    *state->chip8 = *initial;
+    state->resumed = 0;
+    chip8_state_checkpoint(state);
+}
+
+void chip8_state_set_rom(Chip8StateFile* state, uint64_t rom_hash) {
+    if (!state->header) return;
+    state->header->rom_hash = rom_hash;
+    chip8_state_checkpoint(state);
+}
+
+void chip8_state_checkpoint(Chip8StateFile* state) {
+    if (!state->header) return;
+    state->header->checksum = machine_checksum(state->chip8);
+    state->header->saved_at = (int64_t)time(NULL);
+}
+
+void chip8_state_close(Chip8StateFile* state) {
+    if (!state->header) return;
+    
+    chip8_state_checkpoint(state);
+    state->header->running = 0;
+    chip8_mmap_sync(&state->map);
+    chip8_mmap_close(&state->map);
+    
+    state->header = NULL;
+    state->chip8 = NULL;
+}
@@ -0,0 +1,51 @@
+#ifndef CHIP8_STATE_H
+#define CHIP8_STATE_H
+
+#include "chip8.h"
+#include "chip8_mmap.h"
+
+// 持久化机器状态：Chip8结构直接放在内存映射文件中运行，
+// 进程被杀死后由操作系统页缓存保留最新状态，下次启动即可恢复
+
+#define STATE_MAGIC "C8ST"
+#define STATE_VERSION 6            // 2: 内存末尾增加镜像区; 3: XO-CHIP音频状态; 4: Philox随机数状态; 5: 兼容性配置; 6: 按键延迟松开
+
+// 机器状态部分：从结构开头到主机相关字段 (trace/窗口/音频) 之前
+#define STATE_MACHINE_SIZE offsetof(Chip8, trace)
+
+// 状态文件头 (64字节，其后紧跟Chip8结构)
+typedef struct {
+    char magic[4];             // "C8ST"
+    uint32_t version;
+    uint32_t machine_size;     // STATE_MACHINE_SIZE (结构布局变化时失效)
+    uint32_t total_size;       // sizeof(Chip8)
+    uint64_t checksum;         // 上次检查点时机器状态的XXH64
+    uint64_t rom_hash;         // 已加载ROM的XXH64 (0=未加载)
+    int64_t saved_at;          // 上次检查点时间 (time_t)
+    uint32_t running;          // 有进程正在使用该文件 (未正常退出时保持为1)
+    uint32_t reserved[5];
+} Chip8StateHeader;
+
+typedef struct {
+    Chip8MappedFile map;
+    Chip8StateHeader* header;
+    Chip8* chip8;              // 指向映射中的机器状态
+    int resumed;               // 是否从已有状态恢复
+} Chip8StateFile;
+
+// 打开/创建状态文件。已有有效状态时恢复 (resumed=1)，否则以 initial 初始化
+int chip8_state_open(Chip8StateFile* state, const char* path, const Chip8* initial);
+
+// 放弃已恢复的状态，改用 initial 重新开始
+void chip8_state_restart(Chip8StateFile* state, const Chip8* initial);
+
+// 记录当前运行的ROM
+void chip8_state_set_rom(Chip8StateFile* state, uint64_t rom_hash);
+
+// 更新校验和与时间戳 (不做同步写盘)
+void chip8_state_checkpoint(Chip8StateFile* state);
+
+// 最终检查点，写回磁盘并解除映射
+void chip8_state_close(Chip8StateFile* state);
+
+#endif // CHIP8_STATE_H
@@ -0,0 +1,112 @@
+#include <string.h>
+#include "chip8_timing.h"
+
+#define VIP_FETCH_CYCLES 40   // 取指、译码和跳转表分派
+
+static const char* TIMING_NAMES[TIMING_MODEL_COUNT] = { "speed", "vip" };
+
+int chip8_timing_from_name(const char* name) {
+    for (int i = 0; i < TIMING_MODEL_COUNT; i++) {
+        if (strcmp(name, TIMING_NAMES[i]) == 0) return i;
+    }
+    return -1;
+}
+
+const char* chip8_timing_name(int model) {
+    if (model < 0 || model >= TIMING_MODEL_COUNT) return "unknown";
+    return TIMING_NAMES[model];
+}
+
+uint32_t chip8_vip_cycles(const Chip8* chip8, uint16_t opcode, uint16_t pc) {
+    uint8_t x = (opcode & 0x0F00) >> 8;
+    uint8_t n = opcode & 0x000F;
+    uint32_t skipped = (chip8->pc == (uint16_t)(pc + 4)) ? 4 : 0;  // 跳过分支多4个周期
+    uint32_t exec;
+    
+    switch (opcode & 0xF000) {
+        case 0x0000:
+            if (opcode == 0x00E0) exec = 3078;         // 逐字节清空256字节显示区
+            else if (opcode == 0x00EE) exec = 10;
+            else exec = 24;                             // 0NNN: 机器码子程序，按空调用计
+            break;
+        case 0x1000: exec = 12; break;
+        case 0x2000: exec = 26; break;
+        case 0x3000:
+        case 0x4000: exec = 10 + skipped; break;
+        case 0x5000:
+        case 0x9000: exec = 14 + skipped; break;
+        case 0x6000: exec = 6; break;
+        case 0x7000: exec = 10; break;
+        case 0x8000: exec = (n == 0) ? 12 : 44; break;  // 逻辑/算术运算通过RAM中生成的代码执行
+        case 0xA000: exec = 12; break;
+        case 0xB000: exec = 22; break;
+        case 0xC000: exec = 36; break;
+        case 0xD000:
+            {
+                // 每行需要按X坐标的低3位移位，跨字节时还要写两个字节
+                uint32_t shift = chip8->V[x] & 7;
+                exec = 26 + (uint32_t)n * (34 + 4 * shift + (shift ? 12 : 0));
+            }
+            break;
+        case 0xE000: exec = 14 + skipped; break;
+        case 0xF000:
+            switch (opcode & 0x00FF) {
+                case 0x07: exec = 10; break;
+                case 0x0A: exec = 18; break;           // 每次轮询键盘
+                case 0x15:
+                case 0x18: exec = 10; break;
+                case 0x1E: exec = 16; break;
+                case 0x29: exec = 16; break;
+                case 0x33:
+                    {
+                        // 重复减法求各位数字，耗时与数字之和成正比
+                        uint8_t v = chip8->V[x];
+                        exec = 80 + 16 * (uint32_t)(v / 100 + (v / 10) % 10 + v % 10);
+                    }
+                    break;
+                case 0x55:
+                case 0x65: exec = 14 + 14 * (uint32_t)(x + 1); break;
+                default:   exec = 12; break;
+            }
+            break;
+        default:
+            exec = 12;
+            break;
+    }
+    
+    return VIP_FETCH_CYCLES + exec;
+}
+
+int32_t chip8_frame_begin(const Chip8* chip8) {
+    return VIP_FRAME_BUDGET - chip8->cycle_debt;
+}
+
+int32_t chip8_frame_charge(const Chip8* chip8, int32_t budget, uint16_t opcode, uint16_t pc, int display_wait) {
+    budget -= (int32_t)chip8_vip_cycles(chip8, opcode, pc);
+    
+    // 等待垂直消隐：本帧剩余时间空闲
+    if (display_wait && (opcode & 0xF000) == 0xD000 && budget > 0) {
+        budget = 0;
+    }
+    return budget;
+}
+
+void chip8_frame_end(Chip8* chip8, int32_t budget) {
+    chip8->cycle_debt = budget < 0 ? -budget : 0;
+}
+
+int chip8_run_frame(Chip8* chip8, int display_wait) {
+    int32_t budget = chip8_frame_begin(chip8);
+    int executed = 0;
+    
+    while (budget > 0) {
+        uint16_t pc = chip8->pc;
+        uint16_t opcode = chip8_read_opcode(chip8, pc);
+        chip8_cycle(chip8);
+        executed++;
+        budget = chip8_frame_charge(chip8, budget, opcode, pc, display_wait);
+    }
+    
+    chip8_frame_end(chip8, budget);
+    return executed;
+}
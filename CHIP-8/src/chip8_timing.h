@@ -0,0 +1,42 @@
+#ifndef CHIP8_TIMING_H
+#define CHIP8_TIMING_H
+
+#include "chip8.h"
+
+// COSMAC VIP 时序模型：每条指令按原机解释器消耗的机器周期计费，
+// 每个60Hz帧执行固定的周期预算，而不是每秒固定的指令数。
+// 周期数是根据已公开的VIP解释器分析整理的近似值 (含取指/译码开销)，
+// 与真机的误差在几个机器周期以内，足以还原游戏原本的速度
+
+// 1802 CPU: 1.7609MHz，每个机器周期8个时钟
+#define VIP_CYCLES_PER_FRAME   3668   // 1760900 / 8 / 60
+#define VIP_DISPLAY_DMA_CYCLES 1024   // 1861视频芯片DMA：128扫描线 x 8字节
+#define VIP_INTERRUPT_CYCLES   46     // 帧中断服务程序 (定时器递减等)
+#define VIP_FRAME_BUDGET (VIP_CYCLES_PER_FRAME - VIP_DISPLAY_DMA_CYCLES - VIP_INTERRUPT_CYCLES)
+
+// 时序模型
+typedef enum {
+    TIMING_MODEL_SPEED = 0,    // 按 game_speed (指令/秒) 运行，所有指令耗时相同
+    TIMING_MODEL_VIP,          // COSMAC VIP 周期预算
+    TIMING_MODEL_COUNT
+} Chip8TimingModel;
+
+int chip8_timing_from_name(const char* name);     // 未知名称返回-1
+const char* chip8_timing_name(int model);
+
+// 刚执行完的指令消耗的机器周期 (pc为执行前的地址，用于判断是否跳过)
+uint32_t chip8_vip_cycles(const Chip8* chip8, uint16_t opcode, uint16_t pc);
+
+// 执行一帧的周期预算，返回执行的指令数。
+// display_wait=1 时 DXYN 等待垂直消隐，执行后本帧剩余周期作废；
+// 超出预算的周期计入 chip8->cycle_debt，从下一帧扣除
+int chip8_run_frame(Chip8* chip8, int display_wait);
+
+// 逐条计费接口 (供需要在每条指令之间插入检查的调用者使用)：
+// chip8_frame_begin 返回本帧预算，chip8_frame_charge 返回剩余预算，
+// 返回值 <=0 表示本帧结束，最后调用 chip8_frame_end 保存透支
+int32_t chip8_frame_begin(const Chip8* chip8);
+int32_t chip8_frame_charge(const Chip8* chip8, int32_t budget, uint16_t opcode, uint16_t pc, int display_wait);
+void chip8_frame_end(Chip8* chip8, int32_t budget);
+
+#endif // CHIP8_TIMING_H
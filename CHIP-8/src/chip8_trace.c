@@ -0,0 +1,129 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <signal.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include "chip8_trace.h"
+
+#ifndef O_BINARY
+#define O_BINARY 0
+#endif
+
+// 信号处理函数使用的跟踪缓冲区
+static Chip8Trace* signal_trace = NULL;
+
+// 初始化跟踪缓冲区 (容量向上取整为2的幂)
+int chip8_trace_init(Chip8Trace* trace, uint32_t capacity, const char* path) {
+    if (!trace || !path) return 0;
+    
+    memset(trace, 0, sizeof(*trace));
+    
+    uint32_t size = 1;
+    while (size < capacity && size < (1u << 24)) {
+        size <<= 1;
+    }
+    
+    trace->entries = (Chip8TraceEntry*)calloc(size, sizeof(Chip8TraceEntry));
+    if (!trace->entries) {
+        fprintf(stderr, "错误: 跟踪缓冲区分配失败 (%u条)\n", size);
+        return 0;
+    }
+    trace->mask = size - 1;
+    snprintf(trace->path, sizeof(trace->path), "%s", path);
+    
+    printf("执行跟踪已启用: %u条 (%u KB)，转储文件: %s\n", size,
+           (unsigned)(size * sizeof(Chip8TraceEntry) / 1024), trace->path);
+    return 1;
+}
+
+// 释放跟踪缓冲区
+void chip8_trace_cleanup(Chip8Trace* trace) {
+    if (!trace) return;
+    
+    if (signal_trace == trace) {
+        signal_trace = NULL;
+    }
+    free(trace->entries);
+    trace->entries = NULL;
+}
+
+// 写入全部数据 (只使用write，可在信号处理函数中调用)
+static int write_all(int fd, const void* data, size_t size) {
+    const char* p = (const char*)data;
+    while (size > 0) {
+        int n = (int)write(fd, p, (unsigned)size);
+        if (n <= 0) return 0;
+        p += n;
+        size -= (size_t)n;
+    }
+    return 1;
+}
+
+// 转储环形缓冲区 (按时间从旧到新)
+int chip8_trace_dump(Chip8Trace* trace, uint32_t fault, uint16_t opcode) {
+    if (!trace || !trace->entries) return 0;
+    
+    uint32_t capacity = trace->mask + 1;
+    uint64_t count = trace->count;
+    uint32_t stored = count < capacity ? (uint32_t)count : capacity;
+    
+    Chip8TraceHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, TRACE_MAGIC, 4);
+    header.version = TRACE_VERSION;
+    header.entry_size = sizeof(Chip8TraceEntry);
+    header.capacity = capacity;
+    header.stored = stored;
+    header.total = count;
+    header.fault = fault;
+    header.fault_opcode = opcode;
+    
+    int fd = open(trace->path, O_WRONLY | O_CREAT | O_TRUNC | O_BINARY, 0644);
+    if (fd < 0) return 0;
+    
+    int ok = write_all(fd, &header, sizeof(header));
+    if (count <= capacity) {
+        ok = ok && write_all(fd, trace->entries, stored * sizeof(Chip8TraceEntry));
+    } else {
+        uint32_t start = (uint32_t)(count & trace->mask);
+        ok = ok && write_all(fd, trace->entries + start, (capacity - start) * sizeof(Chip8TraceEntry));
+        ok = ok && write_all(fd, trace->entries, start * sizeof(Chip8TraceEntry));
+    }
+    close(fd);
+    return ok;
+}
+
+// 崩溃信号：转储后恢复默认处理并重新触发
+static void crash_signal_handler(int sig) {
+    if (signal_trace) {
+        chip8_trace_dump(signal_trace, 0, 0);
+        static const char msg[] = "\n[trace] crash signal, trace dumped\n";
+        write_all(2, msg, sizeof(msg) - 1);
+    }
+    signal(sig, SIG_DFL);
+    raise(sig);
+}
+
+#ifdef SIGUSR1
+// SIGUSR1：按需转储，程序继续运行
+static void dump_signal_handler(int sig) {
+    (void)sig;
+    if (signal_trace) {
+        chip8_trace_dump(signal_trace, 0, 0);
+    }
+}
+#endif
+
+// 安装信号处理：崩溃时自动转储，SIGUSR1按需转储
+void chip8_trace_install_signal_handlers(Chip8Trace* trace) {
+    signal_trace = trace;
+    
+    signal(SIGSEGV, crash_signal_handler);
+    signal(SIGABRT, crash_signal_handler);
+    signal(SIGFPE, crash_signal_handler);
+    signal(SIGILL, crash_signal_handler);
+#ifdef SIGUSR1
+    signal(SIGUSR1, dump_signal_handler);
+#endif
+}
@@ -0,0 +1,62 @@
+#ifndef CHIP8_TRACE_H
+#define CHIP8_TRACE_H
+
+#include <stdint.h>
+
+// 执行跟踪：每条指令记录8字节到固定大小的环形缓冲区，
+// 出现故障或收到信号时自动转储，用 trace_decode 离线反汇编
+
+#define TRACE_MAGIC "C8TR"
+#define TRACE_VERSION 1
+#define TRACE_DEFAULT_ENTRIES 65536    // 默认条目数 (512KB)，必须是2的幂
+#define TRACE_NO_REG 0xFF              // 本条指令没有写寄存器
+
+// 跟踪条目 (8字节)
+typedef struct {
+    uint16_t pc;                       // 指令地址
+    uint16_t opcode;                   // 操作码
+    uint16_t I;                        // 执行后的I寄存器
+    uint8_t reg;                       // 被写入的寄存器编号 (TRACE_NO_REG=无)
+    uint8_t value;                     // 该寄存器执行后的值
+} Chip8TraceEntry;
+
+// 转储文件头
+typedef struct {
+    char magic[4];                     // "C8TR"
+    uint16_t version;
+    uint16_t entry_size;               // sizeof(Chip8TraceEntry)
+    uint32_t capacity;                 // 环形缓冲区容量
+    uint32_t stored;                   // 文件中的条目数 (按时间从旧到新)
+    uint64_t total;                    // 累计执行的指令数
+    uint32_t fault;                    // 触发转储的故障类型 (0=信号或手动)
+    uint32_t fault_opcode;             // 触发故障的操作码
+} Chip8TraceHeader;
+
+// 跟踪缓冲区
+typedef struct Chip8Trace {
+    Chip8TraceEntry* entries;
+    uint32_t mask;                     // 容量-1
+    uint64_t count;                    // 累计记录数
+    char path[256];                    // 转储文件路径
+    uint32_t dumped_faults;            // 已转储过的故障类型 (位图，每种只转储一次)
+    uint32_t pending_fault;            // 本条指令执行中发生的故障 (记录后再转储)
+    uint16_t pending_opcode;
+} Chip8Trace;
+
+int chip8_trace_init(Chip8Trace* trace, uint32_t capacity, const char* path);
+void chip8_trace_cleanup(Chip8Trace* trace);
+int chip8_trace_dump(Chip8Trace* trace, uint32_t fault, uint16_t opcode);
+void chip8_trace_install_signal_handlers(Chip8Trace* trace);
+
+// 记录一条指令 (内联，开销为一次8字节写入)
+static inline void chip8_trace_record(Chip8Trace* trace, uint16_t pc, uint16_t opcode,
+                                      uint16_t I, uint8_t reg, uint8_t value) {
+    Chip8TraceEntry* entry = &trace->entries[trace->count++ & trace->mask];
+    entry->pc = pc;
+    entry->opcode = opcode;
+    entry->I = I;
+    entry->reg = reg;
+    entry->value = value;
+}
+
+#endif // CHIP8_TRACE_H
@@ -0,0 +1,201 @@
+#include <stdio.h>
+#include <string.h>
+#include <sys/stat.h>
+#include "chip8_watch.h"
+
+#ifdef __linux__
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/inotify.h>
+#endif
+
+static void read_stat(Chip8Watch* watch, int64_t* mtime, int64_t* size) {
+    struct stat st;
+    if (stat(watch->path, &st) == 0) {
+        *mtime = (int64_t)st.st_mtime;
+        *size = (int64_t)st.st_size;
+    } else {
+        *mtime = -1;
+        *size = -1;
+    }
+}
+
+// 读取ROM文件，返回读取的字节数 (文件不可用或太大时返回0)
+static size_t read_rom(const char* path, uint8_t* data) {
+    FILE* file = fopen(path, "rb");
+    if (!file) return 0;
+    size_t size = fread(data, 1, WATCH_MAX_ROM_SIZE + 1, file);
+    fclose(file);
+    if (size > WATCH_MAX_ROM_SIZE) {
+        fprintf(stderr, "警告: ROM文件太大，忽略本次修改: %s\n", path);
+        return 0;
+    }
+    return size;
+}
+
+int chip8_watch_start(Chip8Watch* watch, const char* path) {
+    chip8_watch_stop(watch);
+    memset(watch, 0, sizeof(*watch));
+    watch->fd = -1;
+    
+    if (strlen(path) >= sizeof(watch->path)) {
+        fprintf(stderr, "警告: 无法监视ROM文件: %s\n", path);
+        return 0;
+    }
+    strcpy(watch->path, path);
+    
+    // 比较基准：刚加载的文件内容
+    uint8_t data[WATCH_MAX_ROM_SIZE + 1];
+    watch->loaded_size = read_rom(path, data);
+    memcpy(watch->loaded, data, watch->loaded_size);
+    
+    const char* slash = strrchr(watch->path, '/');
+#ifdef _WIN32
+    const char* backslash = strrchr(watch->path, '\\');
+    if (backslash && (!slash || backslash > slash)) slash = backslash;
+#endif
+    watch->name = slash ? slash + 1 : watch->path;
+
+#ifdef __linux__
+    // 监视所在目录：写入后关闭、重命名到该文件名都算一次修改
+    char dir[1024];
+    if (slash) {
+        size_t len = (size_t)(slash - watch->path);
+        memcpy(dir, watch->path, len);
+        dir[len] = '\0';
+        if (len == 0) strcpy(dir, "/");
+    } else {
+        strcpy(dir, ".");
+    }
+    
+    watch->fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (watch->fd >= 0) {
+        watch->wd = inotify_add_watch(watch->fd, dir, IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE);
+        if (watch->wd < 0) {
+            close(watch->fd);
+            watch->fd = -1;
+        }
+    }
+#endif
+    
+    read_stat(watch, &watch->mtime, &watch->size);
+    watch->active = 1;
+    return 1;
+}
+
+void chip8_watch_stop(Chip8Watch* watch) {
+    if (!watch->active) return;
+#ifdef __linux__
+    if (watch->fd >= 0) close(watch->fd);
+#endif
+    watch->fd = -1;
+    watch->active = 0;
+}
+
+int chip8_watch_poll(Chip8Watch* watch) {
+    if (!watch->active) return 0;
+
+#ifdef __linux__
+    if (watch->fd >= 0) {
+        char buf[4096] __attribute__((aligned(__alignof__(struct inotify_event))));
+        int changed = 0;
+        for (;;) {
+            ssize_t len = read(watch->fd, buf, sizeof(buf));
+            if (len <= 0) break;
+            for (char* p = buf; p < buf + len; ) {
+                struct inotify_event* event = (struct inotify_event*)p;
+                if (event->len > 0 && strcmp(event->name, watch->name) == 0) {
+                    changed = 1;
+                }
+                p += sizeof(struct inotify_event) + event->len;
+            }
+        }
+        return changed;
+    }
+#endif
+    
+    // 轮询：修改时间或大小变化
+    uint32_t now = SDL_GetTicks();
+    if (now - watch->last_poll < WATCH_POLL_MS) return 0;
+    watch->last_poll = now;
+    
+    int64_t mtime, size;
+    read_stat(watch, &mtime, &size);
+    if (mtime < 0 || (mtime == watch->mtime && size == watch->size)) return 0;
+    watch->mtime = mtime;
+    watch->size = size;
+    return 1;
+}
+
+// 比较新旧内容，收集变化区间 (合并相距不到4字节的变化)
+static void diff_rom(const uint8_t* old_data, size_t old_size, const uint8_t* new_data, size_t new_size,
+                     WatchPatch* patch) {
+    size_t size = old_size > new_size ? old_size : new_size;
+    size_t i = 0;
+    while (i < size) {
+        uint8_t a = i < old_size ? old_data[i] : 0;
+        uint8_t b = i < new_size ? new_data[i] : 0;
+        if (a == b) {
+            i++;
+            continue;
+        }
+        
+        size_t start = i, end = i + 1, gap = 0;
+        patch->changed_bytes++;
+        for (i = i + 1; i < size && gap < 4; i++) {
+            a = i < old_size ? old_data[i] : 0;
+            b = i < new_size ? new_data[i] : 0;
+            if (a != b) {
+                patch->changed_bytes++;
+                end = i + 1;
+                gap = 0;
+            } else {
+                gap++;
+            }
+        }
+        i = end;
+        
+        if (patch->range_count < WATCH_MAX_RANGES) {
+            patch->ranges[patch->range_count].start = (uint16_t)(PROGRAM_START + start);
+            patch->ranges[patch->range_count].end = (uint16_t)(PROGRAM_START + end);
+        }
+        patch->range_count++;
+    }
+}
+
+int chip8_watch_reload(Chip8Watch* watch, Chip8* chip8, int reset, WatchPatch* patch) {
+    memset(patch, 0, sizeof(*patch));
+    
+    // 构建工具可能先截断再写入，空文件等下一次修改
+    uint8_t data[WATCH_MAX_ROM_SIZE + 1];
+    size_t size = read_rom(watch->path, data);
+    if (size == 0) return 0;
+    
+    patch->old_size = watch->loaded_size;
+    patch->new_size = size;
+    diff_rom(watch->loaded, watch->loaded_size, data, size, patch);
+    
+    if (reset) {
+        // 重置后保留随机数配置和兼容性配置
+        Chip8Rng rng = chip8->rng;
+        uint8_t quirks = chip8->quirks;
+        chip8_reset(chip8, rng.seed);
+        chip8_rng_init(&chip8->rng, (Chip8RngKind)rng.kind, rng.seed, rng.instance);
+        chip8->quirks = quirks;
+        chip8_load_rom_data(chip8, data, size);
+    } else {
+        // 只写入变化的字节；程序运行时改写过的其他内存保持不变。
+        // 新ROM变短时，旧ROM多出的部分清零
+        for (size_t i = 0; i < watch->loaded_size || i < size; i++) {
+            uint8_t old_byte = i < watch->loaded_size ? watch->loaded[i] : 0;
+            uint8_t new_byte = i < size ? data[i] : 0;
+            if (old_byte != new_byte) chip8->memory[PROGRAM_START + i] = new_byte;
+        }
+    }
+    
+    memcpy(watch->loaded, data, size);
+    watch->loaded_size = size;
+    read_stat(watch, &watch->mtime, &watch->size);
+    return 1;
+}
@@ -0,0 +1,55 @@
+#ifndef CHIP8_WATCH_H
+#define CHIP8_WATCH_H
+
+#include "chip8.h"
+
+// ROM热重载：监视已加载的ROM文件，文件写完后与上次加载的内容逐字节比较，
+// 只把变化的区间写入内存 (保留运行状态)，或者完整重置后重新加载。
+// Linux上用inotify监视所在目录 (编辑器和构建工具常以重命名方式替换文件)，
+// 其他平台按修改时间和大小轮询
+
+#define WATCH_MAX_ROM_SIZE (MEMORY_SIZE - PROGRAM_START)
+#define WATCH_POLL_MS 16               // 轮询间隔 (无inotify时)
+#define WATCH_MAX_RANGES 16            // 报告的变化区间数上限
+
+// 变化区间 (内存地址，含 start，不含 end)
+typedef struct {
+    uint16_t start;
+    uint16_t end;
+} WatchRange;
+
+typedef struct {
+    char path[1024];
+    const char* name;                  // path 中的文件名部分
+    int fd;                            // inotify描述符 (-1=轮询)
+    int wd;
+    int64_t mtime;                     // 轮询：上次看到的修改时间和大小
+    int64_t size;
+    uint32_t last_poll;
+    int active;
+    
+    uint8_t loaded[WATCH_MAX_ROM_SIZE];  // 上次加载的ROM内容
+    size_t loaded_size;
+} Chip8Watch;
+
+// 热重载结果
+typedef struct {
+    int changed_bytes;
+    int range_count;                   // 变化区间总数 (ranges 中最多保存 WATCH_MAX_RANGES 个)
+    WatchRange ranges[WATCH_MAX_RANGES];
+    size_t old_size;
+    size_t new_size;
+} WatchPatch;
+
+// 开始监视刚加载的ROM文件 (以当前文件内容作为比较基准)
+int chip8_watch_start(Chip8Watch* watch, const char* path);
+void chip8_watch_stop(Chip8Watch* watch);
+
+// 非阻塞检查文件是否已重写，返回1表示需要重新加载
+int chip8_watch_poll(Chip8Watch* watch);
+
+// 读取新的ROM。reset=0 时只把与上次加载不同的字节写入内存；
+// reset=1 时重置机器并完整加载。返回0表示文件不可用 (继续等待下一次修改)
+int chip8_watch_reload(Chip8Watch* watch, Chip8* chip8, int reset, WatchPatch* patch);
+
+#endif // CHIP8_WATCH_H
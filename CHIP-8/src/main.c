@@ -1,85 +1,316 @@
-// main.c - CHIP-8ģ
+// main.c - CHIP-8模拟器主程序
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 #include <ctype.h>
 #include <SDL2/SDL_timer.h>
 #include "chip8.h"
+#include "chip8_shm.h"
+#include "chip8_record.h"
+#include "chip8_scale.h"
+#include "chip8_trace.h"
+#include "chip8_metrics.h"
+#include "chip8_romlib.h"
+#include "chip8_state.h"
+#include "chip8_input.h"
+#include "chip8_debug.h"
+#include "chip8_timing.h"
+#include "chip8_governor.h"
+#include "chip8_netplay.h"
+#include "chip8_watch.h"
+#include "chip8_perf.h"
+#include "chip8_pacing.h"
 
-// Ϸٶȿ
-static int game_speed = CPU_DEFAULT_SPEED;  // Ϸٶ (ָ/)
-static int frame_counter = 0;              // ֡
-static Uint32 last_fps_time = 0;           // ϴμFPSʱ
-static int frame_count_since_last = 0;     // ϴμFPS֡
-static float current_fps = 0.0f;           // ǰFPS
-static Uint32 last_cycle_time = 0;         // ϴִCPUڵʱ
-static float cycle_accumulator = 0.0f;     // ۻʱ䣨CPUڣ
+// 兼容性配置方式 (>=0 时为指定的 RomPlatform)
+#define QUIRKS_LIBRARY -3                  // 从ROM库启动时按索引中的平台，直接加载的文件不调整
+#define QUIRKS_AUTO -2                     // 总是按静态分析出的平台
+#define QUIRKS_NONE -1                     // 不调整 (CHIP8_QUIRKS_DEFAULT)
 
-// 
+// 游戏速度控制
+static int game_speed = CPU_DEFAULT_SPEED;  // 游戏速度 (指令/秒)
+static int frame_counter = 0;              // 帧计数器
+static Uint32 last_fps_time = 0;           // 上次计算FPS的时间
+static int frame_count_since_last = 0;     // 上次计算FPS以来的帧数
+static float current_fps = 0.0f;           // 当前FPS
+static Uint32 last_cycle_time = 0;         // 上次执行CPU周期的时间
+static float cycle_accumulator = 0.0f;     // 累积的时间（用于CPU周期）
+static uint64_t emulated_frames = 0;       // 已模拟的帧数 (60Hz定时器节拍)
+
+// 命令行选项
+static int headless = 0;                   // 无窗口模式 (不初始化图形和音频)
+static const char* shm_name = NULL;        // 共享内存帧导出名称
+static Chip8Shm frame_shm;                 // 共享内存帧导出
+static int shm_force = 0;                  // 同名共享内存已存在时删除后重新创建
+static const char* record_path = NULL;     // 录制文件路径
+static int record_scale = RECORD_DEFAULT_SCALE;  // 录制缩放倍数
+static Chip8Recorder recorder;             // 后台录制器
+static uint64_t reported_drops = 0;        // 已报告的录制丢帧数
+static const char* trace_path = NULL;      // 执行跟踪转储文件
+static uint32_t trace_size = TRACE_DEFAULT_ENTRIES;  // 跟踪缓冲区条目数
+static Chip8Trace trace;                   // 执行跟踪缓冲区
+static const char* metrics_path = NULL;    // 指标服务套接字路径
+static uint64_t emu_frame_ticks = 0;       // 本帧内执行指令累计的主机时间 (性能计数器)
+static uint64_t last_present_ticks = 0;    // 上次提交画面的时间 (性能计数器)
+static const char* library_dirs[ROMLIB_MAX_DIRS];  // 要扫描的ROM目录
+static int library_dir_count = 0;
+static const char* library_index = ROMLIB_DEFAULT_INDEX;  // ROM库索引文件
+static const char* play_query = NULL;      // 从ROM库启动的ROM (名称或哈希)
+static int list_library = 0;               // 列出ROM库后退出
+static const char* state_path = NULL;      // 持久化状态文件
+static Chip8StateFile state_file;          // 映射的持久化状态
+static Chip8InputQueue input_queue;        // 带时间戳的按键事件队列
+static int debug_enabled = 0;              // 调试器已启用 (--debug 或 F5)
+static Chip8Debugger debugger;             // 调试器状态
+static int timing_model = TIMING_MODEL_SPEED;  // 时序模型
+static int governor_enabled = 0;           // 速度调节器模式
+static double governor_share = 1.0;        // 允许使用的CPU份额
+static int governor_ipf = 0;               // 每帧指令数 (0=按ROM平台选择)
+static Chip8Governor governor;             // 速度调节器状态
+static const char* netplay_spec = NULL;    // 联机参数 (本地端口,对端地址:端口)
+static int netplay_player = 1;             // 联机玩家编号
+static Chip8Netplay netplay;               // 回滚联机状态
+static uint16_t netplay_keys = 0;          // 联机模式下本地按住的CHIP-8按键 (位掩码)
+static int watch_enabled = 0;              // ROM热重载
+static int watch_reset = 0;                // 热重载时完整重置 (否则保留运行状态只替换变化的字节)
+static Chip8Watch rom_watch;               // 监视已加载的ROM文件
+static int perf_enabled = 0;               // 硬件性能计数器
+static int perf_opcodes = 0;               // 按操作码类别逐条测量
+static Chip8Perf perf;                     // 性能计数器状态
+static int rng_kind = CHIP8_RNG_PHILOX;    // CXNN随机数生成器
+static unsigned int rng_seed = 0;          // 运行种子
+static int rng_seed_set = 0;               // 指定了 --seed (否则每次加载使用新的随机种子)
+static unsigned int rng_instance = 0;      // 实例号 (同一种子下区分并行实例)
+static int vsync_enabled = 0;              // 垂直同步：每帧安排在消隐之前完成
+static double vsync_margin_us = PACING_DEFAULT_MARGIN_US;  // 消隐之前预留的余量
+static Chip8Pacer pacer;                   // 垂直同步节奏和输入延迟统计
+static int quirks_mode = QUIRKS_LIBRARY;   // 兼容性配置 (QUIRKS_* 或 RomPlatform)
+static int audio_pending = 0;              // 音频设备正在后台打开
+static int bench_startup = 0;              // 报告启动各阶段用时后退出
+static uint64_t startup_begin = 0;         // 进入 main 的时刻 (性能计数器)
+
+// 性能计数器差值转换为微秒
+static uint64_t ticks_to_us(uint64_t ticks) {
+    return ticks * 1000000 / SDL_GetPerformanceFrequency();
+}
+
+// 同上，保留小数 (用于测量单帧内很短的时间)
+static double ticks_to_us_exact(uint64_t ticks) {
+    return (double)ticks * 1000000.0 / (double)SDL_GetPerformanceFrequency();
+}
+
+// 启动阶段完成：--bench-startup 时打印从进入 main 到此刻的用时
+static void startup_mark(const char* stage) {
+    if (!bench_startup) return;
+    printf("启动: %8.2fms  %s\n", ticks_to_us_exact(SDL_GetPerformanceCounter() - startup_begin) / 1000.0, stage);
+}
+
+// 输入到画面的延迟：刚完成的提交反映了之前已应用的所有按键事件
+static void observe_input_latency(uint64_t present_end) {
+    uint64_t applied[INPUT_APPLIED_MAX];
+    int count = chip8_input_take_applied(&input_queue, applied, INPUT_APPLIED_MAX);
+    for (int i = 0; i < count; i++) {
+        uint64_t us = chip8_pacer_latency(&pacer, applied[i], present_end);
+        if (metrics_path) {
+            metrics_observe(METRICS_THREAD_MAIN, METRIC_HIST_INPUT_LATENCY, us);
+        }
+    }
+}
+
+// 函数声明
 void change_game_speed(int delta);
 void handle_key_event(Chip8* chip8, SDL_KeyboardEvent* key);
+int chip8_key_from_sdl(SDL_Keycode sym);
 void update_fps_display(void);
 int load_and_run_rom(Chip8* chip8, const char* rom_path);
+int load_library_rom(Chip8* chip8, const Chip8RomLibrary* lib, const RomEntry* entry);
+void print_usage(const char* prog);
 
-// ļչǷΪ.ch8ִСд
+// 检查文件扩展名是否为.ch8（不区分大小写）
 int is_ch8_file(const char* filename) {
     if (!filename) return 0;
     
-    // ļչ
+    // 查找文件扩展名
     const char* dot = strrchr(filename, '.');
     if (!dot || dot == filename) {
         return 0;
     }
     
-    // չǷΪ.ch8ִСд
+    // 检查扩展名是否为.ch8（不区分大小写）
     return (strcasecmp(dot, ".ch8") == 0);
 }
 
-// زROMļ
+// 计算ROM文件内容的XXH64 (与ROM库索引一致)
+static uint64_t hash_rom_file(const char* path) {
+    Chip8MappedFile map;
+    if (!chip8_mmap_open(&map, path, 0, 0)) return 0;
+    uint64_t hash = chip8_xxh64(map.data, map.size, 0);
+    chip8_mmap_close(&map);
+    return hash;
+}
+
+// 速度调节器：按已加载ROM的静态分析结果选择每帧指令数
+static void configure_governor(const Chip8* chip8) {
+    if (!governor_enabled) return;
+    
+    RomEntry entry;
+    chip8_romlib_analyze(&chip8->memory[PROGRAM_START], MEMORY_SIZE - PROGRAM_START, &entry);
+    int ipf = governor_ipf > 0 ? governor_ipf : chip8_governor_profile_ipf(&entry);
+    chip8_governor_init(&governor, ipf, governor_share);
+    printf("速度调节器: %s平台，每帧%d条指令，CPU份额%.0f%%\n",
+           chip8_romlib_platform_name(entry.platform), ipf, governor.cpu_share * 100.0);
+}
+
+// 兼容性配置：entry 为ROM库条目 (直接加载文件时为NULL)
+static void configure_quirks(Chip8* chip8, const RomEntry* entry) {
+    RomEntry analyzed;
+    int platform;
+    if (quirks_mode >= 0) {
+        platform = quirks_mode;
+    } else if (quirks_mode == QUIRKS_NONE || (quirks_mode == QUIRKS_LIBRARY && !entry)) {
+        return;
+    } else if (entry) {
+        platform = entry->platform;
+    } else {
+        chip8_romlib_analyze(&chip8->memory[PROGRAM_START], MEMORY_SIZE - PROGRAM_START, &analyzed);
+        platform = analyzed.platform;
+    }
+    
+    chip8->quirks = chip8_romlib_platform_quirks(platform);
+    printf("兼容性配置: %s平台 (quirks=0x%02X)\n", chip8_romlib_platform_name(platform), chip8->quirks);
+}
+
+// 随机数：按 (运行种子, 实例号) 重新开始序列
+static void configure_rng(Chip8* chip8) {
+    uint32_t seed = rng_seed_set ? rng_seed : chip8->rng.seed;
+    chip8_rng_init(&chip8->rng, (Chip8RngKind)rng_kind, seed, rng_instance);
+}
+
+// 联机：以加载后的程序内存哈希作为双方共同的起点
+static void configure_netplay(Chip8* chip8) {
+    if (!netplay_spec) return;
+    
+    uint64_t rom_hash = chip8_xxh64(&chip8->memory[PROGRAM_START], MEMORY_SIZE - PROGRAM_START, 0);
+    chip8_netplay_begin(&netplay, chip8, rom_hash);
+    printf("联机: 等待对端加载同一个ROM (%016llx)\n", (unsigned long long)rom_hash);
+}
+
+// 热重载：监视刚加载的ROM文件
+static void start_watch(const char* rom_path) {
+    if (!watch_enabled) return;
+    
+    if (chip8_watch_start(&rom_watch, rom_path)) {
+        printf("热重载: 正在监视 %s (%s)\n", rom_path, watch_reset ? "修改后完整重置" : "修改后保留运行状态");
+    }
+}
+
+// ROM文件被重写：只替换变化的字节 (或完整重置)，并让依赖程序内容的缓存失效
+static void hot_reload(Chip8* chip8) {
+    uint64_t start = SDL_GetPerformanceCounter();
+    WatchPatch patch;
+    if (!chip8_watch_reload(&rom_watch, chip8, watch_reset, &patch)) {
+        return;
+    }
+    
+    if (watch_reset) {
+        configure_governor(chip8);
+    } else {
+        governor.loop_valid = 0;  // 空转检测记录的循环可能已被修改
+    }
+    if (state_path) {
+        chip8_state_set_rom(&state_file, chip8_xxh64(rom_watch.loaded, rom_watch.loaded_size, 0));
+    }
+    uint64_t elapsed = ticks_to_us(SDL_GetPerformanceCounter() - start);
+    
+    if (patch.changed_bytes == 0) {
+        printf("热重载: ROM内容没有变化\n");
+        return;
+    }
+    printf("热重载: %s, %d字节变化, %d个区间 (%zu -> %zu字节), 用时%lluus\n",
+           watch_reset ? "已重置" : "已替换", patch.changed_bytes, patch.range_count,
+           patch.old_size, patch.new_size, (unsigned long long)elapsed);
+    for (int i = 0; i < patch.range_count && i < WATCH_MAX_RANGES; i++) {
+        printf("  0x%03X-0x%03X\n", patch.ranges[i].start, patch.ranges[i].end - 1);
+    }
+    if (patch.range_count > WATCH_MAX_RANGES) {
+        printf("  ... 另有%d个区间\n", patch.range_count - WATCH_MAX_RANGES);
+    }
+}
+
+// 加载并运行ROM文件
 int load_and_run_rom(Chip8* chip8, const char* rom_path) {
     if (!chip8 || !rom_path) {
-        fprintf(stderr, ": ROMΪ\n");
+        fprintf(stderr, "错误: 加载ROM参数为空\n");
         return 0;
     }
     
-    // ļչ
+    // 检查文件扩展名
     if (!is_ch8_file(rom_path)) {
-        fprintf(stderr, ": ļ '%s' .ch8ʽROMļ\n", rom_path);
+        fprintf(stderr, "错误: 文件 '%s' 不是.ch8格式的ROM文件\n", rom_path);
         return 0;
     }
     
-    printf("ڼROMļ: %s\n", rom_path);
+    printf("正在加载ROM文件: %s\n", rom_path);
     
-    // CHIP-8ϵͳ
-    chip8_init(chip8);
+    // 重置CHIP-8系统 (静默，窗口和音频等主机字段保持不变)
+    chip8_reset(chip8, chip8_rng_entropy());
     
-    // ROM
+    // 加载ROM
     if (!chip8_load_rom(chip8, rom_path)) {
-        fprintf(stderr, ": ޷ROMļ '%s'\n", rom_path);
-        fprintf(stderr, "ȷļҴС\n");
+        fprintf(stderr, "错误: 无法加载ROM文件 '%s'\n", rom_path);
+        fprintf(stderr, "请确保文件存在且大小合适\n");
+        return 0;
+    }
+    
+    if (state_path) {
+        chip8_state_set_rom(&state_file, hash_rom_file(rom_path));
+    }
+    
+    configure_quirks(chip8, NULL);
+    configure_governor(chip8);
+    configure_rng(chip8);
+    configure_netplay(chip8);
+    start_watch(rom_path);
+    printf("ROM加载成功: %s\n", rom_path);
+    printf("文件路径: %s\n", rom_path);
+    printf("按 ESC 键退出, 按 O/P 键调整游戏速度\n");
+    
+    return 1;
+}
+
+// 从ROM库加载ROM
+int load_library_rom(Chip8* chip8, const Chip8RomLibrary* lib, const RomEntry* entry) {
+    chip8_reset(chip8, chip8_rng_entropy());
+    if (!chip8_romlib_load(lib, entry, chip8)) {
         return 0;
     }
     
-    printf("ROMسɹ: %s\n", rom_path);
-    printf("ļ·: %s\n", rom_path);
-    printf(" ESC ˳,  O/P Ϸٶ\n");
+    if (state_path) {
+        chip8_state_set_rom(&state_file, entry->xxh64);
+    }
     
+    configure_quirks(chip8, entry);
+    configure_governor(chip8);
+    configure_rng(chip8);
+    configure_netplay(chip8);
+    start_watch(chip8_romlib_path(lib, entry));
+    printf("按 ESC 键退出, 按 O/P 键调整游戏速度\n");
     return 1;
 }
 
-// ıϷٶ
+// 改变游戏速度
 void change_game_speed(int delta) {
     int old_speed = game_speed;
     
-    // 𲽵ٶȣ100, 200, 300, 400, 500, 600, 700, 800, 900, 1000, 2000
+    // 逐步调整速度：100, 200, 300, 400, 500, 600, 700, 800, 900, 1000, 2000
     if (delta > 0) {
-        // 
+        // 加速
         if (game_speed < 1000) {
             game_speed += 100;
         } else {
-            game_speed = 2000;  // 1000ֱӵ2000
+            game_speed = 2000;  // 从1000直接到2000
         }
     } else {
-        // 
+        // 减速
         if (game_speed > 100) {
             if (game_speed == 2000) {
                 game_speed = 1000;
@@ -89,7 +320,7 @@ void change_game_speed(int delta) {
         }
     }
     
-    // ٶȷΧ
+    // 限制速度范围
     if (game_speed < CPU_MIN_SPEED) {
         game_speed = CPU_MIN_SPEED;
     }
@@ -97,291 +328,1025 @@ void change_game_speed(int delta) {
         game_speed = CPU_MAX_SPEED;
     }
     
-    // ٶȸıˣӡϢ
+    // 如果速度改变了，打印消息
     if (old_speed != game_speed) {
-        printf("Ϸٶȸı: %d -> %d ָ/ (O=, P=)\n", old_speed, game_speed);
-        printf("ٶȼ: ");
-        if (game_speed == 100) printf("");
-        else if (game_speed == 200) printf("");
-        else if (game_speed == 300) printf("");
-        else if (game_speed == 400) printf("");
-        else if (game_speed == 500) printf("");
-        else if (game_speed == 600) printf("Ͽ");
-        else if (game_speed == 700) printf("");
-        else if (game_speed == 800) printf("ܿ");
-        else if (game_speed == 900) printf("");
-        else if (game_speed == 1000) printf("");
-        else if (game_speed == 2000) printf("");
+        printf("游戏速度改变: %d -> %d 指令/秒 (O=减速, P=加速)\n", old_speed, game_speed);
+        printf("速度级别: ");
+        if (game_speed == 100) printf("极慢");
+        else if (game_speed == 200) printf("很慢");
+        else if (game_speed == 300) printf("慢");
+        else if (game_speed == 400) printf("较慢");
+        else if (game_speed == 500) printf("正常");
+        else if (game_speed == 600) printf("较快");
+        else if (game_speed == 700) printf("快");
+        else if (game_speed == 800) printf("很快");
+        else if (game_speed == 900) printf("极快");
+        else if (game_speed == 1000) printf("超快");
+        else if (game_speed == 2000) printf("极限");
         printf("\n");
     }
 }
 
-// ӳ䣺PC̰ӳ䵽CHIP-816
-void handle_key_event(Chip8* chip8, SDL_KeyboardEvent* key) {
-    uint8_t chip8_key = 0xFF;
+// 键盘映射：将PC键盘按键映射到CHIP-8的16键键盘
+// 键盘到CHIP-8按键的映射，不是CHIP-8按键时返回-1
+int chip8_key_from_sdl(SDL_Keycode sym) {
+    switch (sym) {
+        case SDLK_1: return 0x1;
+        case SDLK_2: return 0x2;
+        case SDLK_3: return 0x3;
+        case SDLK_4: return 0xC;
+        
+        case SDLK_q: return 0x4;
+        case SDLK_w: return 0x5;
+        case SDLK_e: return 0x6;
+        case SDLK_r: return 0xD;
+        
+        case SDLK_a: return 0x7;
+        case SDLK_s: return 0x8;
+        case SDLK_d: return 0x9;
+        case SDLK_f: return 0xE;
+        
+        case SDLK_z: return 0xA;
+        case SDLK_x: return 0x0;
+        case SDLK_c: return 0xB;
+        case SDLK_v: return 0xF;
+        
+        default: return -1;
+    }
+}
+
+// 事件监视回调：事件进入SDL队列时调用 (通常在主线程的 SDL_PollEvent 中)，
+// 在这里打上时间戳放入输入队列。时间戳是取出事件的时刻而不是系统收到按键的时刻，
+// 只用于输入到画面的延迟统计，不用于在一批指令内部安排事件
+static int input_event_watch(void* userdata, SDL_Event* event) {
+    Chip8InputQueue* queue = (Chip8InputQueue*)userdata;
     
-    // ԰ظ¼
+    if ((event->type == SDL_KEYDOWN || event->type == SDL_KEYUP) && !event->key.repeat) {
+        int chip8_key = chip8_key_from_sdl(event->key.keysym.sym);
+        if (chip8_key >= 0) {
+            chip8_input_push(queue, SDL_GetPerformanceCounter(), (uint8_t)chip8_key,
+                             event->type == SDL_KEYDOWN);
+        }
+    }
+    return 1;
+}
+
+// 处理控制键 (CHIP-8按键由 input_event_watch 送入输入队列)
+void handle_key_event(Chip8* chip8, SDL_KeyboardEvent* key) {
+    // 忽略按键重复事件
     if (key->repeat) {
         return;
     }
     
-    // ӡµļ
+    // 打印按下的键
     if (key->type == SDL_KEYDOWN) {
-        printf(": %s\n", SDL_GetKeyName(key->keysym.sym));
+        printf("按键: %s\n", SDL_GetKeyName(key->keysym.sym));
     }
     
     switch (key->keysym.sym) {
-        case SDLK_1: chip8_key = 0x1; break;
-        case SDLK_2: chip8_key = 0x2; break;
-        case SDLK_3: chip8_key = 0x3; break;
-        case SDLK_4: chip8_key = 0xC; break;
-        
-        case SDLK_q: chip8_key = 0x4; break;
-        case SDLK_w: chip8_key = 0x5; break;
-        case SDLK_e: chip8_key = 0x6; break;
-        case SDLK_r: chip8_key = 0xD; break;
-        
-        case SDLK_a: chip8_key = 0x7; break;
-        case SDLK_s: chip8_key = 0x8; break;
-        case SDLK_d: chip8_key = 0x9; break;
-        case SDLK_f: chip8_key = 0xE; break;
-        
-        case SDLK_z: chip8_key = 0xA; break;
-        case SDLK_x: chip8_key = 0x0; break;
-        case SDLK_c: chip8_key = 0xB; break;
-        case SDLK_v: chip8_key = 0xF; break;
-        
-        // B-̷
+        // B键-短蜂鸣声
         case SDLK_b:  
             if (key->type == SDL_KEYDOWN) {
-                printf("=== ̷ ===\n");
-                chip8->sound_timer = 12;  // Ϊ12Լ0.2룩
-                printf("ʱΪ: %u (Լ%.1f)\n", 
+                printf("=== 触发短蜂鸣测试 ===\n");
+                chip8->sound_timer = 12;  // 改为12（约0.2秒）
+                printf("声音定时器设置为: %u (约%.1f秒)\n", 
                        chip8->sound_timer, (float)chip8->sound_timer / 60.0f);
             }
             break;
             
-        // O
+        // O键减速
         case SDLK_o:
             if (key->type == SDL_KEYDOWN) {
-                printf("===  ===\n");
-                change_game_speed(-1);  // Ϸٶ
+                printf("=== 减速 ===\n");
+                change_game_speed(-1);  // 降低游戏速度
+            }
+            break;
+            
+        // F5键暂停/继续 (首次按下时启用调试器)
+        case SDLK_F5:
+            if (key->type == SDL_KEYDOWN) {
+                if (!debug_enabled) {
+                    chip8_debug_init(&debugger);
+                    chip8_debug_console_start(&debugger);
+                    debug_enabled = 1;
+                }
+                if (debugger.paused) {
+                    chip8_debug_continue(&debugger);
+                    printf("[调试] 继续运行\n");
+                } else {
+                    chip8_debug_pause(&debugger, chip8, "暂停");
+                }
+            }
+            break;
+            
+        // F10键单步跳过，F11键单步
+        case SDLK_F10:
+        case SDLK_F11:
+            if (key->type == SDL_KEYDOWN && debug_enabled && debugger.paused) {
+                if (key->keysym.sym == SDLK_F10) {
+                    chip8_debug_step_over(&debugger, chip8);
+                } else {
+                    chip8_debug_step(&debugger, chip8, 1);
+                }
+            }
+            break;
+            
+        // F2键切换放大滤镜
+        case SDLK_F2:
+            if (key->type == SDL_KEYDOWN) {
+                chip8_graphics_set_filter(chip8, (chip8->scale_filter + 1) % SCALE_FILTER_COUNT);
             }
             break;
             
-        // P
+        // P键加速
         case SDLK_p:
             if (key->type == SDL_KEYDOWN) {
-                printf("===  ===\n");
-                change_game_speed(1);  // Ϸٶ
+                printf("=== 加速 ===\n");
+                change_game_speed(1);  // 增加游戏速度
             }
             break;
             
         default: break;
     }
+}
+
+// 打印命令行用法
+void print_usage(const char* prog) {
+    printf("用法: %s [选项] [ROM文件.ch8]\n", prog);
+    printf("选项:\n");
+    printf("  --headless        无窗口运行 (不初始化图形和音频，必须指定ROM)\n");
+    printf("  --shm <名称>      将每一帧发布到共享内存，供 shm_reader 等外部工具读取\n");
+    printf("  --shm-force       同名共享内存已存在时删除后重新创建 (上次未正常退出时使用)\n");
+    printf("  --record <文件>   后台录制视频 (.y4m为Y4M，其他为原始RGB24)，蜂鸣声写入同名.wav\n");
+    printf("  --record-scale <N> 录制缩放倍数 (默认%d)\n", RECORD_DEFAULT_SCALE);
+    printf("  --filter <名称>   放大滤镜: nearest, scale2x, scale3x, scale4x, epx, crt (运行时按F2切换)\n");
+    printf("  --trace <文件>    开启执行跟踪，故障或崩溃时自动转储 (用 trace_decode 查看)\n");
+    printf("  --trace-size <N>  跟踪缓冲区条目数 (默认%d，每条8字节)\n", TRACE_DEFAULT_ENTRIES);
+    printf("  --metrics <路径>  在UNIX域套接字上提供运行指标 (连接即返回文本快照)\n");
+    printf("  --library <目录>  增量扫描ROM目录并更新索引 (可重复指定)\n");
+    printf("  --index <文件>    ROM库索引文件 (默认%s)\n", ROMLIB_DEFAULT_INDEX);
+    printf("  --play <名称>     从ROM库启动ROM (文件名、路径或SHA-1/XXH64前缀)\n");
+    printf("  --list            列出ROM库内容后退出\n");
+    printf("  --state <文件>    在映射文件中运行机器状态，被杀死后重启可直接恢复\n");
+    printf("  --timing <模型>   时序模型: speed (按游戏速度，默认), vip (COSMAC VIP每帧周期预算)\n");
+    printf("  --quirks <配置>   兼容性差异: auto (按ROM分析出的平台), none (不调整), chip8, schip, xochip\n");
+    printf("                    (默认: 从ROM库启动时按索引中的平台，直接加载的文件不调整)\n");
+    printf("  --governor        速度调节器：每帧指令数按ROM平台选择，空转时让出CPU\n");
+    printf("  --cpu-share <%%>   速度调节器允许每个实例使用的CPU份额 (1-100，默认100，隐含 --governor)\n");
+    printf("  --ipf <N>         速度调节器每帧指令数 (默认按ROM平台: chip8=%d, schip=%d, xochip=%d)\n",
+           GOVERNOR_IPF_CHIP8, GOVERNOR_IPF_SCHIP, GOVERNOR_IPF_XOCHIP);
+    printf("  --netplay <本地端口>,<对端地址:端口>  UDP回滚联机 (双方加载同一个ROM，使用相同的游戏速度)\n");
+    printf("  --player <1|2>    联机玩家编号：1P使用键盘左半边 (1 2 Q W A S Z X)，2P使用右半边 (3 4 E R D F C V)\n");
+    printf("  --watch           ROM文件被重写后自动热重载，只替换变化的字节并保留运行状态\n");
+    printf("  --watch-reset     ROM文件被重写后自动重置并重新加载\n");
+    printf("  --perf            用硬件性能计数器统计每条模拟指令和每帧的主机开销，退出时打印报告 (Linux)\n");
+    printf("  --perf-opcodes    同 --perf，并逐条测量按操作码类别细分 (开销很大)\n");
+    printf("  --rng <名称>      CXNN随机数生成器: philox (默认), lcg (旧版)\n");
+    printf("  --seed <种子>     运行种子 (默认每次加载随机选择)，同一种子和实例号的随机数序列完全相同\n");
+    printf("  --instance <N>    实例号 (默认0)，同一种子下不同实例号的随机数序列相互独立\n");
+    printf("  --vsync           同步到显示器刷新：每帧安排在垂直消隐之前完成，减少撕裂和延迟抖动\n");
+    printf("  --vsync-margin <us> 每帧在消隐之前预留的时间 (默认%d微秒，隐含 --vsync)\n", PACING_DEFAULT_MARGIN_US);
+    printf("  --bench-startup   打印启动各阶段 (首帧、ROM加载、音频就绪) 的用时后退出\n");
+    printf("  --debug           启用调试器并在第一条指令前暂停 (stdin输入命令，运行时按F5暂停/继续)\n");
+    printf("  --help            显示本帮助\n");
+}
+
+// 执行一条指令 (性能计数器按操作码类别测量时逐条计数)
+static void run_cycle(Chip8* chip8) {
+    if (perf_opcodes) {
+        chip8_perf_cycle(&perf, chip8);
+    } else {
+        chip8_cycle(chip8);
+    }
+}
+
+// VIP时序：执行一帧的机器周期预算
+static uint64_t run_vip_frame(Chip8* chip8) {
+    uint64_t now = SDL_GetPerformanceCounter();
+    int32_t budget = chip8_frame_begin(chip8);
+    uint64_t executed = 0;
+    
+    while (budget > 0) {
+        chip8_input_apply(&input_queue, chip8, now);
+        
+        uint16_t pc = chip8->pc;
+        uint16_t opcode = chip8_read_opcode(chip8, pc);
+        if (!debug_enabled) {
+            run_cycle(chip8);
+        } else if (!chip8_debug_cycle(&debugger, chip8)) {
+            break;  // 命中断点，本帧剩余周期作废
+        }
+        executed++;
+        
+        // 原版解释器的DXYN等待垂直消隐 (QUIRK_DISPLAY_WAIT，默认开启)
+        budget = chip8_frame_charge(chip8, budget, opcode, pc, (chip8->quirks & QUIRK_DISPLAY_WAIT) != 0);
+    }
+    
+    chip8_frame_end(chip8, budget);
+    return executed;
+}
+
+// 速度调节器：执行本帧的指令数，程序空转时提前结束本帧
+static uint64_t run_governed_frame(Chip8* chip8) {
+    uint64_t now = SDL_GetPerformanceCounter();
+    int budget = chip8_governor_begin(&governor);
+    int executed = 0;
+    int idle = 0;
+    
+    while (executed < budget) {
+        chip8_input_apply(&input_queue, chip8, now);
+        
+        uint16_t pc = chip8->pc;
+        uint16_t opcode = chip8_read_opcode(chip8, pc);
+        if (!debug_enabled) {
+            run_cycle(chip8);
+        } else if (!chip8_debug_cycle(&debugger, chip8)) {
+            break;  // 命中断点
+        }
+        executed++;
+        
+        if (chip8_governor_spinning(&governor, chip8, pc, opcode)) {
+            // 先应用推迟到后面周期的按键变化 (短按的松开)，按键有变化时程序可能离开循环，继续执行
+            uint8_t keys[16];
+            memcpy(keys, chip8->key, sizeof(keys));
+            chip8_input_apply(&input_queue, chip8, now);
+            if (memcmp(keys, chip8->key, sizeof(keys)) == 0) {
+                idle = 1;
+                break;
+            }
+        }
+    }
     
-    if (chip8_key != 0xFF) {
-        chip8->key[chip8_key] = (key->type == SDL_KEYDOWN) ? 1 : 0;
+    uint64_t end = SDL_GetPerformanceCounter();
+    chip8_governor_end(&governor, executed, ticks_to_us_exact(end - now), idle);
+    if (idle && metrics_path) {
+        metrics_add(METRICS_THREAD_MAIN, METRIC_IDLE_FRAMES, 1);
     }
+    return (uint64_t)executed;
 }
 
-// FPSʾ
+// 更新FPS显示
 void update_fps_display(void) {
     frame_count_since_last++;
     
     Uint32 current_time = SDL_GetTicks();
     Uint32 elapsed = current_time - last_fps_time;
     
-    // ÿ500һFPSʾ
+    // 每500毫秒更新一次FPS显示
     if (elapsed >= 500) {
         current_fps = (float)frame_count_since_last / (elapsed / 1000.0f);
+        metrics_gauge(METRICS_THREAD_MAIN, METRIC_GAUGE_FPS, current_fps);
         last_fps_time = current_time;
         frame_count_since_last = 0;
     }
 }
 
 int main(int argc, char* argv[]) {
-    // ʼCHIP-8
-    Chip8 chip8;
-    chip8_init(&chip8);
+    startup_begin = SDL_GetPerformanceCounter();
+    
+    // 初始化CHIP-8
+    Chip8 local_chip8;
+    Chip8* chip8 = &local_chip8;  // 使用 --state 时指向映射文件中的状态
+    memset(chip8, 0, sizeof(*chip8));
+    chip8_init(chip8);
     
-    // ȷʼROMļͨвָ
+    // 解析命令行参数
     const char* initial_rom_filename = NULL;
-    if (argc > 1) {
-        initial_rom_filename = argv[1];
-        printf("⵽вԼROM: %s\n", initial_rom_filename);
-    } else {
-        printf("δָROMļ뽫.ch8ʽROMļϷŵ\n");
-        printf("ͨвָROMļ·\n");
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--headless") == 0) {
+            headless = 1;
+        } else if (strcmp(argv[i], "--shm") == 0 && i + 1 < argc) {
+            shm_name = argv[++i];
+        } else if (strcmp(argv[i], "--shm-force") == 0) {
+            shm_force = 1;
+        } else if (strcmp(argv[i], "--record") == 0 && i + 1 < argc) {
+            record_path = argv[++i];
+        } else if (strcmp(argv[i], "--record-scale") == 0 && i + 1 < argc) {
+            record_scale = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--filter") == 0 && i + 1 < argc) {
+            int filter = chip8_scale_filter_from_name(argv[++i]);
+            if (filter < 0) {
+                fprintf(stderr, "错误: 未知的放大滤镜: %s\n", argv[i]);
+                return 1;
+            }
+            chip8->scale_filter = filter;
+        } else if (strcmp(argv[i], "--trace") == 0 && i + 1 < argc) {
+            trace_path = argv[++i];
+        } else if (strcmp(argv[i], "--trace-size") == 0 && i + 1 < argc) {
+            trace_size = (uint32_t)strtoul(argv[++i], NULL, 10);
+        } else if (strcmp(argv[i], "--metrics") == 0 && i + 1 < argc) {
+            metrics_path = argv[++i];
+        } else if (strcmp(argv[i], "--library") == 0 && i + 1 < argc) {
+            if (library_dir_count < ROMLIB_MAX_DIRS) {
+                library_dirs[library_dir_count++] = argv[++i];
+            } else {
+                fprintf(stderr, "警告: 最多支持%d个ROM目录，忽略 %s\n", ROMLIB_MAX_DIRS, argv[++i]);
+            }
+        } else if (strcmp(argv[i], "--index") == 0 && i + 1 < argc) {
+            library_index = argv[++i];
+        } else if (strcmp(argv[i], "--play") == 0 && i + 1 < argc) {
+            play_query = argv[++i];
+        } else if (strcmp(argv[i], "--list") == 0) {
+            list_library = 1;
+        } else if (strcmp(argv[i], "--state") == 0 && i + 1 < argc) {
+            state_path = argv[++i];
+        } else if (strcmp(argv[i], "--debug") == 0) {
+            debug_enabled = 1;
+        } else if (strcmp(argv[i], "--timing") == 0 && i + 1 < argc) {
+            timing_model = chip8_timing_from_name(argv[++i]);
+            if (timing_model < 0) {
+                fprintf(stderr, "错误: 未知的时序模型: %s\n", argv[i]);
+                return 1;
+            }
+        } else if (strcmp(argv[i], "--quirks") == 0 && i + 1 < argc) {
+            const char* mode = argv[++i];
+            if (strcmp(mode, "auto") == 0) {
+                quirks_mode = QUIRKS_AUTO;
+            } else if (strcmp(mode, "none") == 0) {
+                quirks_mode = QUIRKS_NONE;
+            } else {
+                quirks_mode = chip8_romlib_platform_from_name(mode);
+                if (quirks_mode < 0) {
+                    fprintf(stderr, "错误: 未知的兼容性配置: %s\n", mode);
+                    return 1;
+                }
+            }
+        } else if (strcmp(argv[i], "--governor") == 0) {
+            governor_enabled = 1;
+        } else if (strcmp(argv[i], "--cpu-share") == 0 && i + 1 < argc) {
+            double percent = atof(argv[++i]);
+            if (percent <= 0.0 || percent > 100.0) {
+                fprintf(stderr, "错误: CPU份额必须在1-100之间: %s\n", argv[i]);
+                return 1;
+            }
+            governor_enabled = 1;
+            governor_share = percent / 100.0;
+        } else if (strcmp(argv[i], "--ipf") == 0 && i + 1 < argc) {
+            governor_ipf = atoi(argv[++i]);
+            governor_enabled = 1;
+        } else if (strcmp(argv[i], "--netplay") == 0 && i + 1 < argc) {
+            netplay_spec = argv[++i];
+        } else if (strcmp(argv[i], "--player") == 0 && i + 1 < argc) {
+            netplay_player = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--watch") == 0) {
+            watch_enabled = 1;
+        } else if (strcmp(argv[i], "--watch-reset") == 0) {
+            watch_enabled = 1;
+            watch_reset = 1;
+        } else if (strcmp(argv[i], "--perf") == 0) {
+            perf_enabled = 1;
+        } else if (strcmp(argv[i], "--rng") == 0 && i + 1 < argc) {
+            rng_kind = chip8_rng_from_name(argv[++i]);
+            if (rng_kind < 0) {
+                fprintf(stderr, "错误: 未知的随机数生成器: %s\n", argv[i]);
+                return 1;
+            }
+        } else if (strcmp(argv[i], "--seed") == 0 && i + 1 < argc) {
+            rng_seed = (unsigned int)strtoul(argv[++i], NULL, 10);
+            rng_seed_set = 1;
+        } else if (strcmp(argv[i], "--instance") == 0 && i + 1 < argc) {
+            rng_instance = (unsigned int)strtoul(argv[++i], NULL, 10);
+        } else if (strcmp(argv[i], "--vsync") == 0) {
+            vsync_enabled = 1;
+        } else if (strcmp(argv[i], "--vsync-margin") == 0 && i + 1 < argc) {
+            vsync_enabled = 1;
+            vsync_margin_us = atof(argv[++i]);
+            if (vsync_margin_us < 0.0) {
+                fprintf(stderr, "错误: 预留余量不能为负数: %s\n", argv[i]);
+                return 1;
+            }
+        } else if (strcmp(argv[i], "--bench-startup") == 0) {
+            bench_startup = 1;
+        } else if (strcmp(argv[i], "--perf-opcodes") == 0) {
+            perf_enabled = 1;
+            perf_opcodes = 1;
+        } else if (strcmp(argv[i], "--help") == 0 || strcmp(argv[i], "-h") == 0) {
+            print_usage(argv[0]);
+            return 0;
+        } else if (argv[i][0] == '-' && argv[i][1] == '-') {
+            fprintf(stderr, "错误: 未知选项或缺少参数: %s\n", argv[i]);
+            print_usage(argv[0]);
+            return 1;
+        } else {
+            initial_rom_filename = argv[i];
+        }
     }
     
-    // ʼͼϵͳ
-    printf("ڳʼͼϵͳ...\n");
-    if (!chip8_graphics_init(&chip8)) {
-        fprintf(stderr, ": ͼϵͳʼʧ\n");
-        return 1;
+    // 回滚联机与以下选项冲突，在打开状态文件和初始化图形/音频之前处理
+    if (netplay_spec) {
+        if (governor_enabled || timing_model == TIMING_MODEL_VIP) {
+            fprintf(stderr, "警告: 联机模式下忽略 --governor 和 --timing vip\n");
+            governor_enabled = 0;
+            timing_model = TIMING_MODEL_SPEED;
+        }
+        if (debug_enabled || state_path) {
+            fprintf(stderr, "警告: 联机模式下忽略 --debug 和 --state\n");
+            debug_enabled = 0;
+            state_path = NULL;
+        }
+        if (watch_enabled) {
+            fprintf(stderr, "警告: 联机模式下忽略 --watch (双方的程序必须相同)\n");
+            watch_enabled = 0;
+        }
+    }
+    
+    // ROM库：先增量扫描，再映射索引
+    if (library_dir_count > 0) {
+        RomScanStats stats;
+        printf("正在扫描ROM库...\n");
+        if (!chip8_romlib_scan(library_index, library_dirs, library_dir_count, &stats)) {
+            fprintf(stderr, "错误: ROM库扫描失败\n");
+            return 1;
+        }
+        printf("ROM库已更新: %u个文件 (沿用%u, 重新哈希%u, 移除%u, 失败%u), 用时%ums\n",
+               stats.files, stats.reused, stats.hashed, stats.removed, stats.failed, stats.elapsed_ms);
+    }
+    
+    Chip8RomLibrary library;
+    int library_open = 0;
+    const RomEntry* play_entry = NULL;
+    if (list_library || play_query) {
+        library_open = chip8_romlib_open(&library, library_index);
+        if (!library_open) {
+            fprintf(stderr, "错误: 无法打开ROM库索引 '%s' (请先用 --library 扫描)\n", library_index);
+            return 1;
+        }
+        if (list_library) {
+            chip8_romlib_list(&library, stdout);
+            chip8_romlib_close(&library);
+            return 0;
+        }
+        
+        play_entry = chip8_romlib_find(&library, play_query);
+        if (!play_entry) {
+            fprintf(stderr, "错误: ROM库中没有找到 '%s'\n", play_query);
+            chip8_romlib_close(&library);
+            return 1;
+        }
+    }
+    
+    // 持久化状态：有效的状态文件且ROM相同 (或未指定ROM) 时直接恢复
+    if (state_path) {
+        if (chip8_state_open(&state_file, state_path, chip8)) {
+            uint64_t requested = play_entry ? play_entry->xxh64 :
+                                 initial_rom_filename ? hash_rom_file(initial_rom_filename) : 0;
+            if (state_file.resumed && requested && requested != state_file.header->rom_hash) {
+                printf("指定的ROM与状态文件中的不同，重新开始\n");
+                chip8_state_restart(&state_file, chip8);
+            }
+            chip8 = state_file.chip8;
+            chip8->scale_filter = local_chip8.scale_filter;
+        } else {
+            fprintf(stderr, "警告: 持久化状态启用失败\n");
+            state_path = NULL;
+        }
     }
     
-    // SDLϷŹ
-    SDL_EventState(SDL_DROPFILE, SDL_ENABLE);
+    // 确定初始ROM文件名（如果通过命令行参数指定）
+    if (state_path && state_file.resumed) {
+        printf("从状态文件恢复: %s\n", state_path);
+    } else if (play_query) {
+        printf("从ROM库启动: %s\n", play_query);
+    } else if (initial_rom_filename) {
+        printf("检测到命令行参数，尝试加载ROM: %s\n", initial_rom_filename);
+    } else if (headless) {
+        fprintf(stderr, "错误: 无窗口模式必须指定ROM文件\n");
+        return 1;
+    } else {
+        printf("未指定ROM文件，请将.ch8格式的ROM文件拖放到窗口中\n");
+        printf("或通过命令行参数指定ROM文件路径\n");
+    }
     
-    // ʼƵϵͳ
-    printf("ڳʼƵϵͳ...\n");
-    if (!chip8_audio_init(&chip8)) {
-        fprintf(stderr, ": Ƶϵͳʼʧܣ\n");
+    if (headless) {
+        // 无窗口模式只需要事件子系统 (接收退出信号)
+        printf("无窗口模式运行\n");
+        if (bench_startup) {
+            fprintf(stderr, "警告: 无窗口模式下忽略 --bench-startup\n");
+            bench_startup = 0;
+        }
+        if (vsync_enabled) {
+            fprintf(stderr, "警告: 无窗口模式下忽略 --vsync\n");
+            vsync_enabled = 0;
+        }
+        if (SDL_Init(SDL_INIT_EVENTS) < 0) {
+            fprintf(stderr, "错误: SDL事件系统初始化失败: %s\n", SDL_GetError());
+            return 1;
+        }
     } else {
-        printf("Ƶϵͳʼɹ\n");
+        // 初始化图形系统
+        printf("正在初始化图形系统...\n");
+        chip8->present_vsync = vsync_enabled;
+        if (!chip8_graphics_init(chip8)) {
+            fprintf(stderr, "错误: 图形系统初始化失败\n");
+            return 1;
+        }
+        startup_mark("渲染器");
+        
+        // 渲染器一创建就提交第一帧 (空白画面或恢复的画面)，ROM加载和其余初始化在之后进行
+        chip8_graphics_update(chip8);
+        startup_mark("首帧");
+        
+        // 音频设备在后台线程打开 (可能要几十到几百毫秒)，打开结束后主循环开始播放
+        printf("正在后台初始化音频系统...\n");
+        if (chip8_audio_init_async(chip8)) {
+            audio_pending = 1;
+        } else {
+            fprintf(stderr, "警告: 音频系统初始化失败，继续无声音运行\n");
+        }
+        
+        // 按窗口所在显示器的刷新率安排每帧 (输入延迟统计不开垂直同步时同样使用)
+        SDL_DisplayMode mode;
+        int refresh_hz = 0;
+        if (SDL_GetCurrentDisplayMode(SDL_GetWindowDisplayIndex(chip8->window), &mode) == 0) {
+            refresh_hz = mode.refresh_rate;
+        }
+        chip8_pacer_init(&pacer, refresh_hz, vsync_margin_us);
+        if (vsync_enabled) {
+            SDL_RendererInfo info;
+            if (SDL_GetRendererInfo(chip8->renderer, &info) != 0 || !(info.flags & SDL_RENDERER_PRESENTVSYNC)) {
+                fprintf(stderr, "警告: 渲染器不支持垂直同步，继续按固定60Hz刷新\n");
+                vsync_enabled = 0;
+            } else {
+                printf("垂直同步: 刷新率%dHz, 消隐前预留%.0f微秒\n", refresh_hz > 0 ? refresh_hz : 60, vsync_margin_us);
+            }
+        }
+        
+        // 启用SDL拖放功能
+        SDL_EventState(SDL_DROPFILE, SDL_ENABLE);
+        
+        // 按键事件经输入队列逐周期应用，短按不会在一批指令中被吞掉 (联机模式按帧采样按键状态，不使用输入队列)
+        chip8_input_init(&input_queue);
+        if (!netplay_spec) {
+            SDL_AddEventWatch(input_event_watch, &input_queue);
+        }
+        
+        printf("图形系统初始化成功\n");
+    }
+    
+    // 共享内存帧导出
+    if (shm_name && !chip8_shm_create(&frame_shm, shm_name, shm_force)) {
+        fprintf(stderr, "警告: 共享内存帧导出启用失败\n");
+        shm_name = NULL;
+    }
+    
+    // 执行跟踪
+    if (trace_path) {
+        if (chip8_trace_init(&trace, trace_size, trace_path)) {
+            chip8->trace = &trace;
+            chip8_trace_install_signal_handlers(&trace);
+        } else {
+            fprintf(stderr, "警告: 执行跟踪启用失败\n");
+            trace_path = NULL;
+        }
+    }
+    
+    // 指标服务
+    if (metrics_path && !chip8_metrics_serve(metrics_path)) {
+        fprintf(stderr, "警告: 指标服务启动失败\n");
+        metrics_path = NULL;
+    }
+    
+    // 后台录制
+    if (record_path && !chip8_record_start(&recorder, record_path, record_scale)) {
+        fprintf(stderr, "警告: 录制启动失败\n");
+        record_path = NULL;
+    }
+    
+    if (governor_enabled && timing_model == TIMING_MODEL_VIP) {
+        fprintf(stderr, "警告: 速度调节器模式下忽略 --timing vip\n");
+        timing_model = TIMING_MODEL_SPEED;
+    }
+    if (timing_model == TIMING_MODEL_VIP) {
+        printf("时序模型: COSMAC VIP (每帧%d机器周期，O/P调速无效)\n", VIP_FRAME_BUDGET);
+    }
+    if (governor_enabled) {
+        printf("速度调节器已启用 (O/P调速无效)\n");
+    }
+    
+    // 回滚联机：每帧固定的指令数，双方的模拟必须逐帧一致
+    if (netplay_spec) {
+        if (!chip8_netplay_open(&netplay, netplay_spec, netplay_player, game_speed / 60)) {
+            return 1;
+        }
+        printf("联机模式 (O/P调速无效)\n");
     }
     
-    printf("ͼϵͳʼɹ\n");
-    printf("ʼϷٶ: %d ָ/\n", game_speed);
-    printf("ϷٶȷΧ: %d-%d ָ/ (O=, P=)\n", CPU_MIN_SPEED, CPU_MAX_SPEED);
-    printf("ٶȼ: 100=, 200=, 300=, 400=, 500=, 600=Ͽ, 700=, 800=ܿ, 900=, 1000=, 2000=\n");
+    // 硬件性能计数器 (回滚重算在联机模块内部进行，只能按帧整体测量)
+    if (perf_enabled) {
+        if (netplay_spec && perf_opcodes) {
+            fprintf(stderr, "警告: 联机模式下忽略 --perf-opcodes，按帧整体测量\n");
+            perf_opcodes = 0;
+        }
+        chip8_perf_init(&perf, perf_opcodes);
+    }
+    printf("初始游戏速度: %d 指令/秒\n", game_speed);
+    printf("游戏速度范围: %d-%d 指令/秒 (O=减速, P=加速)\n", CPU_MIN_SPEED, CPU_MAX_SPEED);
+    printf("速度级别: 100=极慢, 200=很慢, 300=慢, 400=较慢, 500=正常, 600=较快, 700=快, 800=很快, 900=极快, 1000=超快, 2000=极限\n");
     
-    // ṩвԼROM
+    // 如果提供了命令行参数，尝试加载ROM
     int rom_loaded = 0;
-    if (initial_rom_filename) {
-        if (load_and_run_rom(&chip8, initial_rom_filename)) {
+    if (state_path && state_file.resumed) {
+        rom_loaded = 1;
+        printf("已恢复运行状态: PC=0x%03X, I=0x%03X\n", chip8->pc, chip8->I);
+        configure_governor(chip8);
+    } else if (play_entry) {
+        rom_loaded = load_library_rom(chip8, &library, play_entry);
+    } else if (initial_rom_filename) {
+        if (load_and_run_rom(chip8, initial_rom_filename)) {
             rom_loaded = 1;
         }
     }
+    if (library_open) {
+        chip8_romlib_close(&library);
+    }
+    if (rom_loaded) {
+        startup_mark("ROM就绪");
+    }
     
     if (!rom_loaded) {
-        printf("ȴROMļ...\n");
-        printf("뽫.ch8ʽROMļϷŵ\n");
+        printf("等待ROM文件...\n");
+        printf("请将.ch8格式的ROM文件拖放到窗口中\n");
     }
     
-    printf("ʼģ...\n");
+    // 调试器：在第一条指令前暂停
+    if (debug_enabled) {
+        chip8_debug_init(&debugger);
+        chip8_debug_console_start(&debugger);
+        if (rom_loaded) {
+            chip8_debug_pause(&debugger, chip8, "启动");
+        }
+    }
     
-    // ѭ
+    // 启动测速：等音频打开结束后退出，不进入主循环
     int is_running = 1;
+    if (bench_startup) {
+        if (audio_pending) {
+            chip8_audio_finish(chip8, 1);
+            audio_pending = 0;
+        }
+        startup_mark(chip8->audio_initialized ? "音频就绪" : "音频失败");
+        is_running = 0;
+    } else {
+        printf("开始运行模拟器...\n");
+    }
+    
+    // 主循环
     SDL_Event event;
     
-    // ʼʱ
+    // 初始化计时器
     last_cycle_time = SDL_GetTicks();
     last_fps_time = SDL_GetTicks();
     
-    // ʱ¼60Hz
+    // 定时器更新计数器（60Hz）
     static int timer_counter = 0;
     static Uint32 last_timer_update = 0;
     
     while (is_running) {
+        // 垂直同步：睡眠到本帧应该开始的时刻，让按键采样和模拟紧挨着下一次消隐
+        if (vsync_enabled && rom_loaded) {
+            chip8_pacer_wait(&pacer);
+        }
+        
         Uint32 current_time = SDL_GetTicks();
+        uint64_t iteration_start = SDL_GetPerformanceCounter();
+        uint64_t present_ticks = 0;  // 本次迭代中提交画面的用时 (垂直同步时含等待消隐)
+        
+        // 音频设备后台打开结束：开始播放
+        if (audio_pending && chip8_audio_finish(chip8, 0)) {
+            audio_pending = 0;
+            if (!chip8->audio_initialized) {
+                fprintf(stderr, "警告: 音频系统初始化失败，继续无声音运行\n");
+            }
+        }
         
-        // 1. ¼ÿѭȷӦʱ
+        // 1. 处理事件（每次循环都处理，确保响应及时）
         while (SDL_PollEvent(&event)) {
             switch (event.type) {
                 case SDL_QUIT:
-                    printf("յ˳¼\n");
+                    printf("收到退出事件\n");
                     is_running = 0;
                     break;
                     
                 case SDL_KEYDOWN:
                 case SDL_KEYUP:
-                    handle_key_event(&chip8, &event.key);
+                    handle_key_event(chip8, &event.key);
+                    if (netplay_spec && !event.key.repeat) {
+                        int chip8_key = chip8_key_from_sdl(event.key.keysym.sym);
+                        if (chip8_key >= 0 && event.type == SDL_KEYDOWN) {
+                            netplay_keys |= (uint16_t)(1u << chip8_key);
+                        } else if (chip8_key >= 0) {
+                            netplay_keys &= (uint16_t)~(1u << chip8_key);
+                        }
+                    }
                     
-                    // ESC˳
+                    // ESC键退出
                     if (event.type == SDL_KEYDOWN && 
                         event.key.keysym.sym == SDLK_ESCAPE) {
-                        printf("ESC£˳\n");
+                        printf("ESC键按下，退出程序\n");
                         is_running = 0;
                     }
                     break;
                     
                 case SDL_DROPFILE:
-                    // Ϸļ¼
+                    // 拖放文件事件
                     {
                         char* dropped_file_path = event.drop.file;
-                        printf("ļϷ¼: %s\n", dropped_file_path);
+                        printf("文件拖放事件: %s\n", dropped_file_path);
                         
-                        // زROM
-                        if (load_and_run_rom(&chip8, dropped_file_path)) {
+                        // 加载并运行ROM
+                        if (load_and_run_rom(chip8, dropped_file_path)) {
                             rom_loaded = 1;
-                            // мʱ
+                            // 重置所有计时器
                             last_cycle_time = current_time;
                             last_timer_update = current_time;
                             cycle_accumulator = 0.0f;
                             timer_counter = 0;
                         } else {
-                            printf("ROMʧܣļʽ·\n");
+                            printf("加载ROM失败，请检查文件格式和路径\n");
                         }
                         
-                        // ͷSDLļ·ڴ
+                        // 释放SDL分配的文件路径内存
                         SDL_free(dropped_file_path);
                     }
                     break;
                     
                 case SDL_WINDOWEVENT:
-                    // ¼
+                    // 窗口事件处理
                     if (event.window.event == SDL_WINDOWEVENT_RESIZED) {
-                        printf("ڴСı: %dx%d\n", event.window.data1, event.window.data2);
+                        printf("窗口大小改变: %dx%d\n", event.window.data1, event.window.data2);
                     }
                     break;
             }
         }
         
-        // 2. CPUִУϷٶȿƣ
-        if (rom_loaded) {
-            // 㾭ʱ䣨룩
+        // 热重载：ROM文件写完后在下一批指令之前替换
+        if (watch_enabled && rom_loaded && chip8_watch_poll(&rom_watch)) {
+            hot_reload(chip8);
+        }
+        
+        // 调试器：处理控制台命令，暂停时不执行指令也不更新定时器
+        int debug_paused = 0;
+        if (debug_enabled) {
+            chip8_debug_poll(&debugger, chip8);
+            debug_paused = debugger.paused;
+        }
+        
+        // 2. CPU执行（根据游戏速度控制）
+        if (rom_loaded && !debug_paused) {
+            // 调试器冻结的内存在每批指令之前写回
+            if (debug_enabled) {
+                chip8_debug_apply_freezes(&debugger, chip8);
+            }
+            
+            // 计算经过的时间（秒）
             Uint32 elapsed_ms = current_time - last_cycle_time;
             float elapsed_seconds = elapsed_ms / 1000.0f;
             
-            // ϷٶȼӦִеCPU
-            // game_speedÿִеָ
-            // elapsed_secondsǾʱ䣨룩
-            // Ӧִе = ٶ * ʱ
+            // 根据游戏速度计算应该执行的CPU周期数
+            // game_speed是每秒执行的指令数
+            // elapsed_seconds是经过的时间（秒）
+            // 所以应该执行的周期数 = 速度 * 时间
             float cycles_to_execute = game_speed * elapsed_seconds;
+            if (timing_model == TIMING_MODEL_VIP || governor_enabled || netplay_spec) {
+                cycles_to_execute = 0.0f;  // VIP时序、速度调节器和联机在60Hz节拍中按帧执行
+            }
             
-            // ۻۼ
+            // 累积到累加器中
             cycle_accumulator += cycles_to_execute;
             
-            // ִCPU
+            // 执行整数个CPU周期
+            // 每个周期之前应用已收到的按键事件 (同一按键每个周期最多改变一次，短按不会被吞掉)
+            uint64_t batch_start = SDL_GetPerformanceCounter();
+            uint64_t batch_cycles = (uint64_t)cycle_accumulator;
+            uint64_t executed = 0;
+            if (perf_enabled && batch_cycles > 0) chip8_perf_begin(&perf);
             while (cycle_accumulator >= 1.0f) {
-                chip8_cycle(&chip8);
+                executed++;
+                chip8_input_apply(&input_queue, chip8, batch_start);
+                if (!debug_enabled) {
+                    run_cycle(chip8);
+                } else if (!chip8_debug_cycle(&debugger, chip8)) {
+                    cycle_accumulator = 0.0f;  // 命中断点，丢弃本批剩余周期
+                    break;
+                }
                 cycle_accumulator -= 1.0f;
                 timer_counter++;
             }
+            if (perf_enabled && batch_cycles > 0) chip8_perf_end(&perf, PERF_REGION_CPU, executed);
             
             last_cycle_time = current_time;
             
-            // 3. ʱ£̶60Hz
-            // ÿ16.67msһζʱ60Hz
-            if (current_time - last_timer_update >= 16) {  // Լ60Hz
-                // ¶ʱ60Hz
-                chip8_update_timers(&chip8);
+            if (metrics_path) {
+                emu_frame_ticks += SDL_GetPerformanceCounter() - batch_start;
+                metrics_add(METRICS_THREAD_MAIN, METRIC_INSTRUCTIONS, executed);
+                metrics_gauge(METRICS_THREAD_MAIN, METRIC_GAUGE_CYCLE_LAG, cycle_accumulator);
+                metrics_gauge(METRICS_THREAD_MAIN, METRIC_GAUGE_SPEED, game_speed);
+            }
+            
+            // 3. 定时器更新（固定60Hz）
+            // 每16.67ms更新一次定时器（60Hz）；垂直同步时按精确的60Hz节拍对齐到刷新
+            int timer_due = vsync_enabled ? chip8_pacer_tick(&pacer) : current_time - last_timer_update >= 16;
+            if (timer_due) {  // 约60Hz
+                // VIP时序：每帧执行固定的机器周期预算
+                if (timing_model == TIMING_MODEL_VIP) {
+                    uint64_t frame_start = SDL_GetPerformanceCounter();
+                    if (perf_enabled) chip8_perf_begin(&perf);
+                    uint64_t frame_instructions = run_vip_frame(chip8);
+                    if (perf_enabled) chip8_perf_end(&perf, PERF_REGION_CPU, frame_instructions);
+                    if (metrics_path) {
+                        emu_frame_ticks += SDL_GetPerformanceCounter() - frame_start;
+                        metrics_add(METRICS_THREAD_MAIN, METRIC_INSTRUCTIONS, frame_instructions);
+                    }
+                } else if (governor_enabled) {
+                    uint64_t frame_start = SDL_GetPerformanceCounter();
+                    if (perf_enabled) chip8_perf_begin(&perf);
+                    uint64_t frame_instructions = run_governed_frame(chip8);
+                    if (perf_enabled) chip8_perf_end(&perf, PERF_REGION_CPU, frame_instructions);
+                    if (metrics_path) {
+                        emu_frame_ticks += SDL_GetPerformanceCounter() - frame_start;
+                        metrics_add(METRICS_THREAD_MAIN, METRIC_INSTRUCTIONS, frame_instructions);
+                        metrics_gauge(METRICS_THREAD_MAIN, METRIC_GAUGE_HOST_LOAD, governor.busy_avg / GOVERNOR_FRAME_US);
+                    }
+                } else if (netplay_spec) {
+                    // 联机：模拟的帧 (含回滚后重新模拟的帧) 自己更新定时器
+                    uint64_t frame_start = SDL_GetPerformanceCounter();
+                    if (perf_enabled) chip8_perf_begin(&perf);
+                    int frames = chip8_netplay_frame(&netplay, chip8, netplay_keys);
+                    if (perf_enabled) chip8_perf_end(&perf, PERF_REGION_CPU, (uint64_t)frames * netplay.ipf);
+                    if (metrics_path) {
+                        emu_frame_ticks += SDL_GetPerformanceCounter() - frame_start;
+                        metrics_add(METRICS_THREAD_MAIN, METRIC_INSTRUCTIONS, (uint64_t)frames * netplay.ipf);
+                    }
+                }
+                
+                // 更新定时器（60Hz）
+                if (!netplay_spec) {
+                    chip8_update_timers(chip8);
+                }
+                
+                if (metrics_path) {
+                    // 间隔超过两个节拍说明主循环错过了帧
+                    Uint32 interval = current_time - last_timer_update;
+                    if (last_timer_update && interval >= 33) {
+                        metrics_add(METRICS_THREAD_MAIN, METRIC_DROPPED_FRAMES, interval / 16 - 1);
+                    }
+                    metrics_add(METRICS_THREAD_MAIN, METRIC_EMULATED_FRAMES, 1);
+                    metrics_observe(METRICS_THREAD_MAIN, METRIC_HIST_EMU_FRAME, ticks_to_us(emu_frame_ticks));
+                    emu_frame_ticks = 0;
+                }
+                
                 last_timer_update = current_time;
+                emulated_frames++;
+                if (perf_enabled) chip8_perf_frame(&perf);
+                if (debug_enabled) chip8_debug_frame(&debugger, chip8);
+                
+                // 发布完成的帧到共享内存
+                if (shm_name) {
+                    uint8_t packed[DISPLAY_PACKED_SIZE];
+                    chip8_pack_display(chip8, packed);
+                    chip8_shm_publish(&frame_shm, packed, emulated_frames);
+                }
+                
+                // 提交到录制队列 (不阻塞)
+                if (record_path) {
+                    chip8_record_push(&recorder, chip8);
+                }
+            }
+        } else {
+            // 未加载ROM或调试器暂停：不累积周期，按键事件直接应用
+            last_cycle_time = current_time;
+            if (!headless) {
+                chip8_input_apply(&input_queue, chip8, SDL_GetPerformanceCounter());
             }
         }
         
-        // 4. ͼˢ£̶60Hz
+        // 4. 图形刷新（固定60Hz）
         static Uint32 last_graphics_update = 0;
-        if (current_time - last_graphics_update >= 16) {  // Լ60Hz
-            if (chip8.draw_flag && rom_loaded) {
-                chip8_graphics_update(&chip8);
-                chip8.draw_flag = 0;
+        if (vsync_enabled || current_time - last_graphics_update >= 16) {  // 约60Hz (垂直同步时每次刷新都提交)
+            if ((chip8->draw_flag || vsync_enabled) && rom_loaded && !headless) {
+                uint64_t present_start = SDL_GetPerformanceCounter();
+                if (perf_enabled) chip8_perf_begin(&perf);
+                chip8_graphics_update(chip8);
+                uint64_t present_end = SDL_GetPerformanceCounter();
+                if (perf_enabled) chip8_perf_end(&perf, PERF_REGION_GRAPHICS, 0);
+                chip8->draw_flag = 0;
+                present_ticks = present_end - present_start;
+                if (vsync_enabled) {
+                    chip8_pacer_presented(&pacer, present_start, present_end);
+                }
+                observe_input_latency(present_end);
+                
+                if (metrics_path) {
+                    metrics_observe(METRICS_THREAD_MAIN, METRIC_HIST_PRESENT, ticks_to_us(present_end - present_start));
+                    if (last_present_ticks) {
+                        metrics_observe(METRICS_THREAD_MAIN, METRIC_HIST_WALL_FRAME, ticks_to_us(present_end - last_present_ticks));
+                    }
+                    last_present_ticks = present_end;
+                    metrics_add(METRICS_THREAD_MAIN, METRIC_PRESENTED_FRAMES, 1);
+                }
                 frame_counter++;
                 frame_count_since_last++;
                 
-                // ÿ60֡ʾһ״̬
+                // 每60帧显示一次状态
                 if (frame_counter % 60 == 0) {
-                    printf("״̬: ֡=%d, PC=0x%03X, ʱ=%u, Ϸٶ=%dָ/, ʵFPS=%.1f\n", 
-                           frame_counter, chip8.pc, chip8.sound_timer, game_speed, current_fps);
+                    printf("运行状态: 帧数=%d, PC=0x%03X, 声音定时器=%u, 游戏速度=%d指令/秒, 实际FPS=%.1f\n", 
+                           frame_counter, chip8->pc, chip8->sound_timer, game_speed, current_fps);
+                    if (governor_enabled && governor.frames > 0) {
+                        printf("速度调节器: 每帧%d/%d条指令, 每帧主机时间%.0fus, 空转帧%.0f%%, 限流帧%.0f%%\n",
+                               governor.effective_ipf, governor.ipf, governor.busy_avg,
+                               100.0 * governor.idle_frames / governor.frames,
+                               100.0 * governor.throttled_frames / governor.frames);
+                    }
+                    if (netplay_spec) {
+                        printf("联机: 第%u帧, 对端确认%u帧, 回滚%llu次 (重算%llu帧, 最深%d帧), 等待对端%llu, 对齐等待%llu\n",
+                               netplay.frame, netplay.remote_confirmed, (unsigned long long)netplay.rollbacks,
+                               (unsigned long long)netplay.resimulated, netplay.max_depth,
+                               (unsigned long long)netplay.stalls, (unsigned long long)netplay.waits);
+                    }
+                    
+                    if (vsync_enabled) {
+                        printf("垂直同步: 刷新%.2fHz, 每帧工作%.0fus + 余量%.0fus, 错过消隐%llu帧\n",
+                               (double)pacer.freq / pacer.period, pacer.work_us, pacer.margin_us,
+                               (unsigned long long)pacer.missed);
+                    }
+                    if (pacer.latency_count != pacer.latency_reported) {
+                        chip8_pacer_print_latency(&pacer, stdout);
+                    }
+                    
+                    if (record_path && recorder.frames_dropped != reported_drops) {
+                        printf("警告: 录制队列已满，累计丢弃 %llu 帧\n", (unsigned long long)recorder.frames_dropped);
+                        reported_drops = recorder.frames_dropped;
+                    }
                 }
             }
             last_graphics_update = current_time;
             
-            // FPSʾ
+            // 更新FPS显示
             update_fps_display();
         }
         
-        // 5. ӳԱռCPU
-        SDL_Delay(1);
+        // 5. 持久化状态检查点（1Hz，只更新校验和，写盘由页缓存负责）
+        static Uint32 last_state_checkpoint = 0;
+        if (state_path && current_time - last_state_checkpoint >= 1000) {
+            chip8_state_checkpoint(&state_file);
+            last_state_checkpoint = current_time;
+        }
+        
+        // 6. 短暂延迟以避免过度占用CPU；
+        // 速度调节器模式直接睡眠到下一个60Hz节拍，空闲时几乎不占用CPU；
+        // 垂直同步时提交已阻塞到消隐，下一帧之前由 chip8_pacer_wait 睡眠
+        if (vsync_enabled && rom_loaded) {
+            if (governor_enabled) {
+                chip8_governor_add_busy(&governor, ticks_to_us_exact(SDL_GetPerformanceCounter() - iteration_start - present_ticks));
+            }
+        } else if (governor_enabled && rom_loaded) {
+            chip8_governor_add_busy(&governor, ticks_to_us_exact(SDL_GetPerformanceCounter() - iteration_start));
+            Uint32 since_tick = SDL_GetTicks() - last_timer_update;
+            SDL_Delay(since_tick < 16 ? 16 - since_tick : 1);
+        } else {
+            SDL_Delay(1);
+        }
     }
     
-    // Դ
-    printf("Դ...\n");
-    chip8_graphics_cleanup(&chip8);
-    printf("ģѹر\n");
+    // 清理资源
+    printf("正在清理资源...\n");
+    if (shm_name) {
+        chip8_shm_close(&frame_shm);
+    }
+    if (record_path) {
+        chip8_record_stop(&recorder);
+    }
+    if (metrics_path) {
+        chip8_metrics_stop();
+    }
+    if (trace_path) {
+        chip8->trace = NULL;
+        chip8_trace_cleanup(&trace);
+    }
+    if (!headless) {
+        SDL_DelEventWatch(input_event_watch, &input_queue);
+    }
+    if (debug_enabled) {
+        chip8_debug_cleanup(&debugger);
+    }
+    if (netplay_spec) {
+        chip8_netplay_close(&netplay);
+    }
+    if (watch_enabled) {
+        chip8_watch_stop(&rom_watch);
+    }
+    if (!headless && pacer.latency_count > 0) {
+        chip8_pacer_print_latency(&pacer, stdout);
+    }
+    if (perf_enabled) {
+        chip8_perf_report(&perf, stdout);
+        chip8_perf_cleanup(&perf);
+    }
+    chip8_graphics_cleanup(chip8);
+    if (state_path) {
+        chip8_state_close(&state_file);
+    }
+    printf("模拟器已关闭\n");
     
     return 0;
 }
\ No newline at end of file
@@ -0,0 +1,413 @@
+// rom_test.c - ROM兼容性/长时间运行测试工具：无窗口并行运行目录中的所有ROM，
+// 将逐帧显示哈希与基准文件比较，并报告运行时故障
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <SDL2/SDL.h>
+#include "chip8_runner.h"
+#include "chip8_romlib.h"
+#include "chip8_timing.h"
+#include "chip8_diff.h"
+
+#define MAX_ROOTS 64
+
+static const char* FAULT_NAMES[CHIP8_FAULT_COUNT] = {
+    "", "堆栈下溢", "堆栈溢出", "内存越界", "未知操作码"
+};
+
+// 一个ROM的测试任务
+typedef struct {
+    const char* path;
+    uint8_t sha1[SHA1_DIGEST_SIZE];
+    Chip8InputScript script;   // ROM旁的 <文件名>.keys 脚本
+    Chip8RunResult result;
+    Chip8DiffResult diff;      // --diff 模式的结果
+    int ok;
+} RomJob;
+
+// 命令行选项
+typedef struct {
+    const char* golden_path;
+    int update;
+    int strict;
+    int verbose;
+    int threads;
+    const Chip8Engine* diff_reference;  // --diff 模式的参考引擎
+    const Chip8Engine* diff_engine;     // --diff 模式的被测引擎 (NULL=基准哈希模式)
+} TestOptions;
+
+typedef struct {
+    RomJob* jobs;
+    const Chip8RunConfig* config;
+    const TestOptions* opts;
+} TestContext;
+
+static void print_usage(const char* prog) {
+    printf("用法: %s [选项] <目录或ROM文件>...\n", prog);
+    printf("  --index <文件>    同时测试ROM库索引中的所有ROM\n");
+    printf("  --golden <文件>   基准哈希文件 (默认 chip8_golden.txt)\n");
+    printf("  --update          将本次结果写入基准文件\n");
+    printf("  --frames <帧数>   每个ROM运行的帧数 (默认%d)\n", RUNNER_DEFAULT_FRAMES);
+    printf("  --interval <帧数> 检查点间隔 (默认%d)\n", RUNNER_DEFAULT_INTERVAL);
+    printf("  --script <文件>   输入脚本 (ROM旁有 <文件名>.keys 时优先使用)\n");
+    printf("  --timing <模型>   speed 或 vip (默认speed)\n");
+    printf("  --speed <指令/秒> speed模型下的CPU速度 (默认%d)\n", CPU_DEFAULT_SPEED);
+    printf("  --seed <种子>     随机数种子 (默认1)\n");
+    printf("  --rng <名称>      随机数生成器: philox (默认), lcg (旧版，用于与以前的基准比较)\n");
+    printf("  --threads <数量>  工作线程数 (默认CPU核心数)\n");
+    printf("  --diff [A,]B      差分检查：同步运行引擎A (默认ref) 和B，比较每一步后的状态\n");
+    printf("  --strict          发生运行时故障的ROM也视为失败\n");
+    printf("  --verbose         显示每个通过的ROM\n");
+    printf("执行引擎:\n");
+    chip8_engine_list(stdout);
+}
+
+static const char* path_basename(const char* path) {
+    const char* base = path;
+    for (const char* p = path; *p; p++) {
+        if (*p == '/' || *p == '\\') base = p + 1;
+    }
+    return base;
+}
+
+static uint32_t total_faults(const Chip8RunResult* result) {
+    uint32_t total = 0;
+    for (int i = CHIP8_FAULT_NONE + 1; i < CHIP8_FAULT_COUNT; i++) {
+        total += result->faults[i];
+    }
+    return total;
+}
+
+static void print_faults(const Chip8RunResult* result) {
+    printf("    故障 (第%d帧起):", result->first_fault_frame);
+    for (int i = CHIP8_FAULT_NONE + 1; i < CHIP8_FAULT_COUNT; i++) {
+        if (result->faults[i]) printf(" %s %u次", FAULT_NAMES[i], result->faults[i]);
+    }
+    printf("\n");
+}
+
+// 工作线程：读取并运行一个ROM
+static void run_job(int index, void* data) {
+    TestContext* ctx = (TestContext*)data;
+    RomJob* job = &ctx->jobs[index];
+    
+    Chip8MappedFile map;
+    if (!chip8_mmap_open(&map, job->path, 0, 0)) {
+        fprintf(stderr, "警告: 无法读取ROM文件: %s\n", job->path);
+        return;
+    }
+    chip8_sha1(map.data, map.size, job->sha1);
+    
+    Chip8RunConfig config = *ctx->config;
+    if (job->script.count > 0) config.script = &job->script;
+    if (ctx->opts->diff_engine) {
+        job->ok = chip8_diff_run(map.data, map.size, &config, ctx->opts->diff_reference,
+                                 ctx->opts->diff_engine, &job->diff);
+    } else {
+        job->ok = chip8_run_rom(map.data, map.size, &config, &job->result);
+    }
+    
+    chip8_mmap_close(&map);
+}
+
+// 与基准哈希比较
+static int run_golden(RomJob* jobs, int job_count, const Chip8RunConfig* config, const TestOptions* opts) {
+    // 运行配置不同时哈希必然不同，不能与基准比较
+    char describe[128];
+    chip8_runner_describe(config, describe, sizeof(describe));
+    Chip8GoldenSet golden;
+    chip8_golden_load(&golden, opts->golden_path);
+    if (golden.count > 0 && strcmp(golden.config, describe) != 0) {
+        if (!opts->update) {
+            fprintf(stderr, "错误: 基准文件的运行配置不同\n  基准: %s\n  本次: %s\n", golden.config, describe);
+            chip8_golden_free(&golden);
+            return 1;
+        }
+        // 以新配置重新生成
+        golden.count = 0;
+    }
+    snprintf(golden.config, sizeof(golden.config), "%s", describe);
+    
+    printf("测试 %d 个ROM，每个 %d 帧 (%s)...\n", job_count, config->frames,
+           chip8_timing_name(config->timing_model));
+    
+    Uint32 start = SDL_GetTicks();
+    TestContext ctx = { jobs, config, opts };
+    chip8_parallel_for(job_count, opts->threads, run_job, &ctx);
+    Uint32 elapsed = SDL_GetTicks() - start;
+    
+    // 按ROM顺序输出结果 (同一ROM在多个来源中出现时只统计一次)
+    int passed = 0, failed = 0, added = 0, faulted = 0, errors = 0;
+    uint64_t instructions = 0;
+    for (int i = 0; i < job_count; i++) {
+        RomJob* job = &jobs[i];
+        const char* name = path_basename(job->path);
+        if (!job->ok) {
+            printf("[错误] %s: 无法运行\n", job->path);
+            errors++;
+            continue;
+        }
+        
+        int duplicate = 0;
+        for (int j = 0; j < i; j++) {
+            if (jobs[j].ok && memcmp(jobs[j].sha1, job->sha1, SHA1_DIGEST_SIZE) == 0) duplicate = 1;
+        }
+        if (duplicate) continue;
+        
+        instructions += job->result.instructions;
+        int has_faults = total_faults(&job->result) > 0;
+        if (has_faults) faulted++;
+        
+        GoldenEntry* expected = chip8_golden_find(&golden, job->sha1);
+        int mismatch = expected ? chip8_golden_compare(expected, &job->result) : -1;
+        
+        if (!expected) {
+            printf("[新增] %s\n", name);
+            added++;
+        } else if (mismatch >= 0) {
+            int interval = config->interval > 0 ? config->interval : RUNNER_DEFAULT_INTERVAL;
+            if (mismatch < job->result.checkpoint_count) {
+                printf("[失败] %s: 第%d帧之前显示与基准不一致\n", name, (mismatch + 1) * interval);
+            } else {
+                printf("[失败] %s: 最终帧与基准不一致\n", name);
+            }
+            failed++;
+        } else if (opts->strict && has_faults) {
+            printf("[失败] %s: 发生运行时故障\n", name);
+            failed++;
+        } else {
+            if (opts->verbose || has_faults) printf("[通过] %s\n", name);
+            passed++;
+        }
+        if (has_faults && (opts->verbose || opts->strict || mismatch >= 0 || !expected)) print_faults(&job->result);
+        
+        if (opts->update) {
+            GoldenEntry* e = chip8_golden_put(&golden, job->sha1);
+            if (e) {
+                e->hash = job->result.hash;
+                e->checkpoint_count = job->result.checkpoint_count;
+                memcpy(e->checkpoints, job->result.checkpoints, sizeof(e->checkpoints));
+                snprintf(e->name, sizeof(e->name), "%s", name);
+            }
+        }
+    }
+    
+    printf("\n通过 %d, 失败 %d, 新增 %d, 错误 %d, 有运行时故障 %d\n", passed, failed, added, errors, faulted);
+    printf("用时 %.2f 秒, %.1f 百万指令/秒\n", elapsed / 1000.0,
+           elapsed ? instructions / (elapsed * 1000.0) : 0.0);
+    
+    if (opts->update) {
+        if (chip8_golden_save(&golden, opts->golden_path)) {
+            printf("基准文件已更新: %s (%d 个ROM)\n", opts->golden_path, golden.count);
+        }
+    } else if (added > 0) {
+        printf("使用 --update 保存新增ROM的基准哈希\n");
+    }
+    
+    // 没有基准的ROM无法比较，也视为失败 (否则缺少基准文件时测试总是通过)
+    chip8_golden_free(&golden);
+    return (failed > 0 || errors > 0 || added > 0) && !opts->update ? 1 : 0;
+}
+
+// 差分检查：第一次分歧时输出复现信息
+static int run_diff(RomJob* jobs, int job_count, const Chip8RunConfig* config, const TestOptions* opts) {
+    printf("差分检查 %d 个ROM: %s / %s，每个 %d 帧...\n", job_count, opts->diff_reference->name,
+           opts->diff_engine->name, config->frames);
+    
+    Uint32 start = SDL_GetTicks();
+    TestContext ctx = { jobs, config, opts };
+    chip8_parallel_for(job_count, opts->threads, run_job, &ctx);
+    Uint32 elapsed = SDL_GetTicks() - start;
+    
+    int matched = 0, diverged = 0, errors = 0;
+    uint64_t instructions = 0;
+    for (int i = 0; i < job_count; i++) {
+        RomJob* job = &jobs[i];
+        if (!job->ok) {
+            printf("[错误] %s: 无法运行\n", job->path);
+            errors++;
+            continue;
+        }
+        
+        instructions += job->diff.instructions;
+        if (job->diff.diverged) {
+            printf("[分歧] %s\n", path_basename(job->path));
+            Chip8RunConfig job_config = *config;
+            if (job->script.count > 0) job_config.script = &job->script;
+            chip8_diff_report(stdout, job->path, &job_config, opts->diff_reference, opts->diff_engine, &job->diff);
+            diverged++;
+        } else {
+            if (opts->verbose) printf("[一致] %s\n", path_basename(job->path));
+            matched++;
+        }
+        chip8_diff_free(&job->diff);
+    }
+    
+    printf("\n一致 %d, 分歧 %d, 错误 %d\n", matched, diverged, errors);
+    printf("用时 %.2f 秒, 比较了 %llu 条指令\n", elapsed / 1000.0, (unsigned long long)instructions);
+    return diverged > 0 || errors > 0 ? 1 : 0;
+}
+
+// ROM旁的 <文件名>.keys 输入脚本
+static void load_rom_script(RomJob* job) {
+    char path[1024];
+    snprintf(path, sizeof(path), "%s.keys", job->path);
+    FILE* f = fopen(path, "r");
+    if (!f) return;
+    fclose(f);
+    chip8_script_load(&job->script, path);
+}
+
+int main(int argc, char* argv[]) {
+    const char* roots[MAX_ROOTS];
+    int root_count = 0;
+    const char* index_path = NULL;
+    const char* script_path = NULL;
+    TestOptions opts;
+    memset(&opts, 0, sizeof(opts));
+    opts.golden_path = "chip8_golden.txt";
+    int speed = CPU_DEFAULT_SPEED;
+    
+    Chip8RunConfig config;
+    chip8_runner_default_config(&config);
+    
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--index") == 0 && i + 1 < argc) {
+            index_path = argv[++i];
+        } else if (strcmp(argv[i], "--golden") == 0 && i + 1 < argc) {
+            opts.golden_path = argv[++i];
+        } else if (strcmp(argv[i], "--update") == 0) {
+            opts.update = 1;
+        } else if (strcmp(argv[i], "--frames") == 0 && i + 1 < argc) {
+            config.frames = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--interval") == 0 && i + 1 < argc) {
+            config.interval = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--script") == 0 && i + 1 < argc) {
+            script_path = argv[++i];
+        } else if (strcmp(argv[i], "--timing") == 0 && i + 1 < argc) {
+            config.timing_model = chip8_timing_from_name(argv[++i]);
+            if (config.timing_model < 0) {
+                fprintf(stderr, "错误: 未知的时序模型: %s\n", argv[i]);
+                return 1;
+            }
+        } else if (strcmp(argv[i], "--speed") == 0 && i + 1 < argc) {
+            speed = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--seed") == 0 && i + 1 < argc) {
+            config.seed = (unsigned int)strtoul(argv[++i], NULL, 10);
+        } else if (strcmp(argv[i], "--rng") == 0 && i + 1 < argc) {
+            config.rng = chip8_rng_from_name(argv[++i]);
+            if (config.rng < 0) {
+                fprintf(stderr, "错误: 未知的随机数生成器: %s\n", argv[i]);
+                return 1;
+            }
+        } else if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc) {
+            opts.threads = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--diff") == 0 && i + 1 < argc) {
+            char names[64];
+            snprintf(names, sizeof(names), "%s", argv[++i]);
+            char* comma = strchr(names, ',');
+            if (comma) *comma = '\0';
+            opts.diff_reference = chip8_engine_find(comma ? names : "ref");
+            opts.diff_engine = chip8_engine_find(comma ? comma + 1 : names);
+            if (!opts.diff_reference || !opts.diff_engine) {
+                fprintf(stderr, "错误: 未知的执行引擎: %s\n", argv[i]);
+                return 1;
+            }
+        } else if (strcmp(argv[i], "--strict") == 0) {
+            opts.strict = 1;
+        } else if (strcmp(argv[i], "--verbose") == 0) {
+            opts.verbose = 1;
+        } else if (argv[i][0] == '-') {
+            print_usage(argv[0]);
+            return 1;
+        } else if (root_count < MAX_ROOTS) {
+            roots[root_count++] = argv[i];
+        }
+    }
+    
+    if (root_count == 0 && !index_path) {
+        print_usage(argv[0]);
+        return 1;
+    }
+    if (config.frames <= 0) {
+        fprintf(stderr, "错误: 帧数必须大于0\n");
+        return 1;
+    }
+    if (speed < CPU_MIN_SPEED) speed = CPU_MIN_SPEED;
+    if (speed > CPU_MAX_SPEED) speed = CPU_MAX_SPEED;
+    config.cycles_per_frame = speed / 60;
+    if (opts.diff_engine && config.timing_model != TIMING_MODEL_SPEED) {
+        fprintf(stderr, "警告: 差分检查按speed模型逐条比较，忽略 --timing\n");
+        config.timing_model = TIMING_MODEL_SPEED;
+    }
+    
+    if (SDL_Init(0) != 0) {
+        fprintf(stderr, "错误: SDL初始化失败: %s\n", SDL_GetError());
+        return 1;
+    }
+    
+    // 收集ROM：目录/文件参数 + ROM库索引
+    char** files = NULL;
+    int file_count = chip8_romlib_find_files(roots, root_count, &files);
+    
+    Chip8RomLibrary lib;
+    int have_lib = 0;
+    if (index_path) {
+        have_lib = chip8_romlib_open(&lib, index_path);
+        if (!have_lib) {
+            fprintf(stderr, "错误: 无法打开ROM库索引: %s\n", index_path);
+            chip8_romlib_free_files(files, file_count);
+            SDL_Quit();
+            return 1;
+        }
+    }
+    int job_count = file_count + (have_lib ? (int)lib.count : 0);
+    if (job_count == 0) {
+        fprintf(stderr, "错误: 没有找到ROM文件\n");
+        if (have_lib) chip8_romlib_close(&lib);
+        chip8_romlib_free_files(files, file_count);
+        SDL_Quit();
+        return 1;
+    }
+    
+    RomJob* jobs = (RomJob*)calloc(job_count, sizeof(RomJob));
+    if (!jobs) {
+        fprintf(stderr, "错误: 内存不足\n");
+        if (have_lib) chip8_romlib_close(&lib);
+        chip8_romlib_free_files(files, file_count);
+        SDL_Quit();
+        return 1;
+    }
+    for (int i = 0; i < file_count; i++) {
+        jobs[i].path = files[i];
+    }
+    for (int i = file_count; i < job_count; i++) {
+        jobs[i].path = chip8_romlib_path(&lib, &lib.entries[i - file_count]);
+    }
+    
+    Chip8InputScript script = { NULL, 0 };
+    if (script_path && !chip8_script_load(&script, script_path)) {
+        free(jobs);
+        if (have_lib) chip8_romlib_close(&lib);
+        chip8_romlib_free_files(files, file_count);
+        SDL_Quit();
+        return 1;
+    }
+    config.script = script_path ? &script : NULL;
+    for (int i = 0; i < job_count; i++) {
+        load_rom_script(&jobs[i]);
+    }
+    
+    int status = opts.diff_engine ? run_diff(jobs, job_count, &config, &opts) : run_golden(jobs, job_count, &config, &opts);
+    
+    for (int i = 0; i < job_count; i++) {
+        chip8_script_free(&jobs[i].script);
+    }
+    chip8_script_free(&script);
+    free(jobs);
+    if (have_lib) chip8_romlib_close(&lib);
+    chip8_romlib_free_files(files, file_count);
+    SDL_Quit();
+    
+    return status;
+}
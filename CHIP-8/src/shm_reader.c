@@ -0,0 +1,136 @@
+// shm_reader.c - 共享内存帧读取工具：在终端显示或导出为PBM图片
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "chip8_shm.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#define sleep_ms(ms) Sleep(ms)
+#else
+#include <unistd.h>
+#define sleep_ms(ms) usleep((ms) * 1000)
+#endif
+
+static void print_usage(const char* prog) {
+    printf("用法: %s <共享内存名称> [--dump <目录>] [--count <帧数>]\n", prog);
+    printf("  默认在终端中显示最新帧\n");
+    printf("  --dump   将每一帧保存为PBM图片 (frame_<帧号>.pbm)\n");
+    printf("  --count  读取指定帧数后退出 (0=不限)\n");
+}
+
+// 在终端中绘制一帧
+static void render_frame(const Chip8ShmSlot* slot) {
+    static char text[(CHIP8_SHM_WIDTH + 1) * CHIP8_SHM_HEIGHT + 1];
+    char* p = text;
+    
+    for (int y = 0; y < CHIP8_SHM_HEIGHT; y++) {
+        const uint8_t* row = &slot->display[y * (CHIP8_SHM_WIDTH / 8)];
+        for (int x = 0; x < CHIP8_SHM_WIDTH; x++) {
+            *p++ = (row[x >> 3] & (0x80 >> (x & 7))) ? '#' : ' ';
+        }
+        *p++ = '\n';
+    }
+    *p = '\0';
+    
+    // 光标回到左上角后整体输出，避免闪烁
+    printf("\033[H%s帧 %llu  时间戳 %.3f ms\n", text, (unsigned long long)slot->frame,
+           slot->timestamp_ns / 1e6);
+    fflush(stdout);
+}
+
+// 保存为PBM (P4格式与打包帧的位序一致，直接写入)
+static int dump_frame(const char* dir, const Chip8ShmSlot* slot) {
+    char path[512];
+    snprintf(path, sizeof(path), "%s/frame_%08llu.pbm", dir, (unsigned long long)slot->frame);
+    
+    FILE* file = fopen(path, "wb");
+    if (!file) {
+        fprintf(stderr, "错误: 无法写入 %s\n", path);
+        return 0;
+    }
+    fprintf(file, "P4\n%d %d\n", CHIP8_SHM_WIDTH, CHIP8_SHM_HEIGHT);
+    fwrite(slot->display, 1, CHIP8_SHM_FRAME_BYTES, file);
+    fclose(file);
+    return 1;
+}
+
+int main(int argc, char* argv[]) {
+    const char* name = NULL;
+    const char* dump_dir = NULL;
+    long count = 0;
+    
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--dump") == 0 && i + 1 < argc) {
+            dump_dir = argv[++i];
+        } else if (strcmp(argv[i], "--count") == 0 && i + 1 < argc) {
+            count = atol(argv[++i]);
+        } else if (argv[i][0] == '-') {
+            print_usage(argv[0]);
+            return 1;
+        } else {
+            name = argv[i];
+        }
+    }
+    
+    if (!name) {
+        print_usage(argv[0]);
+        return 1;
+    }
+    
+    Chip8Shm shm;
+    if (!chip8_shm_open(&shm, name)) {
+        return 1;
+    }
+    
+    if (!dump_dir) {
+        printf("\033[2J");  // 清屏
+    }
+    
+    // 从当前最新帧开始读取
+    uint64_t next = chip8_shm_published(&shm);
+    uint64_t lost = 0;
+    long frames = 0;
+    Chip8ShmSlot slot;
+    
+    while (count == 0 || frames < count) {
+        uint64_t published = chip8_shm_published(&shm);
+        
+        if (next >= published) {
+            sleep_ms(2);
+            continue;
+        }
+        
+        // 显示模式只关心最新帧；导出模式尽量补齐环形缓冲区中的旧帧
+        if (!dump_dir) {
+            next = published - 1;
+        } else if (published - next > CHIP8_SHM_SLOTS) {
+            lost += published - next - CHIP8_SHM_SLOTS;
+            next = published - CHIP8_SHM_SLOTS;
+        }
+        
+        if (!chip8_shm_read(&shm, next, &slot)) {
+            // 读取期间被覆盖：导出模式跳过该帧，显示模式重新读取最新帧
+            if (dump_dir && chip8_shm_published(&shm) - next > CHIP8_SHM_SLOTS) {
+                lost++;
+                next++;
+            }
+            continue;
+        }
+        next++;
+        frames++;
+        
+        if (dump_dir) {
+            if (!dump_frame(dump_dir, &slot)) break;
+        } else {
+            render_frame(&slot);
+        }
+    }
+    
+    if (dump_dir) {
+        printf("已导出 %ld 帧，丢失 %llu 帧\n", frames, (unsigned long long)lost);
+    }
+    
+    chip8_shm_close(&shm);
+    return 0;
+}
@@ -0,0 +1,85 @@
+// trace_decode.c - 执行跟踪转储文件解码工具：输出可读的反汇编
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "chip8_trace.h"
+#include "chip8_disasm.h"
+
+// 故障名称 (与 Chip8Fault 顺序一致)
+static const char* FAULT_NAMES[] = {
+    "信号/手动转储", "堆栈下溢", "堆栈溢出", "内存越界", "未知操作码"
+};
+
+static void print_usage(const char* prog) {
+    printf("用法: %s <跟踪文件> [--last <条数>]\n", prog);
+    printf("  --last  只显示最后N条指令 (默认全部)\n");
+}
+
+int main(int argc, char* argv[]) {
+    const char* path = NULL;
+    uint32_t last = 0;
+    
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--last") == 0 && i + 1 < argc) {
+            last = (uint32_t)strtoul(argv[++i], NULL, 10);
+        } else if (argv[i][0] == '-') {
+            print_usage(argv[0]);
+            return 1;
+        } else {
+            path = argv[i];
+        }
+    }
+    
+    if (!path) {
+        print_usage(argv[0]);
+        return 1;
+    }
+    
+    FILE* file = fopen(path, "rb");
+    if (!file) {
+        fprintf(stderr, "错误: 无法打开跟踪文件: %s\n", path);
+        return 1;
+    }
+    
+    Chip8TraceHeader header;
+    if (fread(&header, sizeof(header), 1, file) != 1 || memcmp(header.magic, TRACE_MAGIC, 4) != 0 ||
+        header.version != TRACE_VERSION || header.entry_size != sizeof(Chip8TraceEntry)) {
+        fprintf(stderr, "错误: 不是有效的跟踪文件: %s\n", path);
+        fclose(file);
+        return 1;
+    }
+    
+    const char* fault_name = header.fault < sizeof(FAULT_NAMES) / sizeof(FAULT_NAMES[0])
+                             ? FAULT_NAMES[header.fault] : "未知";
+    printf("跟踪文件: %s\n", path);
+    printf("转储原因: %s", fault_name);
+    if (header.fault) printf(" (操作码 0x%04X)", header.fault_opcode);
+    printf("\n累计指令: %llu, 缓冲区容量: %u, 文件中条目: %u\n\n",
+           (unsigned long long)header.total, header.capacity, header.stored);
+    
+    // 跳过不需要显示的旧条目
+    uint32_t skip = (last && last < header.stored) ? header.stored - last : 0;
+    fseek(file, (long)(skip * sizeof(Chip8TraceEntry)), SEEK_CUR);
+    
+    printf("      序号    PC    操作码  I      写入       反汇编\n");
+    
+    // 第一条条目对应的全局指令序号
+    uint64_t index = header.total - header.stored + skip;
+    Chip8TraceEntry entry;
+    char text[32];
+    char reg[16];
+    
+    while (fread(&entry, sizeof(entry), 1, file) == 1) {
+        chip8_disassemble(entry.opcode, text, sizeof(text));
+        if (entry.reg != TRACE_NO_REG) {
+            snprintf(reg, sizeof(reg), "V%X=0x%02X", entry.reg & 0xF, entry.value);
+        } else {
+            snprintf(reg, sizeof(reg), "-");
+        }
+        printf("%10llu  0x%03X  %04X  0x%03X  %-9s  %s\n", (unsigned long long)index++,
+               entry.pc, entry.opcode, entry.I, reg, text);
+    }
+    
+    fclose(file);
+    return 0;
+}